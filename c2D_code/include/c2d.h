@@ -77,6 +77,10 @@ typedef struct {
   BOOLEAN count_models;  //count the models of the output nnf
   BOOLEAN model_counter; //only (weighted) model counter
   BOOLEAN help;          //help
+
+  //kept last, as the vtree library is built against the fields above
+  char* snapshot_out_filename; //output cnf snapshot (binary, read back by --cnf)
+  BOOLEAN reorder;             //lay out the cnf in memory by the vtree in (or the primal graph)
 } c2dOptions;
 
 /******************************************************************************
@@ -148,8 +152,17 @@ typedef struct vtree_cache_entry_t {
 
   //a pointer to the next cache entry in the list of cache entries for a given vtree
   struct vtree_cache_entry_t* vtree_next;
+
+  //the number of grains of the block holding the entry and its key (see CACHE_GRAIN)
+  c2dSize grains;
 } VtreeCE;
 
+//cache entries (with their keys) are cut from slabs taken from the cache region of the sat
+//library, which backs them by huge pages; entries given back are kept by size for later ones
+#define CACHE_SLAB_SIZE ((2<<20)-4096) //bytes of a slab (its header included, it fits a huge page)
+#define CACHE_GRAIN 16                 //entries take a multiple of this many bytes
+#define CACHE_SIZE_CLASSES 64          //entries of more than CACHE_GRAIN*CACHE_SIZE_CLASSES bytes get a block of their own
+
 typedef struct {
   c2dSize capacity;  //the total number of buckets (collision lists) in cache
   VtreeCE** buckets; //the array where cache buckets are stored
@@ -157,6 +170,10 @@ typedef struct {
   c2dSize memory;    //the memory (in bytes) used to store cache entries
   c2dSize hits;      //the number of cache hits
   c2dSize misses;    //the number of cache misses
+  void* slabs;       //slabs entries are cut from, each starting with a pointer to the previous one
+  BYTE* slab_next;   //first byte of the last slab not cut yet
+  BYTE* slab_end;    //end of the last slab
+  void* free_entries[CACHE_SIZE_CLASSES+1]; //entries given back, by size (in grains), each pointing to the next one
 } VtreeCache;
 
 /******************************************************************************
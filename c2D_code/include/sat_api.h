@@ -148,6 +148,38 @@ BOOLEAN sat_subsumed_clause(const Clause* clause);
 //returns the number of clauses in the cnf of sat state
 c2dSize sat_clause_count(const SatState* sat_state);
 
+//returns the number of literals, tautologies and clauses left out of the cnf of sat state
+//as repeated in their clause, containing a literal and its opposite, or repeating an earlier clause
+c2dSize sat_duplicate_literal_count(const SatState* sat_state);
+c2dSize sat_tautology_count(const SatState* sat_state);
+c2dSize sat_duplicate_clause_count(const SatState* sat_state);
+
+//the sat library takes its large arrays from regions backed by huge pages, one per kind;
+//blocks of the cache region hold the entries of the vtree cache
+#define clauseRegion 0
+#define occursRegion 1
+#define stateRegion 2
+#define cacheRegion 3
+#define numRegions 4
+
+//returns the name of a region, NULL if there is no such region
+const char* sat_region_name(int region);
+
+//returns the number of bytes asked for the blocks of a region, and stores in huge_bytes (if not NULL)
+//how many of the bytes mapped for them lie in huge pages
+c2dSize sat_region_usage(int region, c2dSize* huge_bytes);
+
+//allocates a block of a region, freed by sat_region_free(): blocks of a megabyte or more are
+//mapped on their own and backed by huge pages
+void* sat_region_alloc(size_t size, int region);
+
+//allocates a block of a region whose bytes are all 0, freed by sat_region_free() (the pages of a
+//block mapped on its own are only touched, and zeroed by the kernel, once they are used)
+void* sat_region_calloc(size_t size, int region);
+
+//frees a block allocated by sat_region_alloc()
+void sat_region_free(void* block);
+
 //returns the number of learned clauses in a sat state (0 when the sat state is constructed)
 c2dSize sat_learned_clause_count(const SatState* sat_state);
 
@@ -177,6 +209,20 @@ SatState* sat_state_new(const char* file_name);
 //frees the SatState
 void sat_state_free(SatState* sat_state);
 
+//lays out the variables (each one with its literals) and the clauses of a sat state in memory, so that
+//related ones lie close to each other: the variables in the order of the indices listed in var_order (n
+//of them), or, if var_order is NULL, in the order of breadth first searches of the primal graph of the
+//cnf (Cuthill-McKee), and the clauses by the first position of their variables in that order
+//indices of variables, literals and clauses stay the same, so only the memory traffic changes
+//returns 1 if the sat state was laid out anew, and 0 if var_order does not list each variable once, or
+//if the sat state is not as constructed (with a literal set, or a clause learned or added)
+BOOLEAN sat_state_reorder(const c2dSize* var_order, SatState* sat_state);
+
+//writes the cnf of sat state to a snapshot file, which sat_state_new() loads without parsing
+//if simplify is 1, the clauses are first simplified by unit resolution (keeping the models)
+//returns 1 if the snapshot was written, 0 otherwise
+BOOLEAN sat_snapshot_save(const char* file_name, BOOLEAN simplify, SatState* sat_state);
+
 //applies unit resolution to the cnf of sat state
 //returns 1 if unit resolution succeeds, 0 if it finds a contradiction
 BOOLEAN sat_unit_resolution(SatState* sat_state);
@@ -14,6 +14,8 @@ void pprint_bytes(const char* string, c2dSize bytes);
 //local declarations
 BOOLEAN match_keys(register BYTE* key1, register BYTE* key2, register c2dSize size);
 void copy_key(register BYTE* key1, register BYTE* key2, register c2dSize size);
+VtreeCE* new_cache_entry(c2dSize key_size, VtreeCache* cache);
+void free_cache_entry(VtreeCE* entry, VtreeCache* cache);
 
 /******************************************************************************
  * the cache is implemented as an array of linked lists:
@@ -39,35 +41,86 @@ void copy_key(register BYTE* key1, register BYTE* key2, register c2dSize size);
 VtreeCache* construct_vtree_cache(c2dSize capacity) {
   VtreeCache* cache = (VtreeCache*) malloc(sizeof(VtreeCache));
   
-  cache->buckets    = (VtreeCE**) calloc(capacity,sizeof(VtreeCE*));
+  cache->buckets    = (VtreeCE**) sat_region_calloc(capacity*sizeof(VtreeCE*),cacheRegion);
   cache->capacity   = capacity;
   cache->count      = 0;
   cache->memory     = 0;
   cache->hits       = 0;
   cache->misses     = 0;
+  cache->slabs      = NULL;
+  cache->slab_next  = NULL;
+  cache->slab_end   = NULL;
+  for(c2dSize i=0; i<=CACHE_SIZE_CLASSES; i++) cache->free_entries[i] = NULL;
   return cache;
 }
 
-void free_cache_entry(VtreeCE* entry) {
-  free(entry->key);
-  free(entry);
-}
-
 void free_vtree_cache(VtreeCache* cache) {
   //free cache entries
   for(c2dSize i=0; i<cache->capacity; i++) {
     VtreeCE* entry = cache->buckets[i];
     while(entry!=NULL) {
       VtreeCE* next = entry->next;
-      free_cache_entry(entry);
+      free_cache_entry(entry,cache);
       entry = next;
     }
   }
+  //free the slabs entries were cut from
+  while(cache->slabs!=NULL) {
+    void* previous = *(void**)cache->slabs;
+    sat_region_free(cache->slabs);
+    cache->slabs = previous;
+  }
   
-  free(cache->buckets); //free hash table
+  sat_region_free(cache->buckets); //free hash table
   free(cache);
 }
 
+/******************************************************************************
+ * cache entries
+ *
+ * an entry and its key lie in one block: small blocks are cut from slabs of the
+ * cache region (backed by huge pages) and kept by size once given back, while
+ * larger ones are allocated on their own from the same region
+ ******************************************************************************/
+
+//returns a cache entry, followed by room for a key of key_size bytes
+VtreeCE* new_cache_entry(c2dSize key_size, VtreeCache* cache) {
+  c2dSize grains = (sizeof(VtreeCE)+key_size+CACHE_GRAIN-1)/CACHE_GRAIN;
+  VtreeCE* entry;
+  
+  if(grains>CACHE_SIZE_CLASSES) entry = (VtreeCE*) sat_region_alloc(grains*CACHE_GRAIN,cacheRegion);
+  else if(cache->free_entries[grains]!=NULL) {
+    entry = (VtreeCE*) cache->free_entries[grains];
+    cache->free_entries[grains] = *(void**)entry;
+  }
+  else {
+    if(cache->slab_next==NULL || cache->slab_end-cache->slab_next < grains*CACHE_GRAIN) {
+      //the link to the previous slab takes the first grain of the slab
+      void** slab = (void**) sat_region_alloc(CACHE_SLAB_SIZE,cacheRegion);
+      *slab = cache->slabs;
+      cache->slabs = slab;
+      cache->slab_next = (BYTE*)slab+CACHE_GRAIN;
+      cache->slab_end = (BYTE*)slab+CACHE_SLAB_SIZE;
+    }
+    entry = (VtreeCE*) cache->slab_next;
+    cache->slab_next += grains*CACHE_GRAIN;
+  }
+  
+  entry->key    = (BYTE*)(entry+1);
+  entry->grains = grains;
+  return entry;
+}
+
+//gives a cache entry (and its key) back
+void free_cache_entry(VtreeCE* entry, VtreeCache* cache) {
+  c2dSize grains = entry->grains;
+  if(grains>CACHE_SIZE_CLASSES) sat_region_free(entry);
+  else {
+    *(void**)entry = cache->free_entries[grains];
+    cache->free_entries[grains] = entry;
+  }
+}
+
 /******************************************************************************
  * which vtree nodes to cache at: CRITICAL to performance
  ******************************************************************************/
@@ -134,11 +187,10 @@ void insert_cache(VtreeCV item, DVtree* vtree, VtreeManager* manager) {
   c2dSize index       = hashcode % cache->capacity;
   VtreeCE* head_entry = cache->buckets[index]; //head of collision list
   
-  //create entry
-  VtreeCE* entry   = (VtreeCE*) malloc(sizeof(VtreeCE));
+  //create entry (its key lies right after it)
+  VtreeCE* entry   = new_cache_entry(key_size,cache);
   entry->value     = item;
   entry->vtree     = vtree;
-  entry->key       = (BYTE*) calloc(key_size,sizeof(BYTE));
   copy_key(key,entry->key,key_size); //entry key  
      
   //insert into hash table
@@ -169,7 +221,7 @@ void drop_cache_entry(VtreeCE* entry, VtreeCache* cache) {
   --cache->count;
   cache->memory -= sizeof(VtreeCE) + sizeof(BYTE)*entry->vtree->key_size;
   //free
-  free_cache_entry(entry);
+  free_cache_entry(entry,cache);
 }
 
 //drop all cache entries of vtree and its descendants
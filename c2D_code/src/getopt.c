@@ -25,6 +25,7 @@ const char* c2d_version();
 #define CHECK_ENTAIL 0;
 #define COUNT_MODELS 0;
 #define COUNTER      0;
+#define REORDER      0;
 
 /******************************************************************************
  * c2d options 
@@ -34,6 +35,7 @@ c2dOptions* init_options() {
   c2dOptions* options = (c2dOptions*) malloc(sizeof(c2dOptions));
 
   options->cnf_filename       = NULL;
+  options->snapshot_out_filename = NULL;
   options->vtree_in_filename  = NULL;           
   options->vtree_out_filename = NULL;
   options->vtree_dot_filename = NULL; 
@@ -47,6 +49,7 @@ c2dOptions* init_options() {
   options->check_entail       = CHECK_ENTAIL;
   options->count_models       = COUNT_MODELS;
   options->model_counter      = COUNTER;
+  options->reorder            = REORDER;
   options->help               = 0;
   return options;
 }
@@ -57,6 +60,7 @@ c2dOptions* get_options(int argc, char** argv) {
   while(1) {
     static struct option long_options[] = {
       {"cnf",            required_argument, 0, 'c'},
+      {"snapshot_out",   required_argument, 0, 'S'},
       {"vtree",          required_argument, 0, 'v'},
       {"vtree_out",      required_argument, 0, 'o'},
       {"vtree_dot",      required_argument, 0, 'd'},
@@ -70,16 +74,18 @@ c2dOptions* get_options(int argc, char** argv) {
       {"check_entail",   no_argument,       0, 'E'},
       {"count_models",   no_argument,       0, 'C'},
       {"model_counter",  no_argument,       0, 'W'},
+      {"reorder",        no_argument,       0, 'r'},
       {"help",           no_argument,       0, 'h'},
       {0,                0,                 0,  0}
     };
 
     int index = 0;
-    int argument = getopt_long(argc,argv,"c:v:o:d:t:m:b:u:f:s:iECWh",long_options,&index);
+    int argument = getopt_long(argc,argv,"c:S:v:o:d:t:m:b:u:f:s:iECWrh",long_options,&index);
     if(argument==-1) break;
 
     switch(argument) {
       case 'c': options->cnf_filename       = optarg;        break;
+      case 'S': options->snapshot_out_filename = optarg;     break;
       case 'v': options->vtree_in_filename  = optarg;        break;
       case 'o': options->vtree_out_filename = optarg;        break;
       case 'd': options->vtree_dot_filename = optarg;        break;
@@ -93,6 +99,7 @@ c2dOptions* get_options(int argc, char** argv) {
       case 'E': options->check_entail       = 1;             break;
       case 'C': options->count_models       = 1;             break;
       case 'W': options->model_counter      = 1;             break;
+      case 'r': options->reorder            = 1;             break;
       case 'h': options->help               = 1;             break;
       default:  print_help(C2D_PACKAGE,1);
     }
@@ -141,10 +148,11 @@ void print_help(const char* PACKAGE, int exit_value) {
   printf("%s: CNF to Decision-DNNF Compiler\n", PACKAGE);
   printf("%s\n",c2d_version());
 
-  printf("%s [-c .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .]   [-i] [-E] [-C] [-W] [-h]\n", PACKAGE);
+  printf("%s [-c .] [-S .] [-v .] [-o .] [-d .] [-t .] [-m .] [-b .] [-u .] [-f .] [-s .]   [-i] [-E] [-C] [-W] [-r] [-h]\n", PACKAGE);
    
 
   printf("  --cnf             -c FILE    set input CNF file\n");
+  printf("  --snapshot_out    -S FILE    set output CNF snapshot file (loaded faster than the CNF by --cnf)\n");
  
   printf("  --vtree           -v FILE    set input  VTREE file\n");
   printf("  --vtree_out       -o FILE    set output VTREE file\n");
@@ -171,6 +179,7 @@ void print_help(const char* PACKAGE, int exit_value) {
   printf("  --check_entail    -E         verify the compiled Decision-DNNF is correct by ensuring it is decomposable and also entails the input CNF\n");
   printf("  --count_models    -C         count the models of the input CNF after compiling it into a Decision-DNNF\n");
   printf("  --model_counter   -W         count the (weighted) models of the input CNF without compiling it into a Decision-DNNF\n");
+  printf("  --reorder         -r         lay out the CNF in memory by the input VTREE (or by the primal graph without one)\n");
   printf("  --help            -h         print this help and exit\n");
   exit(exit_value);
 }
@@ -16,6 +16,8 @@ c2dWmc count_vtree(VtreeManager* manager, SatState* sat_state);
 void print_vtree_cache_stats(VtreeCache* vtree_cache);
 //utilities.c
 void pprint_bytes(const char* string, c2dSize bytes);
+void print_region_stats();
+c2dSize* vtree_file_order(const char* fname, c2dSize var_count);
 char* extended_file_name(const char* fname, const char* new_extension);
 const char* vtree_type(const c2dOptions* options);
 
@@ -42,8 +44,30 @@ int main(int argc, char* argv[]) {
   printf("\nCNF stats: ");
   printf("\n  Vars=%"PRIvS" / ",sat_var_count(sat_state));
   printf("Clauses=%"PRIvS"",sat_clause_count(sat_state));
+  printf("\n  Removed: Duplicate literals=%"PRIvS" / ",sat_duplicate_literal_count(sat_state));
+  printf("Tautologies=%"PRIvS" / ",sat_tautology_count(sat_state));
+  printf("Duplicate clauses=%"PRIvS"",sat_duplicate_clause_count(sat_state));
   printf("\n  CNF Time\t%0.3fs",((double)(sat_t))/CLOCKS_PER_SEC);
 
+  if(options->snapshot_out_filename!=NULL) {
+    printf("\nSaving CNF snapshot...");
+    if(!sat_snapshot_save(options->snapshot_out_filename,0,sat_state)) {
+      fprintf(stderr,"\nCould not write %s\n",options->snapshot_out_filename);
+      exit(1);
+    }
+    printf(" DONE");
+  }
+
+  //lay out the cnf in memory by the input vtree (or the primal graph), before the vtree points into it
+  if(options->reorder) {
+    printf("\nReordering CNF (by %s)...",options->vtree_in_filename!=NULL ? options->vtree_in_filename : "primal graph");
+    c2dSize* order = NULL;
+    if(options->vtree_in_filename!=NULL) order = vtree_file_order(options->vtree_in_filename,sat_var_count(sat_state));
+    if(!sat_state_reorder(order,sat_state)) printf(" (the vtree does not list each variable once)");
+    free(order);
+    printf(" DONE");
+  }
+
   //construct Vtree
   start_t = clock();
   printf("\nConstructing vtree (from %s)...",vtree_type(options)); fflush(stdout);
@@ -75,6 +99,7 @@ int main(int argc, char* argv[]) {
     printf(" DONE");
     printf("\n  Learned clauses      \t%"PRIvS"",sat_learned_clause_count(sat_state));
     print_vtree_cache_stats(manager->cache);
+    print_region_stats();
     printf("\nCount stats:");
     printf("\n  Count Time\t%0.3fs",((double)(count_t))/CLOCKS_PER_SEC);
     printf("\n  Count \t%0.3"PRIwmcS"",count);
@@ -95,6 +120,7 @@ int main(int argc, char* argv[]) {
   printf("\n  Learned clauses      \t%"PRIvS"",sat_learned_clause_count(sat_state));
   print_vtree_cache_stats(manager->cache);
   printf("\n  Compile Time\t%0.3fs",((double)(comp_t))/CLOCKS_PER_SEC);
+  print_region_stats();
 	
   char* nnf_fname = extended_file_name(options->cnf_filename,".nnf");
 
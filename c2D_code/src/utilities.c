@@ -21,6 +21,75 @@ void pprint_bytes(const char* string, c2dSize bytes) {
   else printf("%s%0.1f GB",string,(double)bytes/GB);
 }
 
+//prints the bytes of each memory region of the sat library, and how many of them lie in huge pages
+void print_region_stats() {
+  printf("\nMemory regions:");
+  for(int region=0; region<numRegions; region++) {
+    c2dSize huge_bytes;
+    c2dSize bytes = sat_region_usage(region,&huge_bytes);
+    printf("\n  %-11s",sat_region_name(region));
+    pprint_bytes("\t",bytes);
+    pprint_bytes(" (huge pages ",huge_bytes);
+    printf(")");
+  }
+}
+
+//returns the variables of the leaves of a vtree file (see vtree_save()) from left to right, NULL if the
+//file cannot be read (a variable missing from the vtree is left as 0)
+c2dSize* vtree_file_order(const char* fname, c2dSize var_count) {
+  FILE* file = fopen(fname,"r");
+  if(file==NULL) return NULL;
+
+  //nodes appear bottom-up, so the last one is the root
+  char line[256];
+  c2dSize node_count = 0;
+  c2dSize root = 0;
+  c2dSize* lefts = NULL;
+  c2dSize* rights = NULL;
+  c2dSize* vars = NULL;
+  while(fgets(line,sizeof(line),file)!=NULL) {
+    c2dSize id, left, right, var;
+    if(sscanf(line,"vtree %lu",&node_count)==1 && lefts==NULL) {
+      lefts  = (c2dSize*) calloc(node_count+1,sizeof(c2dSize));
+      rights = (c2dSize*) calloc(node_count+1,sizeof(c2dSize));
+      vars   = (c2dSize*) calloc(node_count+1,sizeof(c2dSize));
+    }
+    else if(lefts!=NULL && sscanf(line,"L %lu %lu",&id,&var)==2 && id<node_count) {
+      vars[id+1] = var;
+      root = id+1;
+    }
+    else if(lefts!=NULL && sscanf(line,"I %lu %lu %lu",&id,&left,&right)==3 && id<node_count && left<node_count && right<node_count) {
+      lefts[id+1]  = left+1;
+      rights[id+1] = right+1;
+      root = id+1;
+    }
+  }
+  fclose(file);
+  if(lefts==NULL) return NULL;
+
+  //the leaves are visited in order, each node stacked until its left subtree is done
+  c2dSize* order = (c2dSize*) calloc(var_count+1,sizeof(c2dSize));
+  c2dSize* stack = (c2dSize*) malloc((node_count+1)*sizeof(c2dSize));
+  c2dSize depth = 0;
+  c2dSize count = 0;
+  c2dSize node = root;
+  while(node!=0 || depth>0) {
+    if(node!=0 && depth<=node_count) {
+      stack[depth++] = node;
+      node = lefts[node];
+      continue;
+    }
+    node = stack[--depth];
+    if(lefts[node]==0 && count<var_count) order[count++] = vars[node];
+    node = rights[node];
+  }
+  free(stack);
+  free(lefts);
+  free(rights);
+  free(vars);
+  return order;
+}
+
 //augments fname with new_extension
 char* extended_file_name(const char* fname, const char* new_extension) {
   unsigned size = strlen(fname); //size of fname excluding . and extension
@@ -13,6 +13,173 @@ typedef struct literal Lit;
 typedef struct decision Decision;
 typedef struct clause Clause;
 
+/******************************************************************************
+* Counted allocations
+******************************************************************************/
+
+//Number of blocks the calling thread allocated (or reallocated) in the library (see sat_allocation_count())
+extern __thread c2dSize allocated_blocks;
+
+//malloc, counting the block
+static inline void* counted_malloc(size_t size)
+{
+	allocated_blocks++;
+	return malloc(size);
+}
+
+//calloc, counting the block
+static inline void* counted_calloc(size_t count, size_t size)
+{
+	allocated_blocks++;
+	return calloc(count, size);
+}
+
+//realloc, counting the block
+static inline void* counted_realloc(void* block, size_t size)
+{
+	allocated_blocks++;
+	return realloc(block, size);
+}
+
+/******************************************************************************
+* POOL OF list nodes
+******************************************************************************/
+
+#define poolSlabNodes 1024		//Number of nodes cut from each slab of a pool
+
+//Pool the nodes of lists are taken from and given back to, instead of malloc and free
+//Nodes are cut from slabs, which are only freed all together (see nodePool_release())
+typedef struct nodePool {
+	size_t node_size;			//Number of bytes of a node (at least that of a pointer)
+	void* free_nodes;			//Nodes given back, each holding a pointer to the next one
+	void* slabs;				//Slabs, each starting with a pointer to the one allocated before it
+	char* next_node;			//First node of the last slab not cut yet
+	char* slab_end;				//End of the last slab
+} nodePool;
+
+//Set up an empty pool
+//@param node_size: the number of bytes of a node
+static inline void nodePool_init(nodePool* pool, size_t node_size)
+{
+	pool->node_size = node_size < sizeof(void*) ? sizeof(void*) : node_size;
+	pool->free_nodes = NULL;
+	pool->slabs = NULL;
+	pool->next_node = NULL;
+	pool->slab_end = NULL;
+}
+
+//Take a node from the pool, cutting a new slab if no node was given back
+//@return the node
+static inline void* nodePool_get(nodePool* pool)
+{
+	void* node = pool->free_nodes;
+	if (node != NULL) {
+		pool->free_nodes = *(void**)node;
+		return node;
+	}
+
+	if (pool->next_node == pool->slab_end) {
+		//The link to the previous slab takes the room of a node, which keeps the nodes aligned
+		void** slab = (void**)counted_malloc((poolSlabNodes + 1) * pool->node_size);
+		*slab = pool->slabs;
+		pool->slabs = slab;
+		pool->next_node = (char*)slab + pool->node_size;
+		pool->slab_end = pool->next_node + poolSlabNodes * pool->node_size;
+	}
+	node = pool->next_node;
+	pool->next_node += pool->node_size;
+	return node;
+}
+
+//Give a node back to the pool
+static inline void nodePool_put(nodePool* pool, void* node)
+{
+	*(void**)node = pool->free_nodes;
+	pool->free_nodes = node;
+}
+
+//Free all the slabs of the pool at once, leaving it empty (the nodes taken from it must no longer be used)
+static inline void nodePool_release(nodePool* pool)
+{
+	while (pool->slabs != NULL) {
+		void* previous = *(void**)pool->slabs;
+		free(pool->slabs);
+		pool->slabs = previous;
+	}
+	pool->free_nodes = NULL;
+	pool->next_node = NULL;
+	pool->slab_end = NULL;
+}
+
+/******************************************************************************
+* POOL OF blocks
+******************************************************************************/
+
+#define poolSlabBytes 65536		//Number of bytes of each slab of a pool of blocks (unless a block needs more)
+#define poolBlockAlignment 16	//Blocks of a pool of blocks start at multiples of this
+
+//Pool blocks of any size are taken from, one after the other, instead of malloc
+//Blocks are cut from slabs, which are only freed all together (see blockPool_release()),
+//and only the last block taken can be given back (see blockPool_unget())
+typedef struct blockPool {
+	void* slabs;				//Slabs, each starting with a pointer to the one allocated before it
+	char* next_block;			//First byte of the last slab not cut yet
+	char* slab_end;				//End of the last slab
+	char* last_block;			//Last block taken (NULL if given back)
+} blockPool;
+
+//Set up an empty pool
+static inline void blockPool_init(blockPool* pool)
+{
+	pool->slabs = NULL;
+	pool->next_block = NULL;
+	pool->slab_end = NULL;
+	pool->last_block = NULL;
+}
+
+//Take a block from the pool, cutting a new slab if the last one has no room left for it
+//@param size: the number of bytes of the block
+//@return the block
+static inline void* blockPool_get(blockPool* pool, size_t size)
+{
+	size = (size + poolBlockAlignment - 1) / poolBlockAlignment * poolBlockAlignment;
+	if (pool->next_block == NULL || (size_t)(pool->slab_end - pool->next_block) < size) {
+		//The link to the previous slab takes the room of a block, which keeps the blocks aligned
+		size_t slab_size = size + poolBlockAlignment > poolSlabBytes ? size + poolBlockAlignment : poolSlabBytes;
+		void** slab = (void**)counted_malloc(slab_size);
+		*slab = pool->slabs;
+		pool->slabs = slab;
+		pool->next_block = (char*)slab + poolBlockAlignment;
+		pool->slab_end = (char*)slab + slab_size;
+	}
+	pool->last_block = pool->next_block;
+	pool->next_block += size;
+	return pool->last_block;
+}
+
+//Give the last block taken back to the pool, its room is used by the next block taken
+//Other blocks are kept until the pool is released
+//@return 1 if the block was given back, 0 otherwise
+static inline int blockPool_unget(blockPool* pool, void* block)
+{
+	if (block == NULL || block != pool->last_block)
+		return 0;
+	pool->next_block = pool->last_block;
+	pool->last_block = NULL;
+	return 1;
+}
+
+//Free all the slabs of the pool at once, leaving it empty (the blocks taken from it must no longer be used)
+static inline void blockPool_release(blockPool* pool)
+{
+	while (pool->slabs != NULL) {
+		void* previous = *(void**)pool->slabs;
+		free(pool->slabs);
+		pool->slabs = previous;
+	}
+	blockPool_init(pool);
+}
+
 /******************************************************************************
 * LIST OF literals
 ******************************************************************************/
@@ -29,8 +196,9 @@ typedef struct litList {
 } litList;
 
 //Pop the head from the list
+//@param pool: the pool the node is given back to
 //@return the literal pointed to by the former head of the list (i.e. the removed node's literal)
-Lit* litList_pop(litList* list)
+static inline Lit* litList_pop(litList* list, nodePool* pool)
 {
 	// Check for empty list before popping
 	if(list->head == NULL) {
@@ -46,8 +214,8 @@ Lit* litList_pop(litList* list)
 	//Get the next node pointed to by the head of the list
 	temp_next = list->head->next;
 
-	//Free the memory allocated in the head node
-	free(list->head);
+	//Give the head node back to the pool
+	nodePool_put(pool, list->head);
 
 	//Set the head node to the second node in the list
 	list->head = temp_next;
@@ -57,12 +225,13 @@ Lit* litList_pop(litList* list)
 }
 
 //This function should ONLY BE CALLED IF THE LIST DOES NOT HAVE A TAIL
-void litList_push(litList* list, Lit* new_lit)
+//@param pool: the pool the node is taken from
+static inline void litList_push(litList* list, Lit* new_lit, nodePool* pool)
 {
 	litNode* new_node;		//Will store the new node
 
 	//Create a node for the new literal
-	new_node = (litNode*)malloc(sizeof(litNode));
+	new_node = (litNode*)nodePool_get(pool);
 	new_node->node_lit = new_lit;
 
 	//Set the new node's successor to the head of the list
@@ -88,8 +257,9 @@ typedef struct decList {
 } decList;
 
 //Pop the head from the list
+//@param pool: the pool the node is given back to
 //@return the decision pointed to by the former head of the list (i.e. the removed node's literal)
-Decision* decList_pop(decList* list)
+static inline Decision* decList_pop(decList* list, nodePool* pool)
 {
 	// Check for empty list before popping
 	if(list->head == NULL) {
@@ -105,8 +275,8 @@ Decision* decList_pop(decList* list)
 	//Get the next node pointed to by the head of the list
 	temp_next = list->head->next;
 
-	//Free the memory allocated in the head node
-	free(list->head);
+	//Give the head node back to the pool
+	nodePool_put(pool, list->head);
 
 	//Set the head node to the second node in the list
 	list->head = temp_next;
@@ -117,12 +287,13 @@ Decision* decList_pop(decList* list)
 
 //Push a new node onto the list
 //@param new_dec: the decision to be pushed to the list
-void decList_push(decList* list, Decision* new_dec)
+//@param pool: the pool the node is taken from
+static inline void decList_push(decList* list, Decision* new_dec, nodePool* pool)
 {
 	decNode *new_node;		//Store the new node
 
 	//Create a node for the new literal
-	new_node = (decNode*)malloc(sizeof(decNode));
+	new_node = (decNode*)nodePool_get(pool);
 	new_node->node_dec = new_dec;
 
 	//Set the new node's successor to the head of the list
@@ -148,8 +319,9 @@ typedef struct clauseList {
 } clauseList;
 
 //Pop the head from the list
+//@param pool: the pool the node is given back to
 //@return the decision pointed to by the former head of the list (i.e. the removed node's literal)
-Clause* clauseList_pop(clauseList* list)
+static inline Clause* clauseList_pop(clauseList* list, nodePool* pool)
 {
 	// Check for empty list before popping
 	if(list->head == NULL) {
@@ -165,8 +337,8 @@ Clause* clauseList_pop(clauseList* list)
 	//Get the next node pointed to by the head of the list
 	temp_next = list->head->next;
 
-	//Free the memory allocated in the head node
-	free(list->head);
+	//Give the head node back to the pool
+	nodePool_put(pool, list->head);
 
 	//Set the head node to the second node in the list
 	list->head = temp_next;
@@ -177,12 +349,13 @@ Clause* clauseList_pop(clauseList* list)
 
 //Push a new node onto the list
 //@param new_dec: the decision to be pushed to the list
-void clauseList_push(clauseList* list, Clause* new_clause)
+//@param pool: the pool the node is taken from
+static inline void clauseList_push(clauseList* list, Clause* new_clause, nodePool* pool)
 {
 	clauseNode* new_node;		//Stores the new node
 
 	//Create a node for the new literal
-	new_node = (clauseNode*)malloc(sizeof(clauseNode));
+	new_node = (clauseNode*)nodePool_get(pool);
 	new_node->node_clause = new_clause;
 
 	//Set the new node's successor to the head of the list
@@ -210,8 +383,9 @@ typedef struct dlitList {
 } dlitList;
 
 //Pop the head from the list
+//@param pool: the pool the node is given back to
 //@return the literal pointed to by the former head of the list (i.e. the removed node's literal)
-Lit* dlitList_pop(dlitList* list)
+static inline Lit* dlitList_pop(dlitList* list, nodePool* pool)
 {
 	Lit* head_lit;		//Stores the literal in the head of the list
 	dlitNode* temp_next;	//Stores the second node in the list
@@ -226,23 +400,60 @@ Lit* dlitList_pop(dlitList* list)
 	//Get the next node pointed to by the head of the list
 	temp_next = list->head->next;
 
-	//Free the memory allocated in the head node
-	free(list->head);
+	//Give the head node back to the pool
+	nodePool_put(pool, list->head);
 
 	//Set the head node to the second node in the list
 	list->head = temp_next;
+	if (temp_next == NULL)
+		list->tail = NULL;
+	else
+		temp_next->prev = NULL;
 
 	//Return the literal pointed to by the former head of the list
 	return head_lit;
 }
 
+//Pop the tail from the list
+//@param pool: the pool the node is given back to
+//@return the literal pointed to by the former tail of the list (i.e. the removed node's literal)
+static inline Lit* dlitList_pop_back(dlitList* list, nodePool* pool)
+{
+	Lit* tail_lit;		//Stores the literal in the tail of the list
+	dlitNode* temp_prev;	//Stores the second to last node in the list
+
+	//If the list is empty, return NULL
+	if (list->head == NULL)
+		return NULL;
+
+	//Get the literal pointed to by the tail of the list
+	tail_lit = list->tail->node_lit;
+
+	//Get the node before the tail of the list
+	temp_prev = list->tail->prev;
+
+	//Give the tail node back to the pool
+	nodePool_put(pool, list->tail);
+
+	//Set the tail node to the second to last node in the list
+	list->tail = temp_prev;
+	if (temp_prev == NULL)
+		list->head = NULL;
+	else
+		temp_prev->next = NULL;
+
+	//Return the literal pointed to by the former tail of the list
+	return tail_lit;
+}
+
 //This function should ONLY BE CALLED IF THE LIST HAS A HEAD AND A TAIL
-void dlitList_push_back(dlitList* list, Lit* new_lit)
+//@param pool: the pool the node is taken from
+static inline void dlitList_push_back(dlitList* list, Lit* new_lit, nodePool* pool)
 {
 	dlitNode *new_node;		//Stores the new node
 
 	//Create a node for the new literal
-	new_node = (dlitNode*)malloc(sizeof(dlitNode));
+	new_node = (dlitNode*)nodePool_get(pool);
 	new_node->node_lit = new_lit;
 	new_node->next = NULL;
 	
@@ -264,5 +475,78 @@ void dlitList_push_back(dlitList* list, Lit* new_lit)
 	}
 }
 
+/******************************************************************************
+* VECTORS with inline storage
+******************************************************************************/
+
+//Declare a vector type holding items of a given type, with the functions using it
+//Its first inline_slots items live in the vector itself, so a short vector never allocates,
+//and it doubles its capacity whenever it is full. As items may point into the vector, it must
+//not be copied by value: it is kept where it is and reused (see <name>_clear())
+#define DEFINE_VECTOR(name, type, inline_slots)										\
+typedef struct name {																\
+	type* items;					/*Items of the vector (the inline items or a heap array)*/	\
+	size_t size;					/*Number of items*/									\
+	size_t capacity;				/*Number of items there is room for*/				\
+	type inline_items[inline_slots];	/*Room for the first items*/					\
+} name;																				\
+																					\
+/*Set up an empty vector*/															\
+static inline void name##_init(name* vector)										\
+{																					\
+	vector->items = vector->inline_items;											\
+	vector->size = 0;																\
+	vector->capacity = inline_slots;												\
+}																					\
+																					\
+/*Make room for at least capacity items, at least doubling the room there is*/	\
+static inline void name##_reserve(name* vector, size_t capacity)					\
+{																					\
+	if (capacity <= vector->capacity)												\
+		return;																		\
+	if (capacity < 2 * vector->capacity)											\
+		capacity = 2 * vector->capacity;											\
+	if (vector->items == vector->inline_items) {									\
+		vector->items = (type*)counted_malloc(capacity * sizeof(type));				\
+		memcpy(vector->items, vector->inline_items, vector->size * sizeof(type));	\
+	}																				\
+	else																			\
+		vector->items = (type*)counted_realloc(vector->items, capacity * sizeof(type));	\
+	vector->capacity = capacity;													\
+}																					\
+																					\
+/*Add an item at the end of the vector*/											\
+static inline void name##_push(name* vector, type item)								\
+{																					\
+	if (vector->size == vector->capacity)											\
+		name##_reserve(vector, vector->size + 1);									\
+	vector->items[vector->size++] = item;											\
+}																					\
+																					\
+/*Remove the last item of the vector (which must not be empty) and return it*/	\
+static inline type name##_pop(name* vector)											\
+{																					\
+	return vector->items[--vector->size];											\
+}																					\
+																					\
+/*Empty the vector, keeping its room for the next items*/							\
+static inline void name##_clear(name* vector)										\
+{																					\
+	vector->size = 0;																\
+}																					\
+																					\
+/*Free the room of the vector, leaving it empty*/									\
+static inline void name##_free(name* vector)										\
+{																					\
+	if (vector->items != vector->inline_items)										\
+		free(vector->items);														\
+	name##_init(vector);															\
+}
+
+#define litVectorInlineSlots 32		//Literals a vector of literals holds without allocating
+
+//Vector of literals
+DEFINE_VECTOR(litVector, Lit*, litVectorInlineSlots)
+
 
 #endif
@@ -5,12 +5,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 #include "Lists.h"
 
 /******************************************************************************
 * sat_api.h shows the function prototypes you should implement to create libsat.a
 *
 * To use the sat library, a sat state should be constructed from an input cnf file
+* (or from clauses given in memory, see sat_builder_new())
 *
 * The sat state supports functions that are usually used to implement a sat solver,
 * such as deciding variables and learning clauses. It also supports functions for
@@ -38,6 +40,7 @@ typedef char BOOLEAN;			//signed
 typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
 typedef double c2dWmc;          //for (weighted) model count
+typedef unsigned long long c2dScenarios; //for sets of up to 64 scenarios, one bit each
 
 /******************************************************************************
 * Forward Declarations
@@ -63,6 +66,11 @@ typedef struct var {
 	Lit* neg_lit;					//The negative literal corresponding to this variable
 	unsigned long num_mentioned;	//Number of clauses mentioning this variable
 	int decision_level;				//Decision level at which the variable is instantiated
+	BOOLEAN seen;					//1 if the variable was visited by the current conflict analysis
+	BOOLEAN phase;					//1 if the variable was last set positive, 0 otherwise (saved across backtracking)
+	double activity;				//Score of the variable for picking decisions (bumped on conflicts)
+	BOOLEAN model_value;			//Value of the variable in the last model found, -1 if no model was found
+	BOOLEAN projected;				//1 if the variable is in the projection of the models being enumerated
 
 	BOOLEAN mark; //THIS FIELD MUST STAY AS IS
 
@@ -80,12 +88,12 @@ typedef struct literal {
 	c2dLiteral index;					//Literal index (you can change the variable name as you wish)
 	BOOLEAN truth_value;				//1 if the variable is true, 0 if it is false, -1 if it is not set
 	Var* var;							//The variable corresponding to this literal	
-	clauseList* clauses;				//List of clauses containing this literal						***MAKE ARRAY***
-	clauseList* learnedClauses;			//List of clauses containing this literal that were learned
-	Clause* unit_on;					//Clause on which this literal becomes unit
-	litList* unit_children;				//List of literals that became unit once this literal was set
-	BOOLEAN in_contradiction_clause;	//True if this literal is in the contradcition clause
-	BOOLEAN DFS_ignore;					//True if the DFS for a uip should ignore this literal (i.e. inspecting whether or not this literal is the uip)
+	Clause** clauses;					//Clauses of the CNF containing this literal (in the occurrence block of the SatState)
+	c2dSize num_clauses;				//Number of clauses of the CNF containing this literal
+	Clause** learnedClauses;			//Learned and added clauses containing this literal, in the order they were added
+	c2dSize num_learned;				//Number of learned and added clauses containing this literal
+	c2dSize learned_capacity;			//Number of clauses learnedClauses has room for
+	Clause* unit_on;					//Clause on which this literal becomes unit (NULL for decided literals)
 } Lit;
 
 /******************************************************************************
@@ -105,12 +113,372 @@ typedef struct clause {
 	Lit** literals;			//Array of pointers to literals
 	BOOLEAN subsumed;		//1 if the clause is subsumed at the current decision level, 0 otherwise
 	Lit* subsumed_on;		//Literal which caused the clause to become subsumed
-	int dec_level;			//Decision level at which the clause was learned. -1 if never learned (i.e. in the original CNF)
+	int dec_level;			//Assertion level of a learned clause. -1 if never learned (i.e. in the original CNF or added)
+	int lbd;				//Number of decision levels among the literals of a learned clause when it was learned (0 otherwise)
 
 	BOOLEAN mark; //THIS FIELD MUST STAY AS IS
 
 } Clause;
 
+/******************************************************************************
+* VarCell:
+* --A variable followed by its two literals. A sat state keeps the cells of all
+* its variables in one block, in the order they are laid out in (the order of
+* their indices, unless the sat state was reordered by sat_state_reorder()), so
+* a variable shares cache lines with its literals, and with the variables laid
+* out next to it.
+******************************************************************************/
+
+typedef struct var_cell_t {
+	Var var;						//The variable
+	Lit pos_lit;					//Its positive literal
+	Lit neg_lit;					//Its negative literal
+} VarCell;
+
+typedef struct var_rank_t {
+	unsigned long degree;			//Number of clauses mentioning the variable
+	c2dSize index;					//Index of the variable
+} VarRank;			//Variable ordered by the breadth first search of cuthill_mckee_order()
+
+/******************************************************************************
+* ClauseArena:
+* --The clauses of a cnf as read from its file (or given to a builder), and
+* the index of the clauses containing each literal, which are never changed
+* once read. A sat state and all its clones share the same arena. Duplicate
+* literals, tautologies and duplicate clauses are left out as the cnf is read.
+******************************************************************************/
+
+typedef struct clause_arena_t {
+	c2dSize num_vars;			//Number of variables in the cnf
+	c2dSize num_clauses;		//Number of clauses in the cnf
+	c2dSize* starts;			//Position in lits of the first literal of each clause (1 indexed, starts[num_clauses + 1] is the end)
+	c2dLiteral* lits;			//Indices of the literals of all the clauses, one clause after the other
+	c2dSize starts_capacity;	//Number of entries starts has room for
+	c2dSize lits_capacity;		//Number of literals lits has room for
+	BOOLEAN lits_borrowed;		//1 if lits lies in memory given to sat_builder_borrow_clauses() (never changed nor freed)
+	c2dSize* occurs_starts;		//Position in occurs of the first clause containing each literal (indices -n to n+1, built once the cnf is read)
+	c2dSize* occurs;			//Clauses containing each literal (in file order), one literal after the other
+	void* mapping;				//Snapshot the arrays above lie in (NULL if they were allocated)
+	size_t mapping_length;		//Number of bytes of the snapshot
+	c2dSize num_duplicate_lits;	//Number of literals left out of their clause as repeated
+	c2dSize num_tautologies;	//Number of clauses left out as containing a literal and its opposite
+	c2dSize num_duplicate_clauses;	//Number of clauses left out as having the literals of an earlier one
+	unsigned long refs;			//Number of sat states sharing the arena
+} ClauseArena;
+
+#define hashBucketSize 4096		//Most clauses of a bucket of hashes, on average (so that it stays in the cache)
+#define maxBucketBits 20		//Most highest bits of a hash telling its bucket
+
+typedef struct clause_hash_t {
+	unsigned long hash;			//Hash of the sorted literals of a clause
+	c2dSize clause;				//Index of the clause in the arena
+} ClauseHash;			//Clause of an arena being read, hashed to find the clauses which repeat it
+
+/******************************************************************************
+* SatBuilder:
+* --An arena being filled with the clauses of a cnf given in memory, from which
+* a SatState is then constructed
+******************************************************************************/
+
+typedef struct sat_builder_t {
+	ClauseArena* arena;			//Arena the clauses are added to, which the SatState then shares
+	c2dSize num_lits;			//Number of literals of the clauses added so far
+} SatBuilder;
+
+/******************************************************************************
+* SnapshotHeader:
+* --The start of a snapshot file, followed by the arrays of an arena as they lie
+* in memory: starts (num_clauses + 2 entries), lits (num_lits), occurs_starts
+* (2 num_vars + 2) and occurs (num_lits), all 8 byte words in the byte order of
+* the machine which wrote them
+******************************************************************************/
+
+#define snapshotMagic "SATSNAP"	//First bytes of a snapshot file (with the terminating 0)
+#define snapshotVersion 1		//Version of the snapshot format
+
+typedef struct snapshot_header_t {
+	char magic[8];				//snapshotMagic
+	c2dSize version;			//snapshotVersion
+	c2dSize num_vars;			//Number of variables in the cnf
+	c2dSize num_clauses;		//Number of clauses in the cnf
+	c2dSize num_lits;			//Number of literals in all the clauses
+	unsigned long checksum;		//Checksum of the arrays following the header (see hash_words())
+} SnapshotHeader;
+
+/******************************************************************************
+* CnfParser:
+* --The state of reading a cnf into an arena, so that the text can be given to
+* the parser in chunks cut anywhere (even in the middle of a number)
+******************************************************************************/
+
+#define maxLength 500			//Longest problem line kept (longer ones are cut)
+
+typedef enum { parseSpace, parseNumber, parseComment, parseHeader, parseDone } ParseMode;
+
+typedef struct cnf_parser_t {
+	ClauseArena* arena;			//Arena the clauses are read into
+	const char* file_name;		//Name of the cnf file (for errors)
+	ParseMode mode;				//What the next character belongs to
+	BOOLEAN header_read;		//1 once the problem line was read
+	BOOLEAN negative;			//1 if the number being read is negative
+	c2dSize value;				//Absolute value of the number being read
+	c2dSize num_read;			//Number of clauses read so far
+	c2dSize size;				//Number of literals read so far
+	c2dSize clause_start;		//Position in the arena's lits of the first literal of the clause being read
+	char header[maxLength];		//Problem line read so far
+	size_t header_length;		//Number of characters in header
+	char error[maxLength];		//Error which stopped the reading (empty if none)
+} CnfParser;
+
+/******************************************************************************
+* CnfChunk:
+* --A part of a mapped cnf, cut at line boundaries after the problem line, which
+* a thread reads into its own buffers. The clause numbers are only known once
+* the chunks are merged in order, as a clause can span several chunks
+******************************************************************************/
+
+#define parseChunkSize (1 << 20)	//Fewest bytes of a cnf in a chunk
+#define maxParseChunks 64			//Most chunks a cnf is cut into (and most threads parsing it)
+
+typedef struct cnf_chunk_t {
+	const char* begin;				//First character of the chunk
+	const char* end;				//Character after the last one of the chunk
+	const char* file_name;			//Name of the cnf file (for errors)
+	c2dSize num_vars;				//Number of variables of the cnf
+	c2dLiteral* lits;				//Literals read (without the 0s ending clauses)
+	c2dSize num_lits;				//Number of literals read
+	c2dSize lits_capacity;			//Number of literals lits has room for
+	c2dSize* ends;					//Number of literals read before each 0
+	c2dSize num_ends;				//Number of 0s read
+	c2dSize ends_capacity;			//Number of entries ends has room for
+	BOOLEAN done;					//1 if a line starting with % ended the clauses in the chunk
+	char error[maxLength];			//Error which stopped the reading of the chunk (empty if none)
+	c2dSize offset;					//Position in the arena's lits of the first literal read (set by the merge)
+	c2dSize num_kept;				//Number of literals read kept in the arena (set by the merge)
+} CnfChunk;
+
+typedef struct cnf_chunks_t {
+	CnfChunk* chunks;				//The chunks, in the order of the text
+	c2dSize num_chunks;				//Number of chunks
+	ClauseArena* arena;				//Arena the chunks are merged into
+	c2dSize next;					//Next chunk a thread takes
+} CnfChunks;
+
+/******************************************************************************
+* OccurrenceBuilder:
+* --The clauses containing each literal, counted and placed by several threads,
+* each over its own slice of the clauses (counting sort into a CSR index)
+******************************************************************************/
+
+#define occurrenceSliceSize (1 << 18)	//Fewest literals in a slice
+
+typedef struct occurrence_builder_t {
+	c2dSize num_vars;				//Number of variables
+	const c2dSize* starts;			//Position in lits of the first literal of each clause
+	const c2dLiteral* lits;			//Literals of all the clauses
+	c2dSize* occurs;				//Clauses containing each literal, filled by the threads
+	c2dSize num_slices;				//Number of slices
+	c2dSize* slice_starts;			//First clause of each slice (slice_starts[num_slices] is past the last clause)
+	c2dSize* counts;				//Occurrences of each literal (2 num_vars + 2 entries) in each slice, then where the slice places the next one
+	c2dSize next;					//Next slice a thread takes
+} OccurrenceBuilder;
+
+/******************************************************************************
+* CnfReader:
+* --Chunks of a cnf read from a stream by a reader thread, waiting to be parsed
+******************************************************************************/
+
+#define numReadChunks 4				//Chunks read ahead of the parser
+#define readChunkSize (1 << 16)		//Bytes of each chunk
+
+typedef struct cnf_reader_t {
+	FILE* stream;					//Stream the cnf is read from
+	char* chunks[numReadChunks];	//Chunks read, used in turn
+	size_t sizes[numReadChunks];	//Number of bytes in each chunk
+	c2dSize num_read;				//Number of chunks read so far
+	c2dSize num_parsed;				//Number of chunks parsed so far
+	BOOLEAN done;					//1 once the reader reached the end of the stream (or stopped)
+	BOOLEAN stop;					//Set when the parser needs no more chunks
+	pthread_mutex_t lock;			//Protects everything above but the stream and the chunks
+	pthread_cond_t cond;			//Signaled whenever a chunk is read or parsed
+} CnfReader;
+
+/******************************************************************************
+* LocalSearch:
+* --An assignment of all the variables improved by flipping one at a time, over
+* the clauses of the arena (indices 1 to arena->num_clauses), read where they
+* lie with their occurrences, and the added clauses (the indices after them),
+* which have an index of their own. The arrays are kept from one search of a
+* sat state to the next
+******************************************************************************/
+
+#define maxBreak 32				//Break counts above this are counted as this
+
+typedef struct local_search_t {
+	const ClauseArena* arena;		//Arena whose clauses are searched
+	c2dSize num_clauses;			//Number of clauses searched (those of the arena, then the added ones)
+	c2dSize clause_capacity;		//Number of clauses num_true, unsat and unsat_pos have room for
+	c2dSize num_added;				//Number of added clauses searched
+	c2dSize* added_starts;			//Position in added_lits of the first literal of each added clause (added_starts[num_added + 1] is the end)
+	c2dLiteral* added_lits;			//Indices of the literals of the added clauses, one clause after the other
+	c2dSize* added_occurs_starts;	//Position in added_occurs of the first added clause containing each literal (indices -n to n+1)
+	c2dSize* added_occurs;			//Added clauses containing each literal (numbered from 1), one literal after the other
+	c2dSize added_capacity;			//Number of added clauses added_starts has room for
+	c2dSize added_lits_capacity;	//Number of literals added_lits and added_occurs have room for
+	BOOLEAN* fixed;					//1 for each variable set at the start level, whose value is forced (never flipped)
+	BOOLEAN* values;				//Current value of each variable
+	BOOLEAN* best;					//Value of each variable in the assignment falsifying the fewest clauses so far
+	c2dSize best_unsat;				//Number of clauses that assignment falsifies
+	c2dSize* num_true;				//Number of true literals in each clause
+	c2dSize* unsat;					//Clauses without a true literal
+	c2dSize num_unsat;				//Number of clauses without a true literal
+	c2dSize* unsat_pos;				//Position of each clause without a true literal in unsat
+	double break_probs[maxBreak + 1];	//Weight of a variable by its break count
+} LocalSearch;
+
+/******************************************************************************
+* ScenarioPropagation:
+* --Unit resolution run over 64 scenarios at once: each literal has the set of
+* scenarios it is true in, and a clause is visited once for all of them
+******************************************************************************/
+
+typedef struct scenario_propagation_t {
+	c2dScenarios* masks;		//Scenarios in which each literal is true (indices -n to n)
+	Lit** queue;				//Literals true in more scenarios, whose opposites' clauses are to be visited
+	c2dSize capacity;			//Number of literals queue has room for (2n, as a literal is queued once at a time)
+	c2dSize head;				//Position in queue of the next literal to visit
+	c2dSize num_queued;			//Number of literals in queue
+	BOOLEAN* queued;			//1 for the literals in queue (indices -n to n)
+	c2dScenarios conflicts;		//Scenarios in which a contradiction was found
+} ScenarioPropagation;
+
+/******************************************************************************
+* Proof:
+* --A binary DRAT proof being written: the solving thread fills one buffer while
+* a writer thread writes the other one to the file
+******************************************************************************/
+
+#define proofBufferSize (1 << 20)	//Bytes of each of the two buffers of a proof
+
+typedef struct proof_t {
+	FILE* file;						//File the proof is written to (a pipe to a compressor if piped)
+	BOOLEAN piped;					//1 if file was opened with popen()
+	BOOLEAN failed;					//1 if some of the proof could not be written
+	BOOLEAN closing;				//Set when the writer must stop once the pending bytes are written
+	unsigned char* buffers[2];		//Buffers of records
+	int filling;					//Buffer the solving thread adds records to
+	size_t used;					//Bytes used in that buffer
+	size_t pending;					//Bytes of the other buffer waiting to be written (0 once written)
+	pthread_t writer;				//Thread writing the buffers
+	pthread_mutex_t lock;			//Protects filling, pending and closing
+	pthread_cond_t cond;			//Signaled whenever pending or closing changes
+} Proof;
+
+/******************************************************************************
+* Trace:
+* --The last events of the search of a sat state, recorded in a ring buffer once
+* sat_trace_start() was called. The events of a level above SAT_TRACE_LEVEL are
+* not compiled in, and cost nothing
+******************************************************************************/
+
+#ifndef SAT_TRACE_LEVEL
+#define SAT_TRACE_LEVEL 1		//Events compiled in: 0 for none, 1 for all but implied literals, 2 for all
+#endif
+
+#define traceDecide 0			//A literal is decided (data is 0)
+#define traceImply 1			//A literal is implied by unit resolution (data is the clause it became unit on)
+#define traceConflict 2			//A clause has no free literal left (lit is 0)
+#define traceLearn 3			//A clause is learned (lit is the literal it asserts, data its size)
+#define traceBackjump 4			//A learned clause is asserted at its assertion level (lit is the literal it asserts, data the clause)
+#define traceRestart 5			//The search starts over from the start level (lit and data are 0)
+#define numTraceEvents 6		//Number of kinds of events
+
+#define traceMagic "SATTRAC"	//First bytes of a saved trace (with the terminating 0)
+#define traceVersion 1			//Version of the trace format
+
+//Record an event if its level is compiled in and the sat state is being traced
+#define TRACE_EVENT(type, lit, data, sat_state)												\
+	do {																					\
+		if (((type) == traceImply ? 2 : 1) <= SAT_TRACE_LEVEL && (sat_state)->trace != NULL)	\
+			record_trace_event(type, lit, data, sat_state);									\
+	} while (0)
+
+typedef struct trace_event_t {
+	c2dLiteral lit;					//Literal of the event (see the kinds of events above)
+	c2dSize data;					//Clause, size or level of the event (see the kinds of events above)
+	int level;						//Decision level the event happened at
+	int type;						//Kind of event
+} TraceEvent;
+
+typedef struct trace_t {
+	TraceEvent* events;				//Ring buffer of the last events
+	c2dSize capacity;				//Number of events the buffer holds (a power of 2)
+	c2dSize num_recorded;			//Number of events recorded since tracing started (event i lies at i % capacity)
+} Trace;
+
+typedef struct trace_header_t {
+	char magic[8];					//traceMagic
+	c2dSize version;				//traceVersion
+	c2dSize num_recorded;			//Number of events recorded since tracing started
+	c2dSize num_events;				//Number of events following the header (the last ones recorded, oldest first)
+	c2dSize level;					//SAT_TRACE_LEVEL of the library which recorded them
+} TraceHeader;			//Start of a saved trace, followed by its events as they lie in memory
+
+/******************************************************************************
+* Region:
+* --Large blocks of one kind (the clauses of the arenas, their occurrence
+* indexes, ...), each one mapped on its own and backed by transparent huge pages
+* so that walking them misses the TLB less. A mapping reserves twice the room
+* its block asks for, which lets the block grow in place
+******************************************************************************/
+
+#define hugePageSize ((size_t)2 << 20)		//Bytes of a transparent huge page
+#define hugeBlockSize ((size_t)1 << 20)		//Fewest bytes of a block mapped on its own (smaller ones are allocated by malloc)
+#define regionHeaderSize 64					//Bytes before each block, holding its RegionBlock
+
+#define clauseRegion 0			//Literals of the clauses of the arenas, and where each clause starts
+#define occursRegion 1			//Occurrence indexes of the arenas
+#define stateRegion 2			//Clauses of the sat states, with the pointers to their literals and to the clauses of each literal
+#define cacheRegion 3			//Cache entries of the knowledge compiler
+#define numRegions 4
+
+typedef struct region_block_t {
+	size_t size;						//Bytes asked for the block
+	size_t reserved;					//Bytes of its mapping, header included (0 if allocated by malloc)
+	int region;							//Region the block belongs to
+	struct region_block_t* prev;		//Previous mapped block of the region
+	struct region_block_t* next;		//Next mapped block of the region
+} RegionBlock;
+
+typedef struct region_t {
+	const char* name;					//Name the usage of the region is reported under
+	c2dSize bytes;						//Bytes asked for its blocks
+	RegionBlock* mapped_blocks;			//Blocks mapped on their own
+} Region;
+
+/******************************************************************************
+* SatStats:
+* --The counters of a sat state, as returned by sat_state_stats()
+******************************************************************************/
+
+#define statsBuckets 16			//Buckets of the histograms of learned clauses: bucket i > 0 counts the values from 2^i to 2^(i+1) - 1 (the last one all larger values), bucket 0 counts 0 and 1
+
+typedef struct sat_stats_t {
+	c2dSize decisions;							//Number of literals decided
+	c2dSize propagations;						//Number of literals set (decisions included)
+	c2dSize conflicts;							//Number of contradictions found
+	c2dSize learned;							//Number of learned clauses asserted
+	c2dSize learned_sizes[statsBuckets];		//Learned clauses asserted, by number of literals
+	c2dSize learned_lbds[statsBuckets];			//Learned clauses asserted, by lbd
+	c2dSize deleted;							//Number of learned clauses asserted then deleted (0, as none are deleted yet)
+	c2dSize dropped;							//Number of learned clauses dropped instead of asserted (never kept)
+	c2dSize restarts;							//Number of restarts
+	double seconds;								//Seconds since the sat state was constructed (or renewed)
+	double propagations_per_second;				//Propagations over those seconds
+	c2dSize memory;								//Estimate of the bytes allocated by the sat state (see sat_memory_usage())
+	c2dSize peak_memory;						//Most bytes the process ever had in memory (its peak resident set)
+} SatStats;
+
 /******************************************************************************
 * SatState:
 * --The following structure will keep track of the data needed to
@@ -121,22 +489,61 @@ typedef struct sat_state_t {
 	Var** vars;									//Array of pointers to variables (indices 1 to n)
 	Lit** lits;									//Array of pointers to literals (indices -n to -1 and 1 to n)
 	Clause *CNF;								//Array of clauses forming the CNF
+	ClauseArena* arena;							//Literal indices of the clauses forming the CNF (shared with clones)
+	Lit** clause_lits;							//Literals of all the clauses forming the CNF (each clause points into it)
+	Clause** clause_occurs;						//Clauses of the CNF containing each literal, one literal after the other (as in the arena's occurrence index)
+	VarCell* var_cells;							//Variables with their literals, in the order they are laid out in (1 to n)
+	c2dSize* var_order;							//Variable laid out at each position (1 to n), NULL if they are laid out by index
+	c2dSize* clause_positions;					//Position in CNF of each clause of the CNF (1 to m), NULL if they lie by index
+	nodePool list_nodes;						//Pool of the nodes of its lists of literals, clauses and decisions (which have the same size)
+	nodePool unit_nodes;						//Pool of the nodes of the lists of units of its decisions
+	nodePool decision_nodes;					//Pool of its decisions (each one followed by its list of units)
+	blockPool clause_blocks;					//Pool of its learned and added clauses (each one followed by its literals)
+	litVector scratch_lits;						//Literals of the clause being built (learned or blocking), reused from one clause to the next
 	clauseList *learnedClauses;					//List of learned clauses
+	clauseList *addedClauses;					//List of clauses added after the CNF was read
 	c2dLiteral num_lits;						//Number of literals
 	c2dSize num_vars;							//Number of variables
 	c2dSize num_clauses;						//Number of clauses in the CNF
 	int decision_level;							//Current decision level
 	decList* decisions;							//List of the decisions made (head is the most recent decision)
 	c2dSize num_learned;						//Number of learned clauses
+	c2dSize num_added;							//Number of added clauses
 	Clause* assertion_clause;					//Assertion clause found
+	double var_inc;								//Amount by which a variable's activity is bumped
+	Lit** failed;								//Assumptions responsible for the last unsatisfiable result
+	c2dSize num_failed;							//Number of failed assumptions
+	unsigned long* level_marks;					//Decision levels already counted when computing an lbd
+	unsigned long lbd_stamp;					//Mark of the lbd being computed in level_marks
+
+	unsigned long random_state;					//State of the random generator for decisions (0 if decisions are never random)
+	double random_freq;							//Fraction of decisions made on a random variable
+	c2dSize restart_interval;					//Contradictions before the first restart (0 for no restarts)
+	BOOLEAN luby_restarts;						//1 if the restart intervals follow the luby sequence, 0 if they grow geometrically
+	c2dSize num_conflicts;						//Number of contradictions found
+	c2dSize num_propagations;					//Number of literals set (decisions included)
+	c2dSize num_decisions;						//Number of literals decided
+	c2dSize num_restarts;						//Number of restarts
+	c2dSize num_dropped;						//Number of learned clauses dropped instead of asserted
+	c2dSize learned_sizes[statsBuckets];		//Learned clauses asserted, by number of literals (see statsBuckets)
+	c2dSize learned_lbds[statsBuckets];			//Learned clauses asserted, by lbd
+	double start_time;							//Time the sat state was constructed (or renewed) at, in seconds
+	c2dSize num_learned_lits;					//Number of literals in the learned and added clauses
+	c2dSize local_search_flips;					//Flips of each local search (0 for no local search)
+	c2dSize local_search_period;				//Restarts between two local searches
+	LocalSearch* local_search;					//Arrays of the local searches, kept from one to the next (NULL before the first)
+	const volatile BOOLEAN* stop;				//Solving gives up once this flag is set (NULL if never)
+	void (*on_learned)(const Clause* clause, void* data);	//Called on each learned clause before it is asserted
+	void (*on_restart)(struct sat_state_t* sat_state, void* data);	//Called on each restart, at the start level with nothing set
+	void* hook_data;							//Data passed to the hooks
+	Proof* proof;								//Proof being written (NULL if none)
+	Trace* trace;								//Events of the search being recorded (NULL if none)
 
 } SatState;
 
 typedef struct decision {
-	Lit* dec_lit;					//Literal on which the decision was made
-	dlitList* units;				//Unit literals found based on the decision made at this level
-	dlitList* implication_graph;	//Literals to inspect in the implication graph
-	int contradiction_lits;			//Number of literals in the contradiction clause found at this decision level
+	Lit* dec_lit;					//Literal on which the decision was made (NULL at the start level)
+	dlitList* units;				//Unit literals found based on the decision made at this level (in the order they are set)
 } Decision;
 
 /******************************************************************************
@@ -218,19 +625,19 @@ void sat_undo_decide_literal(SatState* sat_state);
 Lit* opp_lit(const Lit* lit);
 
 //Remove literal (performed when the opposite literal is decided or asserted by unit resolution)
-Clause* add_opposite(clauseList* clauses, SatState* sat_state);
+Clause* add_opposite(Clause** clauses, c2dSize num_clauses, SatState* sat_state);
 
 //Subsume all clauses containing a literal
-void subsume_clauses(Lit* lit, clauseList* clauses);
+void subsume_clauses(Lit* lit, Clause** clauses, c2dSize num_clauses);
 
 //Undoes a decision of a literal or a unit resolution of a literal
 void undo_set_literal(Lit* lit, SatState* sat_state);
 
 //Undo any subsumptions that occurred due to a decision or unit resolution
-void undo_subsume_clauses(Lit* lit, clauseList* clauses);
+void undo_subsume_clauses(Lit* lit, Clause** clauses, c2dSize num_clauses);
 
 //Undo remove literal (performed when the opposite literal is decided or asserted by unit resolution)
-void undo_add_opposite(clauseList* clauses);
+void undo_add_opposite(Clause** clauses, c2dSize num_clauses);
 
 /******************************************************************************
 * Clauses
@@ -239,7 +646,8 @@ void undo_add_opposite(clauseList* clauses);
 //returns a clause structure for the corresponding index
 Clause* sat_index2clause(c2dSize index, const SatState* sat_state);
 
-//returns the index of a clause
+//returns the index of a clause (learned and added clauses are numbered together after the cnf,
+//in the order they were asserted or added)
 c2dSize sat_clause_index(const Clause* clause);
 
 //returns the literals of a clause
@@ -264,38 +672,219 @@ c2dSize sat_learned_clause_count(const SatState* sat_state);
 //moreover, it should be called only if sat_at_assertion_level() succeeds
 Clause* sat_assert_clause(Clause* clause, SatState* sat_state);
 
+//Add a learned (or added) clause to those containing a literal, making room for twice as many if needed
+void add_learned_clause(Lit* lit, Clause* clause);
+
 //Check if a specific list of clauses are subsumed
-BOOLEAN check_list_subsumed(clauseList* clauses);
+BOOLEAN check_list_subsumed(Clause** clauses, c2dSize num_clauses);
 
-//Gets the only literal not instantiated
+//Gets the only literal not instantiated, with the kernel made for the size of the clause
 Lit* get_unit_lit(Clause* clause);
 
+//returns the free literal of a clause of 2, 3 or 4 literals, NULL if all of them are instantiated
+//(kernels of a fixed size, unrolled by the compiler)
+Lit* get_unit_lit_2(Lit** lits);
+Lit* get_unit_lit_3(Lit** lits);
+Lit* get_unit_lit_4(Lit** lits);
+
+//returns the free literal of a clause of any size, NULL if all of them are instantiated
+Lit* get_unit_lit_n(Lit** lits, c2dSize num_lits);
+
 /******************************************************************************
 * SatState
 ******************************************************************************/
 
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (- for stdin), which is decompressed if its name
+//ends with .gz, .xz or .bz2
+//exits if the file cannot be read or is not a cnf (see sat_state_try_new())
 SatState* sat_state_new(const char* file_name);
 
+//constructs a SatState from an input cnf file like sat_state_new(), but returns NULL if the file
+//cannot be read or is not a cnf (or is a bad snapshot), instead of exiting, and sets error (which
+//has room for error_size characters) to the reason
+SatState* sat_state_try_new(const char* file_name, char* error, size_t error_size);
+
+//constructs a SatState which shares the cnf of the given sat state, and copies its added and
+//learned clauses, variable activities, saved phases and settings (but not its stop flag and hooks)
+//the new sat state is at the start level with nothing set, whatever the level of the given one
+//
+//it only reads the given sat state, so several threads can clone the same idle sat state at once
+SatState* sat_state_clone(const SatState* sat_state);
+
+//constructs a SatState from an input cnf file, reusing the memory of a sat state which is no longer needed
+//(the given sat state must not be used afterwards, except through the returned one)
+//exits if the file cannot be read or is not a cnf (see sat_state_try_renew())
+SatState* sat_state_renew(SatState* sat_state, const char* file_name);
+
+//renews a SatState like sat_state_renew(), but returns NULL if the file cannot be read or is not a cnf,
+//instead of exiting, and sets error (which has room for error_size characters) to the reason
+//(the given sat state is then freed)
+SatState* sat_state_try_renew(SatState* sat_state, const char* file_name, char* error, size_t error_size);
+
+//lays out the variables (each one with its literals) and the clauses of a sat state in memory, so that
+//related ones lie close to each other: the variables in the order of the indices listed in var_order (n
+//of them), or, if var_order is NULL, in the order of breadth first searches of the primal graph of the
+//cnf (Cuthill-McKee), and the clauses by the first position of their variables in that order
+//indices of variables, literals and clauses stay the same, and so does the search, so the layout only
+//changes how much memory the search goes through (clones of the sat state are laid out the same)
+//
+//returns 1 if the sat state was laid out anew, and 0 if var_order does not list each variable once, or
+//if the sat state is not as constructed (with a literal set, or a clause learned or added)
+BOOLEAN sat_state_reorder(const c2dSize* var_order, SatState* sat_state);
+
+//Order the variables of a sat state by breadth first searches of the primal graph of its cnf (Cuthill-McKee)
+void cuthill_mckee_order(c2dSize* order, const SatState* sat_state);
+
+//returns the number of clauses of an arena mentioning a variable
+c2dSize var_degree(c2dSize var, const ClauseArena* arena);
+
+//Order VarRanks by increasing degree, then by increasing index
+int compare_var_ranks(const void* a, const void* b);
+
+//Lay out the clauses of the CNF of a sat state by the first position of their variables (from its arena)
+void reorder_clauses(const c2dSize* positions, SatState* sat_state);
+
 //frees the SatState
 void sat_state_free(SatState* sat_state);
 
+//Free what a SatState allocated, except for the SatState itself, its CNF, clause_lits and clause_occurs blocks, and its arena
+void free_sat_state_contents(SatState* sat_state);
+
+//Read the clauses of a cnf file into a new arena (without any sat state sharing it)
+ClauseArena* read_clause_arena(const char* file_name, char* error, size_t error_size);
+
+//returns a new arena without arrays (nor any sat state sharing it)
+ClauseArena* new_clause_arena();
+
+//Read the clauses of a cnf file into an arena no sat state shares, reusing its memory
+//returns 0 if the file could not be read, with the reason in error
+BOOLEAN fill_clause_arena(ClauseArena* arena, const char* file_name, char* error, size_t error_size);
+
+//Put an arena back to no arrays, unmapping its snapshot if it was loaded from one (borrowed literals are left alone)
+void reset_clause_arena(ClauseArena* arena);
+
+//Copy the literals an arena borrowed (see sat_builder_borrow_clauses()) into memory of its own, so they can be changed
+void own_clause_literals(ClauseArena* arena, c2dSize num_lits);
+
+//Build the occurrence index of an arena (the clauses containing each literal, in increasing order)
+void index_clause_arena(ClauseArena* arena);
+
+//Free the occurrence index of an arena not loaded from a snapshot, if it has one
+void free_clause_index(ClauseArena* arena);
+
+//Leave duplicate literals, tautologies and duplicate clauses out of an arena, keeping the order of the rest
+void normalize_clause_arena(ClauseArena* arena);
+
+//returns the code of a literal: twice its variable, plus 1 if it is negative
+c2dLiteral literal_code(c2dLiteral lit);
+
+//Sort the literals of a clause (or their codes) by increasing index
+void sort_clause_literals(c2dLiteral* lits, c2dSize num_lits);
+
+//Put the hashes of clauses in buckets by their highest bits, keeping the order of the clauses in each bucket
+c2dSize* bucket_clause_hashes(ClauseHash* hashes, c2dSize num_hashes, int bucket_bits);
+
+//returns 1 if two clauses of an arena, without repeated literals, have the same literals, 0 otherwise
+BOOLEAN same_clause_codes(const ClauseArena* arena, c2dSize clause, c2dSize other, c2dLiteral* codes, c2dLiteral* other_codes);
+
+//Build the index of the clauses containing each literal, with several threads
+void build_clause_occurrences(c2dSize num_vars, c2dSize num_clauses, const c2dSize* starts, const c2dLiteral* lits, c2dSize* occurs_starts, c2dSize* occurs, int num_threads);
+
+//Count the occurrences of each literal in the slices of an OccurrenceBuilder, one slice at a time
+void* count_occurrences(void* data);
+
+//Place the clauses of the slices of an OccurrenceBuilder under their literals, one slice at a time
+void* place_occurrences(void* data);
+
+//Run a function in num_threads threads (the calling one included) over the same data, and wait for them
+void run_threads(void* (*function)(void*), void* data, int num_threads);
+
+//returns the number of threads to work with (the number of processors online)
+int num_worker_threads();
+
+//Parse a mapped cnf after its problem line in chunks, each read by a thread, and merge them in order
+void parse_cnf_chunks(CnfParser* parser, const char* begin, const char* end, c2dSize num_chunks);
+
+//returns the character after the problem line of a mapped cnf, or NULL if comments are not all that come before it
+const char* find_cnf_body(const char* text, const char* end);
+
+//Read the chunks of a CnfChunks, one at a time
+void* scan_cnf_chunks(void* data);
+
+//Read the literals, and the 0s ending clauses, of a chunk
+void scan_cnf_chunk(CnfChunk* chunk);
+
+//Copy the literals kept of the chunks of a CnfChunks into its arena, one chunk at a time
+void* copy_cnf_chunks(void* data);
+
+//Point an arena into a snapshot mapped in memory, after checking it
+//returns 0 if the snapshot is bad, with the reason in error
+BOOLEAN load_snapshot(ClauseArena* arena, void* mapping, size_t length, const char* file_name, char* error, size_t error_size);
+
+//Read a cnf from a stream, parsing each chunk while a reader thread reads the next ones
+void read_cnf_stream(FILE* stream, CnfParser* parser);
+
+//Read the chunks of a stream until its end, or until the parser needs no more of them
+void* read_cnf_chunks(void* data);
+
+//Open a file, through the compressor matching the suffix of its name (.gz, .xz or .bz2) if it has one
+FILE* open_compressed(const char* file_name, BOOLEAN write, BOOLEAN* piped);
+
+//Start reading a cnf into an arena no sat state shares, reusing its memory
+void init_cnf_parser(CnfParser* parser, ClauseArena* arena, const char* file_name);
+
+//Read a chunk of the text of a cnf (the chunks are given in order)
+void parse_cnf_chunk(CnfParser* parser, const char* begin, const char* end);
+
+//End a number, which is a literal of the clause being read or the 0 ending it
+void parse_cnf_number(CnfParser* parser);
+
+//Read the problem line, and make room in the arena for the clauses it announces
+void parse_cnf_header(CnfParser* parser);
+
+//End reading a cnf once its whole text was given to the parser
+void finish_cnf_parser(CnfParser* parser);
+
+//Construct a SatState over the clauses of an arena, which it then shares
+SatState* sat_state_from_arena(ClauseArena* arena);
+
+//Set up a SatState over the clauses of an arena, which it then shares (reusing the SatState's CNF blocks if not NULL)
+void init_sat_state(SatState* satState, ClauseArena* arena);
+
+//Stop a sat state from sharing an arena, which is freed once no sat state shares it
+void release_clause_arena(ClauseArena* arena);
+
+//Copy a list of clauses of another sat state (over the same variables) into a list of this sat state, in the same order
+void copy_clause_list(const clauseList* from, c2dSize count, clauseList* into, SatState* sat_state);
+
+//Copy a clause of another sat state (over the same variables) into a list of this sat state
+Clause* copy_clause(const Clause* clause, clauseList* list, SatState* sat_state);
+
 //applies unit resolution to the cnf of sat state
 //returns 1 if unit resolution succeeds, 0 if it finds a contradiction
 BOOLEAN sat_unit_resolution(SatState* sat_state);
 
-//Check all of the initial clauses in the CNF are unit, and perform unit resolution if they are
+//Queue the unit literals of the clauses in the CNF, added clauses and learned clauses at the start level
 BOOLEAN initial_unit_resolution(SatState* sat_state);
 
+//Queue the unit literals of the clauses in a list
+BOOLEAN queue_unit_clauses(clauseList* clauses, SatState* sat_state);
+
+//Queue the unit literal of a clause on the latest decision
+void queue_unit(Lit* unit_lit, Clause* clause, SatState* sat_state);
+
 //undoes sat_unit_resolution(), leading to un-instantiating variables that have been instantiated
 //after sat_unit_resolution()
 void sat_undo_unit_resolution(SatState* sat_state);
 
-//Undoes resolution at decision level 0 (i.e. before a decision is made)
+//Undoes every decision and the resolution at the start level
 void undo_all_resolution(SatState* sat_state);
 
+//Take a decision on a literal (NULL at the start level) from the pool of a SatState
+Decision* new_decision(Lit* dec_lit, SatState* sat_state);
+
 //Free the decision and all its underlying pointers
-void free_decision(Decision* undo_dec);
+void free_decision(Decision* undo_dec, SatState* sat_state);
 
 //returns 1 if the decision level of the sat state equals to the assertion level of clause,
 //0 otherwise
@@ -310,18 +899,345 @@ Decision* get_latest_decision(SatState* sat_state);
 // Print out current clauses
 void debug_print_clauses(SatState*);
 
-//Gets the uip
-Lit* sat_get_uip(Clause* contradiction, SatState* sat_state);
+//Drop the units queued at a decision level that were not set before a contradiction was found
+void clear_pending_units(Decision* decision, SatState* sat_state);
 
-//Gets a queue of literals leading to the contradiciton clause in reverse order
-void find_uip_lits(Clause* contradiction, SatState* sat_state);
+//Mark the literals of a clause for conflict analysis
+int mark_conflict_lits(Clause* clause, const Var* skip, litVector* lower_lits, SatState* sat_state);
 
-//Perform DFS from the decision literal to the contradiciton clause
-BOOLEAN uip_DFS(SatState* sat_state);
-
-//Get the assertion clause
+//Get the assertion clause (first uip)
 Clause* get_assertion_clause(Clause* contradiction, SatState* sat_state);
 
+//Take a clause (learned or added) with room for its literals from the pool of a SatState
+Clause* new_clause(c2dSize num_lits, SatState* sat_state);
+
+//Drop a learned clause which was not asserted (its room is reused if it was the last clause taken)
+void drop_clause(Clause* clause, SatState* sat_state);
+
+/******************************************************************************
+* Builders
+* --A SatState constructed from clauses given in memory rather than in a file
+******************************************************************************/
+
+//constructs a builder of a cnf over num_vars variables (more are added as the clauses use them)
+SatBuilder* sat_builder_new(c2dSize num_vars);
+
+//adds a clause (copying its literals, given by their indices) to the cnf of a builder
+//an empty clause is skipped, as it is in a cnf file
+void sat_builder_add_clause(const c2dLiteral* lits, c2dSize num_lits, SatBuilder* builder);
+
+//adds clauses whose literals stay where they lie to the cnf of a builder: clause i (from 0) is
+//lits[offsets[i]] to lits[offsets[i + 1] - 1], so offsets has num_clauses + 1 entries
+//the literals must neither change nor be freed until the SatState constructed from the builder
+//(and its clones) are freed; they are copied anyway if the builder already has clauses
+void sat_builder_borrow_clauses(const c2dLiteral* lits, const c2dSize* offsets, c2dSize num_clauses, SatBuilder* builder);
+
+//constructs a SatState from the cnf of a builder, which is freed
+SatState* sat_builder_finish(SatBuilder* builder);
+
+//Check that literals given to a builder are not 0, and add the variables they are over to its cnf
+void check_builder_literals(const c2dLiteral* lits, c2dSize num_lits, SatBuilder* builder);
+
+/******************************************************************************
+* Incremental solving
+******************************************************************************/
+
+//adds a clause over the given literals to the cnf of sat state and returns it
+//it can only be called at the start level (returns NULL otherwise), and undoes unit
+//resolution at that level
+Clause* sat_add_clause(Lit** lits, c2dSize num_lits, SatState* sat_state);
+
+//checks the satisfiability of the cnf of sat state with the given literals assumed true
+//returns 1 if satisfiable (see sat_model_value()), 0 otherwise (see sat_failed_assumptions()),
+//and -1 if the stop flag (see sat_set_stop_flag()) was set before an answer was found
+//
+//the sat state is back at the start level when the call ends, while learned clauses,
+//variable activities and saved phases are kept for the next call
+BOOLEAN sat_solve_with_assumptions(Lit** assumptions, c2dSize num_assumptions, SatState* sat_state);
+
+//returns the assumptions responsible for the last unsatisfiable result, and stores their number in count
+//the count is 0 if the cnf is unsatisfiable without any assumption
+Lit** sat_failed_assumptions(c2dSize* count, const SatState* sat_state);
+
+//returns the value (1 or 0) of a variable in the last model found, -1 if there is none
+BOOLEAN sat_model_value(const Var* var);
+
+//decides the literal, counts the literals unit resolution implies from it and undoes the decision
+//returns the number of literals set by the decision (itself included), or -1 if unit resolution
+//finds a contradiction
+long sat_lookahead_literal(Lit* lit, SatState* sat_state);
+
+//Search for a model once unit resolution at the start level succeeded
+BOOLEAN search_with_assumptions(Lit** assumptions, c2dSize num_assumptions, SatState* sat_state);
+
+//Undo every decision, and let the restart hook add clauses at the start level
+BOOLEAN restart_search(SatState* sat_state);
+
+//Gets the number of contradictions allowed before the next restart
+c2dSize restart_limit(c2dSize restarts, const SatState* sat_state);
+
+//Gets the i^th term (from 0) of the luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+c2dSize luby(c2dSize i);
+
+//Gets the next number of the random generator of the sat state
+unsigned long next_random(SatState* sat_state);
+
+//Gets the free literal with the highest activity, in its saved phase
+Lit* get_branch_literal(SatState* sat_state);
+
+//Collect the assumptions that imply the opposite of a failed assumption
+void find_failed_assumptions(Lit* failed_lit, SatState* sat_state);
+
+//Backtrack to the assertion level of each learned clause and assert it there
+BOOLEAN assert_learned_clauses(Clause* learned, c2dSize* conflicts, SatState* sat_state);
+
+/******************************************************************************
+* Model enumeration
+* --The models of a cnf projected onto some of its variables, each found once
+******************************************************************************/
+
+//enumerates the models of the cnf of sat state projected onto the given variables (onto every
+//variable if num_vars is 0): on_model is called once per projected model with the literals of the
+//projection true in it (in the order of vars), while sat_model_value() gives a full model
+//enumeration ends once every model was found, on_model returns 0, or the stop flag is set
+//returns the number of models passed to on_model
+//
+//the clauses blocking the models found are kept as learned clauses, which are not implied by the cnf:
+//the sat state should be freed (or renewed) once the enumeration ends, and it enumerates nothing
+//(returning 0) while a proof is open, as the proof would not check
+c2dSize sat_enumerate_models(Var** vars, c2dSize num_vars, BOOLEAN (*on_model)(Lit** lits, c2dSize num_lits, void* data), void* data, SatState* sat_state);
+
+//Gets the free variable of the projection with the highest activity, in its saved phase
+Lit* get_projected_literal(SatState* sat_state);
+
+//Gets the clause over the opposites of the decisions made on variables of the projection
+Clause* get_blocking_clause(SatState* sat_state);
+
+/******************************************************************************
+* Local search
+******************************************************************************/
+
+//runs local search for at most the given number of flips, starting from the saved phases
+//(and the literals set at the start level), and saves the best assignment found as the phases
+//if it falsifies fewer clauses than the starting one
+//returns the number of clauses the best assignment falsifies (0 if it satisfies the cnf)
+c2dSize sat_local_search(c2dSize max_flips, SatState* sat_state);
+
+//returns a local search over the clauses of sat state, with the arrays which only depend on its variables
+LocalSearch* new_local_search(SatState* sat_state);
+
+//Set up the added clauses, counts and assignment of a local search over the phases of sat state
+void init_local_search(LocalSearch* search, SatState* sat_state);
+
+//Free a local search and its arrays
+void free_local_search(LocalSearch* search, SatState* sat_state);
+
+//returns the literals of a clause of a local search, and sets num_lits to their number
+const c2dLiteral* search_clause_literals(const LocalSearch* search, c2dSize clause, c2dSize* num_lits);
+
+//Count one more true literal in a clause, which leaves the falsified clauses if it had none
+void satisfy_search_clause(LocalSearch* search, c2dSize clause);
+
+//Count one less true literal in a clause, which joins the falsified clauses if it has none left
+void falsify_search_clause(LocalSearch* search, c2dSize clause);
+
+//Count the clauses only satisfied by the variable, which flipping it would falsify
+c2dSize break_count(LocalSearch* search, c2dSize var);
+
+//Flip a variable, updating the counts and the falsified clauses
+void flip_var(LocalSearch* search, c2dSize var);
+
+/******************************************************************************
+* Scenarios
+******************************************************************************/
+
+//runs unit resolution over up to 64 scenarios at once: scenario s assumes true the variables whose
+//bit s is set in true_masks, and false those whose bit s is set in false_masks (both indexed 1 to n),
+//on top of the literals currently set (which hold in every scenario)
+//the masks are extended in place with the literals unit resolution implies in each scenario
+//returns the scenarios in which unit resolution finds a contradiction (their bits in the masks are then meaningless)
+//
+//the sat state is left as it was, and the literals implied are those which deciding the
+//assumptions of a scenario one after the other would imply
+c2dScenarios sat_propagate_scenarios(c2dScenarios* true_masks, c2dScenarios* false_masks, SatState* sat_state);
+
+//Make a literal true in more scenarios, and queue it so the clauses of its opposite get visited
+void add_scenarios(Lit* lit, c2dScenarios scenarios, ScenarioPropagation* propagation);
+
+//Find the scenarios in which a clause is falsified, and those in which it is unit (whose free literal is made true)
+void propagate_clause_scenarios(const Clause* clause, ScenarioPropagation* propagation);
+
+/******************************************************************************
+* Snapshots
+* --A binary copy of the clauses of a cnf (and of their occurrences), which
+* sat_state_new() maps into memory instead of parsing
+******************************************************************************/
+
+//writes the cnf of sat state to a snapshot file; if simplify is 1, the clauses are first simplified
+//by unit resolution at the start level (subsumed clauses and false literals are left out, while
+//each literal implied is written as a unit clause), which keeps the models of the cnf
+//it must be called at the start level
+//returns 1 if the snapshot was written, 0 otherwise
+BOOLEAN sat_snapshot_save(const char* file_name, BOOLEAN simplify, SatState* sat_state);
+
+//Write the clauses given by starts and lits (and their occurrences) to a snapshot file
+BOOLEAN write_snapshot(const char* file_name, c2dSize num_vars, c2dSize num_clauses, const c2dSize* starts, const c2dLiteral* lits, const c2dSize* index_starts, const c2dSize* index);
+
+//Fold 8 byte words into a hash (used as the checksum of snapshots)
+unsigned long hash_words(unsigned long hash, const void* words, c2dSize num_words);
+
+/******************************************************************************
+* Proofs
+* --A sat state can write a binary DRAT proof of the unsatisfiability of its cnf,
+* which a checker such as drat-trim can verify
+******************************************************************************/
+
+//starts writing a binary DRAT proof to a file, piped through gzip, xz or bzip2 if the file
+//name ends with .gz, .xz or .bz2; every clause asserted from then on is added to the proof,
+//and so is the empty clause once a contradiction is found at the start level
+//returns 1 if the file could be opened, 0 otherwise
+BOOLEAN sat_proof_open(const char* file_name, SatState* sat_state);
+
+//writes what is left of the proof and closes its file
+//returns 1 if all of the proof was written, 0 otherwise (and if no proof was being written)
+BOOLEAN sat_proof_close(SatState* sat_state);
+
+//Write the records of the buffer handed over by the solving thread, until the proof is closed
+void* write_proof(void* data);
+
+//Hand the buffer being filled over to the writer, once it wrote the other one
+void swap_proof_buffers(Proof* proof);
+
+//Add a byte to the buffer being filled
+void proof_byte(unsigned char byte, Proof* proof);
+
+//Add a record ('a' to add the clause, 'd' to delete it) to a proof
+void proof_clause(const Clause* clause, unsigned char record, Proof* proof);
+
+/******************************************************************************
+* Tracing
+* --The events of the search (decisions, implied literals, contradictions, learned
+* clauses, backjumps and restarts) are kept in a ring buffer instead of printed
+******************************************************************************/
+
+//starts recording the events of the search of sat state in a ring buffer which keeps the last
+//num_events of them (rounded up to a power of 2), dropping the events recorded so far
+//returns 1 if tracing started, 0 if the library was built without it (SAT_TRACE_LEVEL 0)
+BOOLEAN sat_trace_start(c2dSize num_events, SatState* sat_state);
+
+//stops recording events and frees the ring buffer
+void sat_trace_stop(SatState* sat_state);
+
+//returns the number of events recorded since tracing started (the ring buffer keeps the last ones)
+c2dSize sat_trace_count(const SatState* sat_state);
+
+//writes the events held by the ring buffer to a file (in binary, see sat_trace_decode())
+//returns 1 if the file was written, 0 otherwise (and if no events are being recorded)
+BOOLEAN sat_trace_save(const char* file_name, const SatState* sat_state);
+
+//renders the events of a file written by sat_trace_save() as text, one event per line
+//returns 1 if the file was a trace and was read in full, 0 otherwise
+BOOLEAN sat_trace_decode(const char* file_name, FILE* out);
+
+//Add an event to the ring buffer of a sat state being traced (see TRACE_EVENT())
+void record_trace_event(int type, c2dLiteral lit, c2dSize data, SatState* sat_state);
+
+/******************************************************************************
+* Regions
+* --Large arrays are taken from regions backed by transparent huge pages, whose
+* usage is reported by kind
+******************************************************************************/
+
+//Map an aligned range of bytes backed by huge pages, with a page nothing can access after it
+void* map_huge_range(size_t length);
+
+//returns the name of a region (see clauseRegion and the like), NULL if there is no such region
+const char* sat_region_name(int region);
+
+//returns the number of bytes asked for the blocks of a region, and stores in huge_bytes (if not NULL)
+//how many of the bytes mapped for them lie in huge pages
+c2dSize sat_region_usage(int region, c2dSize* huge_bytes);
+
+//allocates a block of a region, freed by sat_region_free(): blocks of a megabyte or more are
+//mapped on their own and backed by huge pages
+void* sat_region_alloc(size_t size, int region);
+
+//allocates a block of a region whose bytes are all 0, freed by sat_region_free() (the pages of a
+//block mapped on its own are only touched, and zeroed by the kernel, once they are used)
+void* sat_region_calloc(size_t size, int region);
+
+//resizes a block of a region (allocates one if block is NULL), in place if its mapping has room
+void* sat_region_realloc(void* block, size_t size, int region);
+
+//frees a block allocated by sat_region_alloc() or sat_region_realloc() (nothing if block is NULL)
+void sat_region_free(void* block);
+
+/******************************************************************************
+* Solver configuration
+* --States solving the same cnf with different settings explore it differently,
+* which is what a portfolio of solvers relies on
+******************************************************************************/
+
+//seeds the random generator used for decisions, and gives the activities a small random
+//start so that differently seeded states branch differently (0 turns randomness off)
+void sat_set_seed(unsigned long seed, SatState* sat_state);
+
+//sets the fraction of decisions made on a random free variable (needs a non-zero seed)
+void sat_set_random_freq(double freq, SatState* sat_state);
+
+//sets the phase (1 positive, 0 negative) of every variable for its next decision
+void sat_set_default_phase(BOOLEAN phase, SatState* sat_state);
+
+//restarts the search after interval contradictions (0 for no restarts); later intervals
+//follow the luby sequence if luby is 1, and grow by half each time otherwise
+void sat_set_restarts(c2dSize interval, BOOLEAN luby, SatState* sat_state);
+
+//makes solving run local search for at most the given number of flips before its first decision, and
+//then every period restarts (0 flips turns local search off)
+void sat_set_local_search(c2dSize flips, c2dSize period, SatState* sat_state);
+
+//sets a flag which makes sat_solve_with_assumptions() give up once it is set
+void sat_set_stop_flag(const volatile BOOLEAN* stop, SatState* sat_state);
+
+//sets the functions called on each learned clause (before it is asserted) and on each restart
+//the restart hook is called at the start level with nothing set, so it may call sat_add_clause()
+void sat_set_hooks(void (*on_learned)(const Clause*, void*), void (*on_restart)(SatState*, void*), void* data, SatState* sat_state);
+
+//returns the number of decision levels among the literals of a learned clause when it was learned
+c2dSize sat_clause_lbd(const Clause* clause);
+
+//returns the number of contradictions found by the sat state so far
+c2dSize sat_conflict_count(const SatState* sat_state);
+
+//returns the number of literals set by the sat state so far (decisions included)
+c2dSize sat_propagation_count(const SatState* sat_state);
+
+//returns an estimate of the number of bytes allocated by the sat state (its arena included)
+c2dSize sat_memory_usage(const SatState* sat_state);
+
+//returns the number of blocks the calling thread allocated (or reallocated) in the library so far
+//the difference before and after a call is what the call allocated
+c2dSize sat_allocation_count();
+
+//returns the number of literals left out of the clauses of the cnf of sat state as repeated in their clause
+c2dSize sat_duplicate_literal_count(const SatState* sat_state);
+
+//returns the number of clauses left out of the cnf of sat state as containing a literal and its opposite
+c2dSize sat_tautology_count(const SatState* sat_state);
+
+//returns the number of clauses left out of the cnf of sat state as having the literals of an earlier clause
+c2dSize sat_duplicate_clause_count(const SatState* sat_state);
+
+//stores the counters of sat state in stats: decisions, propagations, contradictions, learned clauses
+//(with histograms of their sizes and lbds), deleted and dropped clauses, restarts, propagations per second and memory
+void sat_state_stats(SatStats* stats, const SatState* sat_state);
+
+//Gets the bucket of a histogram of learned clauses a value falls in (see statsBuckets)
+int stats_bucket(c2dSize value);
+
+//Gets the time of a monotonic clock, in seconds
+double monotonic_seconds();
+
 /******************************************************************************
 * The functions below are already implemented for you and MUST STAY AS IS
 ******************************************************************************/
@@ -1,6 +1,25 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE			//MAP_ANONYMOUS and MADV_HUGEPAGE
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <time.h>
+
 #include "sat_api.h"
 
-#define maxLength 500
+//Every block allocated in this file is counted for the calling thread (see sat_allocation_count())
+#define malloc(size) counted_malloc(size)
+#define calloc(count, size) counted_calloc(count, size)
+#define realloc(block, size) counted_realloc(block, size)
+
+__thread c2dSize allocated_blocks = 0;
+
+#define varDecay 0.95			//Factor by which older conflicts count less in variable activities
+#define activityLimit 1e100		//Activities are scaled down once one of them exceeds this value
+#define breakBase 2.5			//Local search picks a variable with a probability proportional to breakBase^-break
+#define maxSlsClause 64			//Local search only flips the first maxSlsClause literals of a clause
 
 /******************************************************************************
 * We explain here the functions you need to implement
@@ -52,34 +71,26 @@ BOOLEAN sat_instantiated_var(const Var* var) {
 //returns 1 if all the clauses mentioning the variable are subsumed, 0 otherwise
 BOOLEAN sat_irrelevant_var(const Var* var) {
 	//Find all the clauses containing the positive literal for non-learned clauses
-	if (check_list_subsumed(var->pos_lit->clauses) == 0)
+	if (check_list_subsumed(var->pos_lit->clauses, var->pos_lit->num_clauses) == 0)
 		return 0;
 
 	//Find all the clauses containing the negative literal for non-learned clauses
-	if (check_list_subsumed(var->neg_lit->clauses) == 0)
+	if (check_list_subsumed(var->neg_lit->clauses, var->neg_lit->num_clauses) == 0)
 		return 0;
 
 	return 1;
 }
 
 //Check if a specific list of clauses are subsumed
-//@param clauses: A list of clauses to check
-//@return 1 if all are subsumed, 0 otherwise
-BOOLEAN check_list_subsumed(clauseList* clauses)
+//@param clauses: An array of clauses to check
+//@param num_clauses: the number of clauses in the array
+//@return 1 if all are subsumed, 0 otherwise (an empty array is all subsumed)
+BOOLEAN check_list_subsumed(Clause** clauses, c2dSize num_clauses)
 {
-	//Create a node to traverse the list
-	clauseNode* curr = clauses->head;
-
-	//If the list is empty, then all clauses are subsumed
-	if (curr == NULL)
-		return 1;
-
 	//Loop through every clause containing the literal
-	do
-	{
-		if (curr->node_clause->subsumed == 0)
+	for (c2dSize i = 0; i < num_clauses; i++)
+		if (clauses[i]->subsumed == 0)
 			return 0;
-	} while ((curr = curr->next) != NULL);
 
 	return 1; //All clauses containing the variable are subsumed
 }
@@ -106,41 +117,13 @@ c2dSize sat_var_occurences(const Var* var) {
 //ONLY CONSIDERS ORIGINAL CNF CLAUSES
 Clause* sat_clause_of_var(c2dSize index, const Var* var) {
 	//Make sure the index is legal
-	if (index < 0 || index >= var->num_mentioned)
-		return NULL;
-
-	//Create a node to traverse the list of clauses containing the positive literal
-	clauseNode *curr = sat_pos_literal(var)->clauses->head;
-
-	if (curr == NULL)
-		return NULL;
-
-	//Counter to track the index of the current clause
-	unsigned long index_counter = 0;
-
-	//Loop through every clause containing the positive literal
-	do
-	{
-		if (index_counter == index)
-			return curr->node_clause;
-		index_counter++;
-	} while ((curr = curr->next) != NULL);
-
-	//Create a node to traverse the list of clauses containing the negative literal
-	curr = sat_neg_literal(var)->clauses->head;
-
-	if (curr == NULL)
+	if (index >= var->num_mentioned)
 		return NULL;
 
-	//Loop through every clause containing the negative literal
-	do
-	{
-		if (index_counter == index)
-			return curr->node_clause;
-		index_counter++;
-	} while ((curr = curr->next) != NULL);
-
-	return NULL; //All clauses containing the variable are subsumed
+	//The clauses containing the positive literal come first, then those containing the negative one
+	if (index < var->pos_lit->num_clauses)
+		return var->pos_lit->clauses[index];
+	return var->neg_lit->clauses[index - var->pos_lit->num_clauses];
 }
 
 /******************************************************************************
@@ -206,17 +189,13 @@ BOOLEAN sat_implied_literal(const Lit* lit) {
 //if the current decision level is L in the beginning of the call, it should be updated 
 //to L+1 so that the decision level of lit and all other literals implied by unit resolution is L+1
 Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
-	printf("Deciding lit: %ld\n", lit->index);
 	//Add literal to list of decisions
-	Decision* new_dec = (Decision*)malloc(sizeof(Decision));
-	new_dec->units = (dlitList*) malloc(sizeof(dlitList));
-	new_dec->units->head = NULL;
-	new_dec->units->tail = NULL;
-	new_dec->dec_lit = lit;
-	new_dec->implication_graph = (dlitList*)malloc(sizeof(dlitList));
-	decList_push(sat_state->decisions,new_dec);			//Push the decision to the list of decisions
+	Decision* new_dec = new_decision(lit, sat_state);
+	decList_push(sat_state->decisions, new_dec, &sat_state->list_nodes);			//Push the decision to the list of decisions
 
 	sat_state->decision_level++;	//Increment the decision level
+	sat_state->num_decisions++;
+	TRACE_EVENT(traceDecide, lit->index, 0, sat_state);
 
 	//Set the literal and get a contradiction clause if one exists
 	Clause* contradiction = set_literal(lit, sat_state); 
@@ -224,6 +203,9 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
 	//Learn a clause if a contradiction has been found
 	if (contradiction != NULL)
 	{
+		//Units queued by the decided literal are never set
+		clear_pending_units(new_dec, sat_state);
+
 		//Get the assertion clause
 		sat_state->assertion_clause = get_assertion_clause(contradiction, sat_state);
 
@@ -241,107 +223,120 @@ Clause* sat_decide_literal(Lit* lit, SatState* sat_state) {
 //@return a contradicted clause if one is found via add_opposite, NULL if no contradiction is found
 Clause* set_literal(Lit* lit, SatState* sat_state)
 {
-	printf("Setting literal %ld\n", lit->index);
 	//Set variable to instantiated
 	Var* var = sat_literal_var(lit);
 	var->instantiated = 1;
 
 	//Set the variable's decision level
 	var->decision_level = sat_state->decision_level;
+	sat_state->num_propagations++;
 
 	//Set the literal's and its opposite literal's truth value
 	lit->truth_value = 1;
 	opp_lit(lit)->truth_value = 0;
 
 	//Update all clauses containing the literal
-	subsume_clauses(lit, lit->clauses);
-	subsume_clauses(lit, lit->learnedClauses);
+	subsume_clauses(lit, lit->clauses, lit->num_clauses);
+	subsume_clauses(lit, lit->learnedClauses, lit->num_learned);
 
 	//Update all clauses containing the opposite of the literal				
-	Clause* contradiction = add_opposite(opp_lit(lit)->clauses, sat_state);
+	Lit* opposite = opp_lit(lit);
+	Clause* contradiction = add_opposite(opposite->clauses, opposite->num_clauses, sat_state);
 
-	//Update all learned clauses containing the opposite of the literal
+	//Update all learned clauses containing the opposite of the literal (even after a contradiction, so undo_set_literal stays balanced)
+	Clause* learned_contradiction = add_opposite(opposite->learnedClauses, opposite->num_learned, sat_state);
 	if(contradiction == NULL)
-		contradiction = add_opposite(opp_lit(lit)->learnedClauses, sat_state);
-		
-	printf("Contradiction = %p\n", contradiction);
+		contradiction = learned_contradiction;
+
 	return contradiction;
 }
 
 //Subsume all clauses containing a literal
 //@param lit: the literal causing the subsumption
-//@param clauses: the list of clauses being subsumed
-void subsume_clauses(Lit* lit, clauseList* clauses)
+//@param clauses: the clauses being subsumed
+//@param num_clauses: the number of clauses
+void subsume_clauses(Lit* lit, Clause** clauses, c2dSize num_clauses)
 {
-	//Create a node to traverse the list
-	clauseNode* curr = clauses->head;
-
-	//Loop through every clause containing the opposite of the literal
-	if (curr == NULL)
-		return;
-	do
+	//Loop through every clause containing the literal
+	for (c2dSize i = 0; i < num_clauses; i++)
 	{
+		Clause* clause = clauses[i];
+
 		//Skip clauses that have already been subsumed
-		if (curr->node_clause->subsumed == 1)
+		if (clause->subsumed == 1)
 			continue;
 
 		//Set subsumed to 1
-		curr->node_clause->subsumed = 1;
+		clause->subsumed = 1;
 		
 		//Set the literal the clause was subsumed on
-		curr->node_clause->subsumed_on = lit;
-	} while ((curr = curr->next) != NULL);
+		clause->subsumed_on = lit;
+	}
 }
 
 //Remove literal (performed when the opposite literal is decided or asserted by unit resolution)
 //@param clauses: the clauses which are being updated
+//@param num_clauses: the number of clauses
 //@param sat_state: the SatState of the problem space
 //@return contradiction clause if found, otherwise return NULL
-Clause* add_opposite(clauseList* clauses, SatState* sat_state)
+Clause* add_opposite(Clause** clauses, c2dSize num_clauses, SatState* sat_state)
 {
-	printf("start add_opposite\n");
-	//Create a node to traverse the list
-	clauseNode* curr = clauses->head;
-
 	//Literal that will be unit resolved on
 	Lit* unit_lit;
 
+	//First contradiction found (the remaining clauses are still updated)
+	Clause* contradiction = NULL;
+
 	//Loop through every clause containing the opposite of the literal
-	if (curr == NULL)
-		return NULL;
+	for (c2dSize i = 0; i < num_clauses; i++) {
+		Clause* clause = clauses[i];
 
-	do {
 		//Do not make changes to subsumed clauses
-		if (curr->node_clause->subsumed == 1)
+		if (clause->subsumed == 1)
 			continue;
 
 		//Decrement the number of free literals
-		curr->node_clause->free_lits--;
+		clause->free_lits--;
 
 		//Check if the number of literals is 1 (i.e. perform unit resolution)
-		if (curr->node_clause->free_lits == 1)
+		if (clause->free_lits == 1)
 		{
-			unit_lit = get_unit_lit(curr->node_clause);
-			dlitList_push_back(get_latest_decision(sat_state)->units,unit_lit);
-			
-			//Set this literal's unit_on variable
-			unit_lit->unit_on = curr->node_clause;
-
-			//Loop through each literal in the clause
-			for (int i = 0; i < curr->node_clause->num_lits; i++)
-			{
-				//Add this unit to each of its parents' list of children
-				if (curr->node_clause->literals[i] != unit_lit)
-					litList_push(curr->node_clause->literals[i]->unit_children, unit_lit);
-			}
+			unit_lit = get_unit_lit(clause);
+			queue_unit(unit_lit, clause, sat_state);
 		}
 
 		//Check if the number of literals is 0 (i.e. a contradiction was found)
-		if (curr->node_clause->free_lits == 0)
-			return curr->node_clause;
-	} while ((curr = curr->next) != NULL);
+		if (clause->free_lits == 0 && contradiction == NULL)
+			contradiction = clause;
+	}
 	
-	return NULL;
+	return contradiction;
+}
+
+//Queue the unit literal of a clause on the latest decision
+//@param unit_lit: the only free literal of the clause
+//@param clause: the clause on which unit_lit becomes unit
+//@param sat_state: the SatState of the problem space
+void queue_unit(Lit* unit_lit, Clause* clause, SatState* sat_state)
+{
+	//A literal is queued at most once (unit_on is cleared when it is unqueued)
+	if (unit_lit == NULL || unit_lit->unit_on != NULL)
+		return;
+
+	dlitList_push_back(get_latest_decision(sat_state)->units, unit_lit, &sat_state->unit_nodes);
+
+	//Set this literal's unit_on variable
+	unit_lit->unit_on = clause;
+}
+
+//Drop the units queued at a decision level that were not set before a contradiction was found
+//@param decision: the decision whose units are cleared
+//@param sat_state: the SatState whose pool the nodes are given back to
+void clear_pending_units(Decision* decision, SatState* sat_state)
+{
+	//Units are set in order, so the unset ones are at the end of the list (their opposite may be set)
+	while (decision->units->tail != NULL && decision->units->tail->node_lit->truth_value != 1)
+		dlitList_pop_back(decision->units, &sat_state->unit_nodes)->unit_on = NULL;
 }
 
 //undoes the last literal decision and the corresponding implications obtained by unit resolution
@@ -349,7 +344,6 @@ Clause* add_opposite(clauseList* clauses, SatState* sat_state)
 //if the current decision level is L in the beginning of the call, it should be updated 
 //to L-1 before the call ends
 void sat_undo_decide_literal(SatState* sat_state) {
-	printf("Undo decision at level %d\n", sat_state->decision_level);
 	//Undo unit resolution			
 	sat_undo_unit_resolution(sat_state);
 
@@ -357,13 +351,13 @@ void sat_undo_decide_literal(SatState* sat_state) {
 	sat_state->assertion_clause = NULL;
 	
 	//Get decision to undecide
-	Decision* undo_dec = decList_pop(sat_state->decisions);
+	Decision* undo_dec = decList_pop(sat_state->decisions, &sat_state->list_nodes);
 
 	//Undo the decision of the literal and remove the decision from the list of decisions
 	undo_set_literal(undo_dec->dec_lit, sat_state);
 
 	//Free the decision and all its underlying pointers
-	free_decision(undo_dec);
+	free_decision(undo_dec, sat_state);
 
 	//Decrement the decision level
 	sat_state->decision_level--;
@@ -374,7 +368,6 @@ void sat_undo_decide_literal(SatState* sat_state) {
 //@param sat_state: the SatState of the CNF
 void undo_set_literal(Lit* lit, SatState* sat_state)
 {
-	printf("undoing set literal %ld\n", lit->index);
 	//Set variable to uninstantiated
 	Var* var = sat_literal_var(lit);
 	var->instantiated = 0;
@@ -382,66 +375,59 @@ void undo_set_literal(Lit* lit, SatState* sat_state)
 	//Reset the variable's decision level
 	var->decision_level = -1;
 
+	//Save the phase of the variable for its next decision
+	var->phase = (lit == var->pos_lit);
+
 	//Set the literal's and its opposite literal's truth value
 	lit->truth_value = -1;
 	opp_lit(lit)->truth_value = -1;
 
-	//Reverse all clauses containing the literal
-	undo_subsume_clauses(lit, lit->clauses);
-	undo_subsume_clauses(lit, lit->learnedClauses);
+	//Reverse all clauses containing the opposite of the literal (in the reverse order of set_literal)
+	Lit* opposite = opp_lit(lit);
+	undo_add_opposite(opposite->clauses, opposite->num_clauses);
+	undo_add_opposite(opposite->learnedClauses, opposite->num_learned);
 
-	//Reverse all clauses containing the opposite of the literal
-	undo_add_opposite(opp_lit(lit)->clauses);
-	undo_add_opposite(opp_lit(lit)->learnedClauses);
+	//Reverse all clauses containing the literal
+	undo_subsume_clauses(lit, lit->clauses, lit->num_clauses);
+	undo_subsume_clauses(lit, lit->learnedClauses, lit->num_learned);
 }
 
 //Undo any subsumptions that occurred due to a decision or unit resolution
 //@param lit: the literal on which the clause was subsumed
-//@param clauses: the list of clauses containing lit
-void undo_subsume_clauses(Lit* lit, clauseList* clauses)
+//@param clauses: the clauses containing lit
+//@param num_clauses: the number of clauses
+void undo_subsume_clauses(Lit* lit, Clause** clauses, c2dSize num_clauses)
 {
-	printf("Undo subsume clauses for lit: %ld\n", lit->index);
-	//Create a node to traverse the list
-	clauseNode* curr = clauses->head;
-
-	//Loop through every clause containing the opposite of the literal
-	if (curr == NULL)
-		return;
+	//Loop through every clause containing the literal
+	for (c2dSize i = 0; i < num_clauses; i++) {
+		Clause* clause = clauses[i];
 
-	do {
 		//Only reverse the subsumption if the clause was subsumed on this literal
-		if (curr->node_clause->subsumed_on != lit)
+		if (clause->subsumed_on != lit)
 			continue;
 
 		//Set subsumed to 0
-		curr->node_clause->subsumed = 0;
+		clause->subsumed = 0;
 		
 		//Reset the literal the clause was subsumed on
-		curr->node_clause->subsumed_on = NULL;
-	} while ((curr = curr->next) != NULL);
+		clause->subsumed_on = NULL;
+	}
 }
 
 //Undo remove literal (performed when the opposite literal is decided or asserted by unit resolution)
 //@param clauses: the clauses which are being updated
-void undo_add_opposite(clauseList* clauses)
+//@param num_clauses: the number of clauses
+void undo_add_opposite(Clause** clauses, c2dSize num_clauses)
 {
-	printf("Undoing add_opposite\n");
-	//Create a node to traverse the list
-	clauseNode* curr = clauses->head;
-
 	//Loop through every clause containing the opposite of the literal
-	if (curr == NULL)
-		return;
-
-	//Loop through original clauses
-	do {
+	for (c2dSize i = 0; i < num_clauses; i++) {
 		//If the clause is subsumed, do not make any changes to it
-		if (curr->node_clause->subsumed == 1)
+		if (clauses[i]->subsumed == 1)
 			continue;
 
 		//Increment the number of free literals
-		curr->node_clause->free_lits++;
-	} while ((curr = curr->next) != NULL);
+		clauses[i]->free_lits++;
+	}
 }
 
 /******************************************************************************
@@ -451,12 +437,13 @@ void undo_add_opposite(clauseList* clauses)
 //returns a clause structure for the corresponding index
 Clause* sat_index2clause(c2dSize index, const SatState* sat_state) {
 	if (sat_state != NULL && index > 0 && index <= sat_state->num_clauses)
-		return &(sat_state->CNF[index]);
+		return &(sat_state->CNF[sat_state->clause_positions == NULL ? index : sat_state->clause_positions[index]]);
 
 	return NULL;	//Parameter error
 }
 
-//returns the index of a clause
+//returns the index of a clause (learned and added clauses are numbered together after the cnf,
+//in the order they were asserted or added)
 c2dSize sat_clause_index(const Clause* clause) {
 	if (clause == NULL)
 		return 0;
@@ -505,43 +492,110 @@ c2dSize sat_learned_clause_count(const SatState* sat_state) {
 //moreover, it should be called only if sat_at_assertion_level() succeeds
 Clause* sat_assert_clause(Clause* clause, SatState* sat_state) {
 	//Add clause to list of clauses
-	clauseList_push(sat_state->learnedClauses, clause);
+	clauseList_push(sat_state->learnedClauses, clause, &sat_state->list_nodes);
+
+	if (sat_state->proof != NULL)
+		proof_clause(clause, 'a', sat_state->proof);
 
 	//Increment the number of clauses learned
 	sat_state->num_learned++;
+	sat_state->num_learned_lits += clause->num_lits;
+	//Learned and added clauses are numbered after the cnf from a single sequence
+	clause->index = sat_state->num_clauses + sat_state->num_added + sat_state->num_learned;
+	sat_state->learned_sizes[stats_bucket(clause->num_lits)]++;
+	sat_state->learned_lbds[stats_bucket(clause->lbd)]++;
+	TRACE_EVENT(traceBackjump, clause->num_lits == 0 ? 0 : clause->literals[0]->index, clause->index, sat_state);
 
 	//Stores each literal in the clause
 	Lit* clause_lit;
 
+	//Literals set before the clause was learned are not counted as free
+	clause->free_lits = clause->num_lits;
+
 	//Add clause to hashtable of literal-clauses for each literal
 	for (int i = 0; i < clause->num_lits; i++)
 	{
 		//Get the current literal
 		clause_lit = clause->literals[i];
 		
-		//Push the new clause onto the list of clauses associated with the current variable
-		clauseList_push(clause_lit->clauses, clause);
+		//Add the new clause to the learned clauses associated with the current literal
+		add_learned_clause(clause_lit, clause);
+
+		if (clause_lit->truth_value == 0)
+			clause->free_lits--;
 	}
 
+	//The clause is unit at its assertion level
+	if (clause->free_lits == 1)
+		queue_unit(get_unit_lit(clause), clause, sat_state);
+
 	//Run unit resolution
 	sat_unit_resolution(sat_state);
 	return sat_state->assertion_clause;
 }
 
-//Gets the only literal not instantiated
+//Add a learned (or added) clause to those containing a literal, making room for twice as many if needed
+//@param lit: the literal
+//@param clause: the clause
+void add_learned_clause(Lit* lit, Clause* clause)
+{
+	if (lit->num_learned == lit->learned_capacity) {
+		lit->learned_capacity = 2 * lit->learned_capacity + 4;
+		lit->learnedClauses = (Clause**)realloc(lit->learnedClauses, lit->learned_capacity * sizeof(Clause*));
+	}
+	lit->learnedClauses[lit->num_learned++] = clause;
+}
+
+//Gets the only literal not instantiated, with the kernel made for the size of the clause
 //@param clause: the clause to be search for a unit literal
 //@return the unit literal
 Lit* get_unit_lit(Clause* clause)
 {
-	//Traverse each literal in the clause
-	for (int i = 0; i < clause->num_lits; i++)
+	//NULL if all literals are instantiated (ERROR)
+	switch (clause->num_lits)
 	{
-		printf("Found unit lit: clause %lu lit %ld has truth_value %d\n", clause->index, clause->literals[i]->index, clause->literals[i]->truth_value);
-		if (clause->literals[i]->truth_value == -1)
-			return clause->literals[i];
-		
+	case 2: return get_unit_lit_2(clause->literals);
+	case 3: return get_unit_lit_3(clause->literals);
+	case 4: return get_unit_lit_4(clause->literals);
+	default: return get_unit_lit_n(clause->literals, clause->num_lits);
 	}
-	return NULL;	//All literals are instantiated (ERROR)
+}
+
+/******************************************************************************
+* Clause kernels
+*
+* The free literal of a clause made unit is found by a kernel made for the size
+* of the clause. The kernels of clauses of 2, 3 and 4 literals go through a fixed
+* number of literals, which the compiler unrolls into straight comparisons, and
+* longer clauses go through the generic kernel. get_unit_lit() looks at the size
+* once per clause made unit.
+******************************************************************************/
+
+//Define the kernel finding the free literal of the clauses of size literals: every literal is looked at
+//(from the last to the first, so the first free one is kept), which compiles to loads and conditional moves
+//without branches, so the loads of the literals overlap and no branch is mispredicted
+#define DEFINE_UNIT_KERNEL(size)								\
+Lit* get_unit_lit_##size(Lit** lits)							\
+{																\
+	Lit* unit_lit = NULL;										\
+	for (int i = size - 1; i >= 0; i--)							\
+		unit_lit = lits[i]->truth_value == -1 ? lits[i] : unit_lit;	\
+	return unit_lit;											\
+}
+
+DEFINE_UNIT_KERNEL(2)
+DEFINE_UNIT_KERNEL(3)
+DEFINE_UNIT_KERNEL(4)
+
+//returns the free literal of a clause of any size, NULL if all of them are instantiated
+//@param lits: the literals of the clause
+//@param num_lits: the number of literals
+Lit* get_unit_lit_n(Lit** lits, c2dSize num_lits)
+{
+	for (c2dSize i = 0; i < num_lits; i++)
+		if (lits[i]->truth_value == -1)
+			return lits[i];
+	return NULL;
 }
 
 /******************************************************************************
@@ -564,670 +618,3702 @@ Lit* get_unit_lit(Clause* clause)
 * SatState (sat_state_free)
 ******************************************************************************/
 
-//constructs a SatState from an input cnf file
+//constructs a SatState from an input cnf file (- for stdin), which is decompressed if its name
+//ends with .gz, .xz or .bz2
+//exits if the file cannot be read or is not a cnf (see sat_state_try_new())
 SatState* sat_state_new(const char* file_name) {
-	// Open file for reading
-	FILE* file = fopen(file_name, "r");
-	if (file == NULL) {
-		fprintf(stderr, "Could not open file %s\n", file_name);
+	char error[maxLength];
+	SatState* sat_state = sat_state_try_new(file_name, error, maxLength);
+	if (sat_state == NULL) {
+		fprintf(stderr, "%s\n", error);
 		exit(1);
 	}
+	return sat_state;
+}
 
-	c2dSize num_vars = 0, num_clauses = 0;
-	char line[maxLength];
+//constructs a SatState from an input cnf file like sat_state_new(), but returns NULL if the file
+//cannot be read or is not a cnf (or is a bad snapshot), instead of exiting
+//@param file_name: the cnf file
+//@param error: set to the reason the file could not be read
+//@param error_size: the number of characters error has room for
+//@return the SatState, NULL if the file could not be read
+SatState* sat_state_try_new(const char* file_name, char* error, size_t error_size) {
+	ClauseArena* arena = read_clause_arena(file_name, error, error_size);
+	return arena == NULL ? NULL : sat_state_from_arena(arena);
+}
 
-	// Capture problem line info (i.e. number of variables and clauses)
-	while (fgets(line, maxLength, file) != NULL) {
-		// Skip comment lines
-		if (line[0] == 'c' || line[0] == '%' || line[0] == '0')
-			continue;
-		// check for problem statement line
-		char* token;
-		if (line[0] == 'p') {
-			token = strtok(line, " \n"); // token == 'p'
-			token = strtok(NULL, " \n"); // token == 'cnf'
+//Read the clauses of a cnf file into a new arena (without any sat state sharing it)
+//@param file_name: the cnf file
+//@param error: set to the reason the file could not be read
+//@param error_size: the number of characters error has room for
+//@return the arena, NULL if the file could not be read
+ClauseArena* read_clause_arena(const char* file_name, char* error, size_t error_size) {
+	ClauseArena* arena = new_clause_arena();
+	if (!fill_clause_arena(arena, file_name, error, error_size)) {
+		free(arena);
+		return NULL;
+	}
+	return arena;
+}
 
-			token = strtok(NULL, " \n"); // token == <number of variables>
-			num_vars = strtoul(token, NULL, 10);
+//returns a new arena without arrays (nor any sat state sharing it)
+ClauseArena* new_clause_arena() {
+	ClauseArena* arena = (ClauseArena*)malloc(sizeof(ClauseArena));
+	arena->starts = NULL;
+	arena->starts_capacity = 0;
+	arena->lits = NULL;
+	arena->lits_capacity = 0;
+	arena->lits_borrowed = 0;
+	arena->occurs_starts = NULL;
+	arena->occurs = NULL;
+	arena->mapping = NULL;
+	arena->mapping_length = 0;
+	return arena;
+}
 
-			token = strtok(NULL, " \n"); // token == <number of clauses>
-			num_clauses = strtoul(token, NULL, 10);
-			break;
-		}
+//Read the clauses of a cnf file into an arena no sat state shares, reusing its memory
+//A file is mapped into memory and parsed where it lies, in a single pass, while stdin (-) and
+//compressed files (.gz, .xz or .bz2) are read in chunks by a reader thread as they are parsed
+//A large file is cut into chunks parsed by several threads (see parse_cnf_chunks())
+//The arena of a snapshot file (see sat_snapshot_save()) is left where it is mapped
+//If the file cannot be read, the arena is left without arrays (nor clauses)
+//@param arena: the arena, whose clauses are replaced
+//@param file_name: the cnf file
+//@param error: set to the reason the file could not be read
+//@param error_size: the number of characters error has room for
+//@return 1 if the file was read, 0 otherwise
+BOOLEAN fill_clause_arena(ClauseArena* arena, const char* file_name, char* error, size_t error_size) {
+	CnfParser parser;
+	if (arena->mapping != NULL || arena->lits_borrowed)
+		reset_clause_arena(arena);
+	else
+		free_clause_index(arena);
+	init_cnf_parser(&parser, arena, file_name);
+
+	BOOLEAN piped = 0;
+	FILE* stream = strcmp(file_name, "-") == 0 ? stdin : open_compressed(file_name, 0, &piped);
+	struct stat st;
+	if (stream == NULL || fstat(fileno(stream), &st) != 0) {
+		if (piped && stream != NULL)
+			pclose(stream);
+		else if (stream != NULL && stream != stdin)
+			fclose(stream);
+		reset_clause_arena(arena);
+		snprintf(error, error_size, "Could not open file %s", file_name);
+		return 0;
 	}
 
-	// Create SatState, add basic values
-	SatState* satState = (SatState*)malloc(sizeof(SatState));
-	satState->num_vars = num_vars;
-	satState->num_clauses = num_clauses;
-	satState->num_lits = 2 * num_vars;
-	satState->decision_level = 1;
-	satState->num_learned = 0;
-	satState->learnedClauses = (clauseList*) malloc(sizeof(clauseList));
-	satState->learnedClauses->head = NULL;
-	satState->decisions = (decList*) malloc(sizeof(decList));
-	satState->decisions->head = NULL;
-	satState->assertion_clause = NULL;
+	// Pipes, stdin and files which cannot be mapped (such as empty ones) are read in chunks
+	size_t length = (size_t)st.st_size;
+	char* text = (char*)MAP_FAILED;
+	if (stream != stdin && !piped && S_ISREG(st.st_mode) && length > 0)
+		text = (char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileno(stream), 0);
+	if (text == MAP_FAILED)
+		read_cnf_stream(stream, &parser);
+	else if (length >= sizeof(SnapshotHeader) && memcmp(text, snapshotMagic, sizeof(snapshotMagic)) == 0) {
+		reset_clause_arena(arena);
+		BOOLEAN loaded = load_snapshot(arena, text, length, file_name, error, error_size);
+		if (!loaded)
+			munmap(text, length);
+		fclose(stream);
+		return loaded;
+	}
+	else {
+		//The problem line is parsed alone, and the clauses after it in chunks if there are enough of them
+		const char* body = length / parseChunkSize > 1 ? find_cnf_body(text, text + length) : NULL;
+		posix_madvise(text, length, POSIX_MADV_SEQUENTIAL);
+		if (body == NULL)
+			parse_cnf_chunk(&parser, text, text + length);
+		else {
+			parse_cnf_chunk(&parser, text, body);
+			parse_cnf_chunks(&parser, body, text + length, (text + length - body) / parseChunkSize);
+		}
+		munmap(text, length);
+	}
+	if (parser.error[0] == '\0')
+		finish_cnf_parser(&parser);
+	if (piped)
+		pclose(stream);
+	else if (stream != stdin)
+		fclose(stream);
+
+	if (parser.error[0] != '\0') {
+		reset_clause_arena(arena);
+		arena->num_vars = 0;
+		arena->num_clauses = 0;
+		snprintf(error, error_size, "%s", parser.error);
+		return 0;
+	}
+	normalize_clause_arena(arena);
+	index_clause_arena(arena);
+	return 1;
+}
 
-	/*************************************************************/
-	/*********************SETUP VARS AND LITS*********************/
-	/*************************************************************/
+//Put an arena back to no arrays, unmapping its snapshot if it was loaded from one (borrowed literals are left alone)
+//@param arena: the arena
+void reset_clause_arena(ClauseArena* arena) {
+	if (arena->mapping != NULL)
+		munmap(arena->mapping, arena->mapping_length);
+	else {
+		free_clause_index(arena);
+		sat_region_free(arena->starts);
+		if (!arena->lits_borrowed)
+			sat_region_free(arena->lits);
+	}
+	arena->starts = NULL;
+	arena->starts_capacity = 0;
+	arena->lits = NULL;
+	arena->lits_capacity = 0;
+	arena->lits_borrowed = 0;
+	arena->occurs_starts = NULL;
+	arena->occurs = NULL;
+	arena->mapping = NULL;
+	arena->mapping_length = 0;
+}
 
-	satState->vars = (Var**)malloc((num_vars + 1) * sizeof(Var*));
-	satState->lits = (Lit**)malloc(((2 * num_vars) + 1) * sizeof(Lit*));
+//Build the occurrence index of an arena (the clauses containing each literal, in increasing order), with
+//two counting passes over its clauses (see build_clause_occurrences())
+//@param arena: the arena, without an index
+void index_clause_arena(ClauseArena* arena) {
+	c2dSize num_vars = arena->num_vars;
+	arena->occurs_starts = (c2dSize*)sat_region_alloc((2 * num_vars + 2) * sizeof(c2dSize), occursRegion) + num_vars;
+	arena->occurs = (c2dSize*)sat_region_alloc((arena->starts[arena->num_clauses + 1] + 1) * sizeof(c2dSize), occursRegion);
+	build_clause_occurrences(num_vars, arena->num_clauses, arena->starts, arena->lits, arena->occurs_starts, arena->occurs, num_worker_threads());
+}
 
+//Free the occurrence index of an arena not loaded from a snapshot, if it has one
+//@param arena: the arena
+void free_clause_index(ClauseArena* arena) {
+	if (arena->occurs_starts != NULL)
+		sat_region_free(arena->occurs_starts - arena->num_vars);
+	sat_region_free(arena->occurs);
+	arena->occurs_starts = NULL;
+	arena->occurs = NULL;
+}
 
-	// This step sets the start of the literals array in the middle, so we can index in + and - direction
-	satState->lits = satState->lits + num_vars;
+//Leave duplicate literals, tautologies and duplicate clauses out of an arena, keeping the order of the
+//literals and clauses left (which are numbered again from 1), and count what was left out
+//The codes of the literals of a clause (see literal_code()) are sorted, so that repeated literals and
+//opposite ones are next to each other. Clauses are found to be duplicates by hashing their sorted
+//codes: the hashes are split by their highest bits into buckets small enough for the cache, and
+//each bucket is searched with its own hash table (one table for all the clauses would miss the
+//cache on almost every clause of a large cnf)
+//@param arena: the arena, just read
+void normalize_clause_arena(ClauseArena* arena) {
+	c2dSize num_clauses = arena->num_clauses;
+	ClauseHash* hashes = (ClauseHash*)malloc((num_clauses + 1) * sizeof(ClauseHash));
+	c2dSize* stamps = NULL;
+	c2dSize num_kept = 0;
+	c2dSize size = 0;
+
+	// Room for the sorted codes of the longest clause, twice
+	c2dSize longest = 0;
+	for (c2dSize i = 1; i <= num_clauses; i++)
+		if (arena->starts[i + 1] - arena->starts[i] > longest)
+			longest = arena->starts[i + 1] - arena->starts[i];
+	c2dLiteral* codes = (c2dLiteral*)malloc((2 * longest + 1) * sizeof(c2dLiteral));
+
+	// Clauses only move towards the front, so each one is read before anything is written over it
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		c2dSize begin = arena->starts[i];
+		c2dSize length = arena->starts[i + 1] - begin;
+		for (c2dSize j = 0; j < length; j++)
+			codes[j] = literal_code(arena->lits[begin + j]);
+		sort_clause_literals(codes, length);
+
+		BOOLEAN repeated = 0, tautology = 0;
+		c2dSize num_codes = length > 0 ? 1 : 0;
+		for (c2dSize j = 1; j < length; j++) {
+			if (codes[j] == codes[num_codes - 1]) {
+				repeated = 1;
+				continue;
+			}
+			if (codes[j] >> 1 == codes[num_codes - 1] >> 1)
+				tautology = 1;
+			codes[num_codes++] = codes[j];
+		}
+		if (tautology) {
+			arena->num_tautologies++;
+			continue;
+		}
 
-	satState->vars[0] = NULL;
-	satState->lits[0] = NULL;
+		// Borrowed literals are copied before the first one moves (clean clauses never move)
+		if (arena->lits_borrowed && (repeated || size != begin))
+			own_clause_literals(arena, arena->starts[num_clauses + 1]);
+
+		// The first occurrence of each literal is kept, found by stamping variables with the clause
+		if (repeated) {
+			if (stamps == NULL)
+				stamps = (c2dSize*)calloc(arena->num_vars + 1, sizeof(c2dSize));
+			for (c2dSize j = begin; j < begin + length; j++) {
+				c2dLiteral lit = arena->lits[j];
+				c2dSize var = lit > 0 ? lit : -lit;
+				if (stamps[var] == i)
+					continue;
+				stamps[var] = i;
+				arena->lits[size++] = lit;
+			}
+			arena->num_duplicate_lits += length - num_codes;
+			size -= num_codes;
+		}
+		else if (size != begin)
+			memmove(arena->lits + size, arena->lits + begin, length * sizeof(c2dLiteral));
+
+		// Small codes barely reach the high bits of the hash, which are mixed (as in MurmurHash3) to bucket on them
+		unsigned long hash = hash_words(0, codes, num_codes);
+		hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdUL;
+		arena->starts[++num_kept] = size;
+		size += num_codes;
+		hashes[num_kept - 1].hash = hash ^ (hash >> 33);
+		hashes[num_kept - 1].clause = num_kept;
+	}
+	arena->starts[num_kept + 1] = size;
+
+	// A clause is a duplicate if an earlier one in its bucket has the same hash and the same codes
+	BOOLEAN* duplicates = (BOOLEAN*)calloc(num_kept + 2, sizeof(BOOLEAN));
+	int bucket_bits = 0;
+	while (bucket_bits < maxBucketBits && (num_kept >> bucket_bits) > hashBucketSize)
+		bucket_bits++;
+	c2dSize* bucket_starts = bucket_clause_hashes(hashes, num_kept, bucket_bits);
+	c2dSize largest = 0;
+	for (c2dSize b = 0; b < ((c2dSize)1 << bucket_bits); b++)
+		if (bucket_starts[b + 1] - bucket_starts[b] > largest)
+			largest = bucket_starts[b + 1] - bucket_starts[b];
+
+	// The table of a bucket holds positions in the bucket plus 1 (0 for none), and is at most half full
+	int table_bits = 1;
+	while (((c2dSize)1 << table_bits) < 2 * largest)
+		table_bits++;
+	c2dSize* table = (c2dSize*)malloc(((c2dSize)1 << table_bits) * sizeof(c2dSize));
+	for (c2dSize b = 0; b < ((c2dSize)1 << bucket_bits); b++) {
+		ClauseHash* bucket = hashes + bucket_starts[b];
+		c2dSize bucket_size = bucket_starts[b + 1] - bucket_starts[b];
+		int bits = 1;
+		while (((c2dSize)1 << bits) < 2 * bucket_size)
+			bits++;
+		c2dSize mask = ((c2dSize)1 << bits) - 1;
+		memset(table, 0, (mask + 1) * sizeof(c2dSize));
+
+		for (c2dSize i = 0; i < bucket_size; i++) {
+			c2dSize clause = bucket[i].clause;
+			c2dSize slot = (c2dSize)bucket[i].hash & mask;
+			for (; table[slot] != 0 && !duplicates[clause]; slot = (slot + 1) & mask) {
+				c2dSize other = bucket[table[slot] - 1].clause;
+				if (bucket[table[slot] - 1].hash == bucket[i].hash)
+					duplicates[clause] = same_clause_codes(arena, clause, other, codes, codes + longest);
+			}
+			if (!duplicates[clause])
+				table[slot] = i + 1;
+		}
+	}
+	free(table);
+	free(bucket_starts);
+
+	// The clauses left move towards the front again
+	c2dSize num_unique = 0;
+	size = 0;
+	for (c2dSize i = 1; i <= num_kept; i++) {
+		c2dSize begin = arena->starts[i];
+		c2dSize end = arena->starts[i + 1];
+		if (duplicates[i]) {
+			arena->num_duplicate_clauses++;
+			continue;
+		}
+		arena->starts[++num_unique] = size;
+		if (size != begin && arena->lits_borrowed)
+			own_clause_literals(arena, arena->starts[num_kept + 1]);
+		if (size != begin)
+			memmove(arena->lits + size, arena->lits + begin, (end - begin) * sizeof(c2dLiteral));
+		size += end - begin;
+	}
+	arena->num_clauses = num_unique;
+	arena->starts[num_unique + 1] = size;
 
-	for (c2dLiteral i = 1; i <= num_vars; i++) {
-		// Create variable and literal structs
-		Var* var = (Var*)malloc(sizeof(Var));
-		Lit* litp = (Lit*)malloc(sizeof(Lit));
-		Lit* litn = (Lit*)malloc(sizeof(Lit));
+	free(duplicates);
+	free(codes);
+	free(hashes);
+	free(stamps);
+}
 
-		// Initialize Variable
-		var->index = i;
-		var->instantiated = 0;
-		var->decision_level = -1;
-		var->pos_lit = litp;
-		var->neg_lit = litn;
-		var->num_mentioned = 0;
-		satState->vars[i] = var; // add to satState
+//Copy the literals an arena borrowed (see sat_builder_borrow_clauses()) into memory of its own, so they can be changed
+//@param arena: the arena
+//@param num_lits: the number of literals of its clauses
+void own_clause_literals(ClauseArena* arena, c2dSize num_lits) {
+	c2dLiteral* lits = (c2dLiteral*)sat_region_alloc((num_lits + 16) * sizeof(c2dLiteral), clauseRegion);
+	memcpy(lits, arena->lits, num_lits * sizeof(c2dLiteral));
+	arena->lits = lits;
+	arena->lits_capacity = num_lits + 16;
+	arena->lits_borrowed = 0;
+}
 
-		// Initialize positive literal
-		litp->index = i;
-		litp->var = var;
-		litp->truth_value = -1;
-		litp->clauses = (clauseList*) malloc(sizeof(clauseList));
-		litp->clauses->head = NULL;
-		litp->learnedClauses = (clauseList*) malloc(sizeof(clauseList));
-		litp->learnedClauses->head = NULL;
-		litp->unit_children = (litList*) malloc(sizeof(litList));
-		litp->unit_children->head = NULL;
-		satState->lits[i] = litp; // add to satState
+//returns the code of a literal: twice its variable, plus 1 if it is negative
+//Sorted codes put a literal next to its repetitions, then next to its opposite
+c2dLiteral literal_code(c2dLiteral lit) {
+	return lit > 0 ? 2 * lit : -2 * lit + 1;
+}
 
-		// Initialize negative literal
-		litn->index = i * -1;
-		litn->var = var;
-		litn->truth_value = -1;
-		litn->clauses = (clauseList*) malloc(sizeof(clauseList));
-		litn->clauses->head = NULL;
-		litn->learnedClauses = (clauseList*) malloc(sizeof(clauseList));
-		litn->learnedClauses->head = NULL;
-		litn->unit_children = (litList*) malloc(sizeof(litList));
-		litn->unit_children->head = NULL;
-		satState->lits[i * -1] = litn; // add to satState
+//Put the hashes of clauses in buckets by their highest bits, keeping the order of the clauses in each bucket
+//@param hashes: the hashes
+//@param num_hashes: the number of hashes
+//@param bucket_bits: the number of highest bits telling the bucket of a hash
+//@return the position in hashes of the first hash of each bucket (the entry after the last bucket is num_hashes)
+c2dSize* bucket_clause_hashes(ClauseHash* hashes, c2dSize num_hashes, int bucket_bits) {
+	c2dSize num_buckets = (c2dSize)1 << bucket_bits;
+	c2dSize* starts = (c2dSize*)calloc(num_buckets + 1, sizeof(c2dSize));
+	if (bucket_bits == 0) {
+		starts[1] = num_hashes;
+		return starts;
 	}
 
+	for (c2dSize i = 0; i < num_hashes; i++)
+		starts[(hashes[i].hash >> (64 - bucket_bits)) + 1]++;
+	for (c2dSize b = 1; b <= num_buckets; b++)
+		starts[b] += starts[b - 1];
+	ClauseHash* bucketed = (ClauseHash*)malloc((num_hashes + 1) * sizeof(ClauseHash));
+	c2dSize* positions = (c2dSize*)malloc(num_buckets * sizeof(c2dSize));
+	memcpy(positions, starts, num_buckets * sizeof(c2dSize));
+	for (c2dSize i = 0; i < num_hashes; i++)
+		bucketed[positions[hashes[i].hash >> (64 - bucket_bits)]++] = hashes[i];
+	memcpy(hashes, bucketed, num_hashes * sizeof(ClauseHash));
+	free(positions);
+	free(bucketed);
+	return starts;
+}
 
-	/*************************************************************/
-	/************************SETUP CLAUSES************************/
-	/*************************************************************/
+//returns 1 if two clauses of an arena, without repeated literals, have the same literals, 0 otherwise
+//@param arena: the arena
+//@param clause: the index of a clause
+//@param other: the index of the other clause
+//@param codes: room for the codes of a clause
+//@param other_codes: room for the codes of the other clause
+BOOLEAN same_clause_codes(const ClauseArena* arena, c2dSize clause, c2dSize other, c2dLiteral* codes, c2dLiteral* other_codes) {
+	c2dSize length = arena->starts[clause + 1] - arena->starts[clause];
+	if (arena->starts[other + 1] - arena->starts[other] != length)
+		return 0;
+	for (c2dSize k = 0; k < length; k++) {
+		codes[k] = literal_code(arena->lits[arena->starts[clause] + k]);
+		other_codes[k] = literal_code(arena->lits[arena->starts[other] + k]);
+	}
+	sort_clause_literals(codes, length);
+	sort_clause_literals(other_codes, length);
+	return memcmp(codes, other_codes, length * sizeof(c2dLiteral)) == 0;
+}
 
-	// Malloc space for clauses
-	Clause* clauses = (Clause*)malloc((num_clauses + 1) * sizeof(Clause)); // 1 indexed array
+//Compare two literals by index (for qsort)
+static int compare_literals(const void* a, const void* b) {
+	c2dLiteral first = *(const c2dLiteral*)a;
+	c2dLiteral second = *(const c2dLiteral*)b;
+	return first < second ? -1 : first > second;
+}
 
-	// Setup each clause (index starting at 1)
-	for (c2dSize i = 1; i <= num_clauses; i++) {
-		// Read in line if it is not a comment
-		do {
-			if (fgets(line, maxLength, file) == NULL) {
-				fprintf(stderr, "Read error, or EOF reached before all %ld CNF's read.\n", num_clauses);
-				exit(1);
-			}
-		} while (line[0] == 'c' || line[0] == '%' || line[0] == '0');
-		// line now contains our clause string
-		// Count number of literals in clause, so we can allocate the array to the appropriate size
-		int num_lits = 0, j = 0;
-		char* temp = line;
-		while (temp[j] != '\0') {
-			if (temp[j] == ' ') { // If we reach a space, increment num_lits
-				num_lits++;
-				while (temp[j + 1] == ' ') // go through all consecutive spaces, 
-					j++;
-			}
-			j++;
-		}
+//Sort the literals of a clause (or their codes) by increasing index
+//@param lits: the literals
+//@param num_lits: the number of literals
+void sort_clause_literals(c2dLiteral* lits, c2dSize num_lits) {
+	// Most clauses are short enough for an insertion sort
+	if (num_lits > 16) {
+		qsort(lits, num_lits, sizeof(c2dLiteral), compare_literals);
+		return;
+	}
+	for (c2dSize i = 1; i < num_lits; i++) {
+		c2dLiteral lit = lits[i];
+		c2dSize j = i;
+		for (; j > 0 && lits[j - 1] > lit; j--)
+			lits[j] = lits[j - 1];
+		lits[j] = lit;
+	}
+}
 
-		// Create literal array for this clause, of size num_lits
-		clauses[i].literals = (Lit**)malloc(num_lits * sizeof(Lit *));
+//Build the index of the clauses containing each literal, listed in increasing order for each literal
+//Each thread counts, then places, the occurrences in its own slice of the clauses; a slice only
+//gets a thread if it has enough literals, and the counts of all slices must not outgrow the literals
+//@param num_vars: the number of variables
+//@param num_clauses: the number of clauses
+//@param starts: the position in lits of the first literal of each clause (1 indexed, starts[num_clauses + 1] is the end)
+//@param lits: the literals of all the clauses
+//@param occurs_starts: filled with the position in occurs of the first clause of each literal (indices -n to n+1)
+//@param occurs: filled with the clauses containing each literal (starts[num_clauses + 1] entries)
+//@param num_threads: the most threads to use
+void build_clause_occurrences(c2dSize num_vars, c2dSize num_clauses, const c2dSize* starts, const c2dLiteral* lits, c2dSize* occurs_starts, c2dSize* occurs, int num_threads) {
+	OccurrenceBuilder builder;
+	c2dSize num_lits = starts[num_clauses + 1] - starts[1];
+	c2dSize num_entries = 2 * num_vars + 2;
+	builder.num_vars = num_vars;
+	builder.starts = starts;
+	builder.lits = lits;
+	builder.occurs = occurs;
+	builder.num_slices = num_lits / occurrenceSliceSize;
+	if (builder.num_slices > num_lits / num_entries)
+		builder.num_slices = num_lits / num_entries;
+	if (builder.num_slices > (c2dSize)num_threads)
+		builder.num_slices = num_threads;
+	if (builder.num_slices == 0)
+		builder.num_slices = 1;
+	builder.next = 0;
+
+	//Cut the clauses into slices of about as many literals
+	builder.slice_starts = (c2dSize*)malloc((builder.num_slices + 1) * sizeof(c2dSize));
+	builder.slice_starts[0] = 1;
+	c2dSize clause = 1;
+	for (c2dSize i = 1; i < builder.num_slices; i++) {
+		while (clause <= num_clauses && starts[clause] - starts[1] < i * (num_lits / builder.num_slices))
+			clause++;
+		builder.slice_starts[i] = clause;
+	}
+	builder.slice_starts[builder.num_slices] = num_clauses + 1;
+
+	builder.counts = (c2dSize*)calloc(builder.num_slices * num_entries, sizeof(c2dSize));
+	run_threads(count_occurrences, &builder, (int)builder.num_slices);
+
+	//Each slice places the occurrences of a literal after those of the slices before it
+	c2dSize position = 0;
+	for (c2dSize l = 0; l < num_entries - 1; l++) {
+		occurs_starts[(c2dLiteral)l - (c2dLiteral)num_vars] = position;
+		for (c2dSize i = 0; i < builder.num_slices; i++) {
+			c2dSize count = builder.counts[i * num_entries + l];
+			builder.counts[i * num_entries + l] = position;
+			position += count;
+		}
+	}
+	occurs_starts[num_vars + 1] = position;
 
-		// Add first literal to clause
-		char* lit_string = strtok(line, " \n"); // Get literal from line
-		c2dLiteral lit_index = strtol(lit_string, NULL, 10);	// convert from string to signed long
-		clauses[i].literals[0] = satState->lits[lit_index];
-		
-		// Add clause to the literal's clause list.
-		clauseList_push(clauses[i].literals[0]->clauses, &(clauses[i]));
-		
-		// Increment num_occurences for corresponding variable
-		satState->lits[lit_index]->var->num_mentioned++;
-		
-		// Add rest of literals to clause
-		for (int j = 1; j < num_lits; j++) {
-			lit_string = strtok(NULL, " \n"); // Get literal from line
-			lit_index = strtol(lit_string, NULL, 10); // convert from string to signed long
-			clauses[i].literals[j] = satState->lits[lit_index];
+	builder.next = 0;
+	run_threads(place_occurrences, &builder, (int)builder.num_slices);
+	free(builder.slice_starts);
+	free(builder.counts);
+}
 
-			// Add clause to the literal's clause list.
-			clauseList_push(clauses[i].literals[j]->clauses, &(clauses[i]));
-			
-			// Increment num_occurences for corresponding variable
-			satState->lits[lit_index]->var->num_mentioned++;
-		}
+//Count the occurrences of each literal in the slices of an OccurrenceBuilder, one slice at a time
+//@param data: the OccurrenceBuilder
+//@return NULL
+void* count_occurrences(void* data) {
+	OccurrenceBuilder* builder = (OccurrenceBuilder*)data;
+	c2dSize slice;
+	while ((slice = __atomic_fetch_add(&builder->next, 1, __ATOMIC_RELAXED)) < builder->num_slices) {
+		c2dSize* counts = builder->counts + slice * (2 * builder->num_vars + 2) + builder->num_vars;
+		for (c2dSize i = builder->starts[builder->slice_starts[slice]]; i < builder->starts[builder->slice_starts[slice + 1]]; i++)
+			counts[builder->lits[i]]++;
+	}
+	return NULL;
+}
 
-		// Set the other values for this Clause struct
-		clauses[i].subsumed = 0;
-		clauses[i].free_lits = num_lits;
-		clauses[i].subsumed_on = NULL;
-		clauses[i].index = i;
-		clauses[i].num_lits = num_lits;
-		clauses[i].dec_level = -1;
+//Place the clauses of the slices of an OccurrenceBuilder under their literals, one slice at a time
+//@param data: the OccurrenceBuilder, whose counts hold where each slice places its next occurrence of each literal
+//@return NULL
+void* place_occurrences(void* data) {
+	OccurrenceBuilder* builder = (OccurrenceBuilder*)data;
+	c2dSize slice;
+	while ((slice = __atomic_fetch_add(&builder->next, 1, __ATOMIC_RELAXED)) < builder->num_slices) {
+		c2dSize* positions = builder->counts + slice * (2 * builder->num_vars + 2) + builder->num_vars;
+		for (c2dSize c = builder->slice_starts[slice]; c < builder->slice_starts[slice + 1]; c++)
+			for (c2dSize i = builder->starts[c]; i < builder->starts[c + 1]; i++)
+				builder->occurs[positions[builder->lits[i]]++] = c;
 	}
+	return NULL;
+}
 
-	satState->CNF = clauses;
+//Run a function in num_threads threads (the calling one included) over the same data, and wait for them
+//@param function: the function, which shares the work with the other threads through data
+//@param data: the data given to every thread
+//@param num_threads: the number of threads
+void run_threads(void* (*function)(void*), void* data, int num_threads) {
+	pthread_t threads[maxParseChunks];
+	if (num_threads > maxParseChunks)
+		num_threads = maxParseChunks;
+	for (int i = 1; i < num_threads; i++)
+		pthread_create(&threads[i], NULL, function, data);
+	function(data);
+	for (int i = 1; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+}
 
-	/******DEBUG / TEST SETUP CODE *************
-	SatState* s = satState;
-	printf("num_lits=%ld num_vars=%lu num_clauses=%lu\n", s->num_lits, s->num_vars, s->num_clauses);
-	for(int i = 1; i <= s->num_vars; i++) {
-		Var* var = s->vars[i];
-		printf("var %lu instantiated %d\n", var->index, var->instantiated);
-		printf("negLit %ld posLit %ld \n\n", var->neg_lit->index, var->pos_lit->index);
-	}
-	// printouts below should match intput CNF format
-	for(int i = 1; i <= s->num_clauses; i++) {
-		Clause clause = s->CNF[i];
-		for(int j = 0; j < clause.num_lits-1; j++) {
-			printf("%ld ", clause.literals[j]->index);
-		}
-		printf("%ld 0\n", clause.literals[clause.num_lits-1]->index);
+//returns the number of threads to work with (the number of processors online)
+int num_worker_threads() {
+	long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_processors < 1)
+		return 1;
+	return num_processors < maxParseChunks ? (int)num_processors : maxParseChunks;
+}
+
+//Point an arena into a snapshot mapped in memory, after checking its size and checksum
+//@param arena: the arena, without arrays
+//@param mapping: the snapshot, which the arena then owns
+//@param length: the number of bytes of the snapshot
+//@param file_name: the name of the snapshot file (for errors)
+//@param error: set to the reason the snapshot was not loaded
+//@param error_size: the number of characters error has room for
+//@return 1 if the snapshot was loaded, 0 if it is bad (the arena is then left alone, and does not own mapping)
+BOOLEAN load_snapshot(ClauseArena* arena, void* mapping, size_t length, const char* file_name, char* error, size_t error_size) {
+	const SnapshotHeader* header = (const SnapshotHeader*)mapping;
+	c2dSize* words = (c2dSize*)((char*)mapping + sizeof(SnapshotHeader));
+	c2dSize num_words = (header->num_clauses + 2) + header->num_lits + (2 * header->num_vars + 2) + header->num_lits;
+
+	if (header->version != snapshotVersion || length != sizeof(SnapshotHeader) + num_words * sizeof(c2dSize)) {
+		snprintf(error, error_size, "Bad snapshot file %s", file_name);
+		return 0;
 	}
-	// print literals and list of clauses belonging to them
-	for(int i = 1; i <= s->num_vars; i++) {
-		Lit* lit = s->lits[i];
-		printf("lit %ld clauses ", lit->index);
-		clauseNode* claws = lit->clauses->head;
-		while(claws != NULL) {
-			printf("%lu ", claws->node_clause->index);
-			claws = claws->next;
-		}
-		printf("\n");
+	if (hash_words(0, words, num_words) != header->checksum) {
+		snprintf(error, error_size, "Corrupt snapshot file %s", file_name);
+		return 0;
 	}
 
-	for(int i = -1; i >= -1*(s->num_vars); i--) {
-		Lit* lit = s->lits[i];
-		printf("lit %ld clauses ", lit->index);
-		clauseNode* claws = lit->clauses->head;
-		while(claws != NULL) {
-			printf("%lu ", claws->node_clause->index);
-			claws = claws->next;
-		}
-		printf("\n");
-	}
-	*************************************/
-	return satState;
+	arena->num_vars = header->num_vars;
+	arena->num_clauses = header->num_clauses;
+	arena->starts = words;
+	arena->lits = (c2dLiteral*)(words + header->num_clauses + 2);
+	arena->occurs_starts = words + header->num_clauses + 2 + header->num_lits + header->num_vars;
+	arena->occurs = words + header->num_clauses + 2 + header->num_lits + 2 * header->num_vars + 2;
+	arena->starts_capacity = 0;
+	arena->lits_capacity = 0;
+	arena->lits_borrowed = 0;
+	arena->mapping = mapping;
+	arena->mapping_length = length;
+	arena->num_duplicate_lits = 0;
+	arena->num_tautologies = 0;
+	arena->num_duplicate_clauses = 0;
+	arena->refs = 0;
+	return 1;
 }
 
-//frees the SatState
-void sat_state_free(SatState* sat_state) {
-	//TODO: Free dlitList in each Decision of our decList
+//Read a cnf from a stream (stdin or a pipe from a decompressor), parsing each chunk while a
+//reader thread reads the next ones
+//@param stream: the stream
+//@param parser: the CnfParser the chunks are given to
+void read_cnf_stream(FILE* stream, CnfParser* parser) {
+	CnfReader reader;
+	reader.stream = stream;
+	for (int i = 0; i < numReadChunks; i++)
+		reader.chunks[i] = (char*)malloc(readChunkSize);
+	reader.num_read = 0;
+	reader.num_parsed = 0;
+	reader.done = 0;
+	reader.stop = 0;
+	pthread_mutex_init(&reader.lock, NULL);
+	pthread_cond_init(&reader.cond, NULL);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, read_cnf_chunks, &reader);
+
+	pthread_mutex_lock(&reader.lock);
+	while (1) {
+		while (reader.num_parsed == reader.num_read && !reader.done)
+			pthread_cond_wait(&reader.cond, &reader.lock);
+		if (reader.num_parsed == reader.num_read)
+			break;
 
-	// // Free each Var and Lit struct
-	for (c2dLiteral i = 1; i <= sat_state->num_vars; i++) {
-		// Positive literal
-		// Free clause list
-		clauseList* list = sat_state->lits[i]->clauses;
-		while(clauseList_pop(list) != NULL);
-		free(list);
-		
-		// Free learned clause list
-		clauseList* listLearned = sat_state->lits[i]->learnedClauses;
-		while(clauseList_pop(listLearned) != NULL);
-		free(listLearned);
-		
-		// Negative literal
-		// Free clause list
-		list = sat_state->lits[i*-1]->clauses;
-		while(clauseList_pop(list) != NULL);
-		free(list);
-		
-		// Free learned clause list
-		listLearned = sat_state->lits[i*-1]->learnedClauses;
-		while(clauseList_pop(listLearned) != NULL);
-		free(listLearned);
-		
-		// Free Var and Lit structs
-		free(sat_state->vars[i]);
-		free(sat_state->lits[i]);
-		free(sat_state->lits[-1 * i]);
-	}
+		//The reader does not touch a chunk until it is parsed
+		char* chunk = reader.chunks[reader.num_parsed % numReadChunks];
+		size_t size = reader.sizes[reader.num_parsed % numReadChunks];
+		pthread_mutex_unlock(&reader.lock);
+		parse_cnf_chunk(parser, chunk, chunk + size);
+		pthread_mutex_lock(&reader.lock);
 
-	// Free list of Var/Lit pointers in sat_state
-	free(sat_state->vars);
-	free(sat_state->lits - sat_state->num_vars);
+		reader.num_parsed++;
+		pthread_cond_broadcast(&reader.cond);
 
-	// Free list of Lit pointers in each clause
-	for (c2dSize i = 1; i <= sat_state->num_clauses; i++) {
-		free(sat_state->CNF[i].literals);
+		//The rest of the stream is not needed
+		if (parser->mode == parseDone) {
+			reader.stop = 1;
+			break;
+		}
 	}
-	
-	// Free list of Clause pointers in sat_state
-	free(sat_state->CNF);
-	
-	// Free learned clause list in satState
-	clauseList* listLearned = sat_state->learnedClauses;
-	while(clauseList_pop(listLearned) != NULL);
-	free(listLearned);
-	
-	// Free decisions list in satState
-	decList* decisionList = sat_state->decisions;
-	while(decList_pop(decisionList) != NULL);
-	free(decisionList);
+	pthread_mutex_unlock(&reader.lock);
+	pthread_join(thread, NULL);
 
-	// Free sat_state struct itself
-	free(sat_state);
+	pthread_mutex_destroy(&reader.lock);
+	pthread_cond_destroy(&reader.cond);
+	for (int i = 0; i < numReadChunks; i++)
+		free(reader.chunks[i]);
+}
+
+//Read the chunks of a stream until its end, or until the parser needs no more of them
+//@param data: the CnfReader
+//@return NULL
+void* read_cnf_chunks(void* data) {
+	CnfReader* reader = (CnfReader*)data;
+
+	pthread_mutex_lock(&reader->lock);
+	while (!reader->done) {
+		while (reader->num_read - reader->num_parsed == numReadChunks && !reader->stop)
+			pthread_cond_wait(&reader->cond, &reader->lock);
+		if (reader->stop)
+			break;
+
+		c2dSize slot = reader->num_read % numReadChunks;
+		pthread_mutex_unlock(&reader->lock);
+		size_t size = fread(reader->chunks[slot], 1, readChunkSize, reader->stream);
+		pthread_mutex_lock(&reader->lock);
+
+		if (size > 0) {
+			reader->sizes[slot] = size;
+			reader->num_read++;
+		}
+		if (size < readChunkSize)
+			reader->done = 1;
+		pthread_cond_broadcast(&reader->cond);
+	}
+	reader->done = 1;
+	pthread_cond_broadcast(&reader->cond);
+	pthread_mutex_unlock(&reader->lock);
+	return NULL;
+}
+
+//Compressed files are piped through these commands, by file name suffix (suffix, compressing, decompressing)
+static const char* compressors[][3] = {
+	{ ".gz", "gzip -c", "gzip -dc" },
+	{ ".xz", "xz -c", "xz -dc" },
+	{ ".bz2", "bzip2 -c", "bzip2 -dc" },
+};
+
+//Open a file, through the compressor matching the suffix of its name if it has one
+//@param file_name: the name of the file
+//@param write: 1 to write the file (compressing it), 0 to read it (decompressing it)
+//@param piped: set to 1 if the file is a pipe to a compressor (to close with pclose()), 0 otherwise
+//@return the file, NULL if it could not be opened
+FILE* open_compressed(const char* file_name, BOOLEAN write, BOOLEAN* piped) {
+	size_t length = strlen(file_name);
+	*piped = 0;
+	for (size_t i = 0; i < sizeof(compressors) / sizeof(compressors[0]); i++)
+	{
+		size_t suffix = strlen(compressors[i][0]);
+		if (length <= suffix || strcmp(file_name + length - suffix, compressors[i][0]) != 0)
+			continue;
+
+		//The name is quoted for the shell running the compressor, which cannot report a missing file
+		*piped = 1;
+		if (strchr(file_name, '\'') != NULL || (!write && access(file_name, R_OK) != 0))
+			return NULL;
+		const char* command = compressors[i][write ? 1 : 2];
+		char* line = (char*)malloc(length + strlen(command) + 8);
+		sprintf(line, write ? "%s > '%s'" : "%s < '%s'", command, file_name);
+		FILE* file = popen(line, write ? "w" : "r");
+		free(line);
+		return file;
+	}
+	return fopen(file_name, write ? "wb" : "rb");
+}
+
+//Start reading a cnf into an arena no sat state shares, reusing its memory
+//@param parser: the CnfParser
+//@param arena: the arena, whose clauses are replaced
+//@param file_name: the name of the cnf (for errors)
+void init_cnf_parser(CnfParser* parser, ClauseArena* arena, const char* file_name) {
+	parser->arena = arena;
+	parser->file_name = file_name;
+	parser->mode = parseSpace;
+	parser->header_read = 0;
+	parser->negative = 0;
+	parser->value = 0;
+	parser->num_read = 0;
+	parser->size = 0;
+	parser->clause_start = 0;
+	parser->header_length = 0;
+	parser->error[0] = '\0';
+
+	arena->num_vars = 0;
+	arena->num_clauses = 0;
+	arena->num_duplicate_lits = 0;
+	arena->num_tautologies = 0;
+	arena->num_duplicate_clauses = 0;
+	arena->refs = 0;
+}
+
+//Read a chunk of the text of a cnf (the chunks are given in order)
+//Lines can have any length, and a clause can span several lines (it ends with a 0)
+//Lines starting with c are comments, and a line starting with % ends the clauses (as in SATLIB)
+//@param parser: the CnfParser
+//@param begin: the first character of the chunk
+//@param end: the character after the last one of the chunk
+void parse_cnf_chunk(CnfParser* parser, const char* begin, const char* end) {
+	const char* p = begin;
+	while (p < end)
+	{
+		switch (parser->mode)
+		{
+		case parseSpace:
+			while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+				p++;
+			if (p == end)
+				break;
+			if (*p >= '0' && *p <= '9') {
+				parser->negative = 0;
+				parser->value = 0;
+				parser->mode = parseNumber;
+			}
+			else if (*p == '-') {
+				parser->negative = 1;
+				parser->value = 0;
+				parser->mode = parseNumber;
+				p++;
+			}
+			else if (*p == 'c')
+				parser->mode = parseComment;
+			else if (*p == 'p' && !parser->header_read) {
+				parser->header_length = 0;
+				parser->mode = parseHeader;
+			}
+			else if (*p == '%')
+				parser->mode = parseDone;
+			else {
+				snprintf(parser->error, maxLength, "Unexpected character '%c' in %s", *p, parser->file_name);
+				parser->mode = parseDone;
+			}
+			break;
+
+		case parseNumber:
+			while (p < end && *p >= '0' && *p <= '9')
+				parser->value = 10 * parser->value + (*p++ - '0');
+			// The number may go on in the next chunk
+			if (p < end)
+				parse_cnf_number(parser);
+			break;
+
+		case parseComment:
+			p = (const char*)memchr(p, '\n', end - p);
+			if (p == NULL)
+				p = end;
+			else
+				parser->mode = parseSpace;
+			break;
+
+		case parseHeader:
+			while (p < end && *p != '\n') {
+				if (parser->header_length < maxLength - 1)
+					parser->header[parser->header_length++] = *p;
+				p++;
+			}
+			if (p < end)
+				parse_cnf_header(parser);
+			break;
+
+		case parseDone:
+			return;
+		}
+	}
+}
+
+//End a number, which is a literal of the clause being read or the 0 ending it
+//@param parser: the CnfParser, which just read the last digit of the number
+void parse_cnf_number(CnfParser* parser) {
+	ClauseArena* arena = parser->arena;
+	parser->mode = parseSpace;
+	if (!parser->header_read) {
+		snprintf(parser->error, maxLength, "Clause before the problem line in %s", parser->file_name);
+		parser->mode = parseDone;
+		return;
+	}
+
+	if (parser->value == 0) {
+		// Empty clauses are skipped
+		if (parser->size == parser->clause_start)
+			return;
+		arena->starts[++parser->num_read] = parser->clause_start;
+		parser->clause_start = parser->size;
+		if (parser->num_read == arena->num_clauses)
+			parser->mode = parseDone;
+		return;
+	}
+
+	if (parser->value > arena->num_vars) {
+		snprintf(parser->error, maxLength, "Literal %s%lu of %s is not over one of its %lu variables", parser->negative ? "-" : "", parser->value, parser->file_name, arena->num_vars);
+		parser->mode = parseDone;
+		return;
+	}
+	if (parser->size == arena->lits_capacity) {
+		arena->lits_capacity = 2 * arena->lits_capacity + 16;
+		arena->lits = (c2dLiteral*)sat_region_realloc(arena->lits, arena->lits_capacity * sizeof(c2dLiteral), clauseRegion);
+	}
+	arena->lits[parser->size++] = parser->negative ? -(c2dLiteral)parser->value : (c2dLiteral)parser->value;
+}
+
+//Read the problem line, and make room in the arena for the clauses it announces
+//@param parser: the CnfParser, which read the whole problem line
+void parse_cnf_header(CnfParser* parser) {
+	ClauseArena* arena = parser->arena;
+	parser->header[parser->header_length] = '\0';
+	parser->mode = parseSpace;
+	parser->header_read = 1;
+
+	c2dSize num_vars = 0, num_clauses = 0;
+	// %lu would take a negative count as a huge one
+	if (sscanf(parser->header, "p cnf %lu %lu", &num_vars, &num_clauses) != 2 || strchr(parser->header, '-') != NULL) {
+		snprintf(parser->error, maxLength, "Bad problem line in %s: %.400s", parser->file_name, parser->header);
+		parser->mode = parseDone;
+		return;
+	}
+	arena->num_vars = num_vars;
+	arena->num_clauses = num_clauses;
+
+	if (num_clauses + 2 > arena->starts_capacity) {
+		arena->starts_capacity = num_clauses + 2;
+		arena->starts = (c2dSize*)sat_region_realloc(arena->starts, arena->starts_capacity * sizeof(c2dSize), clauseRegion);
+	}
+	// The literals array grows as clauses are read
+	if (arena->lits_capacity < 3 * num_clauses + 1) {
+		arena->lits_capacity = 3 * num_clauses + 1;
+		arena->lits = (c2dLiteral*)sat_region_realloc(arena->lits, arena->lits_capacity * sizeof(c2dLiteral), clauseRegion);
+	}
+	if (num_clauses == 0)
+		parser->mode = parseDone;
+}
+
+//End reading a cnf once its whole text was given to the parser (without an error)
+//The last clause may lack its 0
+//@param parser: the CnfParser, whose error is set if the cnf is not whole
+void finish_cnf_parser(CnfParser* parser) {
+	ClauseArena* arena = parser->arena;
+	if (parser->mode == parseHeader)
+		parse_cnf_header(parser);
+	if (parser->mode == parseNumber)
+		parse_cnf_number(parser);
+	if (parser->mode != parseDone && parser->header_read && parser->size > parser->clause_start) {
+		parser->value = 0;
+		parse_cnf_number(parser);
+	}
+
+	if (parser->error[0] != '\0')
+		return;
+	if (!parser->header_read) {
+		snprintf(parser->error, maxLength, "No problem line in %s", parser->file_name);
+		return;
+	}
+	if (parser->num_read < arena->num_clauses) {
+		snprintf(parser->error, maxLength, "Read error, or EOF reached before all %ld CNF's read.", arena->num_clauses);
+		return;
+	}
+	arena->starts[arena->num_clauses + 1] = parser->size;
+}
+
+//Parse a mapped cnf after its problem line in chunks cut at line boundaries, each read by a thread into
+//its own buffers, and merge them in order: the clauses are numbered as in the file, and the errors are
+//those a single pass would meet first
+//@param parser: the CnfParser, which read the problem line (and nothing after it)
+//@param begin: the first character after the problem line
+//@param end: the character after the last one of the cnf
+//@param num_chunks: the number of chunks to cut the text into
+void parse_cnf_chunks(CnfParser* parser, const char* begin, const char* end, c2dSize num_chunks) {
+	ClauseArena* arena = parser->arena;
+	if (parser->mode == parseDone)
+		return;
+	if (num_chunks > maxParseChunks)
+		num_chunks = maxParseChunks;
+	if (num_chunks == 0)
+		num_chunks = 1;
+
+	CnfChunks work;
+	work.chunks = (CnfChunk*)malloc(num_chunks * sizeof(CnfChunk));
+	work.num_chunks = num_chunks;
+	work.arena = arena;
+	work.next = 0;
+	const char* chunk_begin = begin;
+	for (c2dSize i = 0; i < num_chunks; i++) {
+		CnfChunk* chunk = &work.chunks[i];
+		const char* chunk_end = i + 1 == num_chunks ? end : begin + (end - begin) / num_chunks * (i + 1);
+		if (chunk_end < chunk_begin)
+			chunk_end = chunk_begin;
+		else if (chunk_end < end) {
+			chunk_end = (const char*)memchr(chunk_end, '\n', end - chunk_end);
+			chunk_end = chunk_end == NULL ? end : chunk_end + 1;
+		}
+		chunk->begin = chunk_begin;
+		chunk->end = chunk_end;
+		chunk->file_name = parser->file_name;
+		chunk->num_vars = arena->num_vars;
+		chunk_begin = chunk_end;
+	}
+	int num_threads = num_worker_threads();
+	run_threads(scan_cnf_chunks, &work, num_threads < (int)num_chunks ? num_threads : (int)num_chunks);
+
+	//The clauses read are numbered in order, skipping empty ones, until the problem line's count is reached
+	c2dSize num_lits = 0;
+	for (c2dSize i = 0; i < num_chunks; i++)
+		num_lits += work.chunks[i].num_lits;
+	if (arena->lits_capacity < num_lits + 1) {
+		arena->lits_capacity = num_lits + 1;
+		arena->lits = (c2dLiteral*)sat_region_realloc(arena->lits, arena->lits_capacity * sizeof(c2dLiteral), clauseRegion);
+	}
+	const char* error = NULL;
+	for (c2dSize i = 0; i < num_chunks; i++) {
+		CnfChunk* chunk = &work.chunks[i];
+		chunk->offset = parser->size;
+		chunk->num_kept = 0;
+		if (parser->mode == parseDone || error != NULL)
+			continue;
+		chunk->num_kept = chunk->num_lits;
+		for (c2dSize j = 0; j < chunk->num_ends; j++) {
+			c2dSize position = chunk->offset + chunk->ends[j];
+			if (position == parser->clause_start)
+				continue;
+			arena->starts[++parser->num_read] = parser->clause_start;
+			parser->clause_start = position;
+			if (parser->num_read == arena->num_clauses) {
+				parser->mode = parseDone;
+				chunk->num_kept = chunk->ends[j];
+				break;
+			}
+		}
+		parser->size += chunk->num_kept;
+		if (parser->mode != parseDone && chunk->error[0] != '\0')
+			error = chunk->error;
+		else if (chunk->done)
+			parser->mode = parseDone;
+	}
+	if (error != NULL) {
+		snprintf(parser->error, maxLength, "%s", error);
+		parser->mode = parseDone;
+	}
+	else {
+		work.next = 0;
+		run_threads(copy_cnf_chunks, &work, num_threads < (int)num_chunks ? num_threads : (int)num_chunks);
+	}
+	for (c2dSize i = 0; i < num_chunks; i++) {
+		free(work.chunks[i].lits);
+		free(work.chunks[i].ends);
+	}
+	free(work.chunks);
+}
+
+//returns the character after the problem line of a mapped cnf, or NULL if comments (and blank lines)
+//are not all that come before it
+//@param text: the first character of the cnf
+//@param end: the character after the last one of the cnf
+const char* find_cnf_body(const char* text, const char* end) {
+	const char* p = text;
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+			p++;
+		if (p == end || (*p != 'c' && *p != 'p'))
+			return NULL;
+		const char* newline = (const char*)memchr(p, '\n', end - p);
+		if (newline == NULL)
+			return NULL;
+		if (*p == 'p')
+			return newline + 1;
+		p = newline + 1;
+	}
+	return NULL;
+}
+
+//Read the chunks of a CnfChunks, one at a time
+//@param data: the CnfChunks
+//@return NULL
+void* scan_cnf_chunks(void* data) {
+	CnfChunks* work = (CnfChunks*)data;
+	c2dSize i;
+	while ((i = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED)) < work->num_chunks)
+		scan_cnf_chunk(&work->chunks[i]);
+	return NULL;
+}
+
+//Read the literals, and the 0s ending clauses, of a chunk (which starts at the beginning of a line)
+//Reading stops at the first error, or at a line starting with %
+//@param chunk: the chunk
+void scan_cnf_chunk(CnfChunk* chunk) {
+	const char* p = chunk->begin;
+	const char* end = chunk->end;
+	chunk->lits_capacity = (end - p) / 4 + 16;
+	chunk->lits = (c2dLiteral*)malloc(chunk->lits_capacity * sizeof(c2dLiteral));
+	chunk->num_lits = 0;
+	chunk->ends_capacity = (end - p) / 16 + 16;
+	chunk->ends = (c2dSize*)malloc(chunk->ends_capacity * sizeof(c2dSize));
+	chunk->num_ends = 0;
+	chunk->done = 0;
+	chunk->error[0] = '\0';
+
+	while (p < end) {
+		char c = *p;
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+			p++;
+		else if ((c >= '0' && c <= '9') || c == '-') {
+			BOOLEAN negative = c == '-';
+			c2dSize value = 0;
+			if (negative)
+				p++;
+			while (p < end && *p >= '0' && *p <= '9')
+				value = 10 * value + (*p++ - '0');
+
+			if (value == 0) {
+				if (chunk->num_ends == chunk->ends_capacity) {
+					chunk->ends_capacity *= 2;
+					chunk->ends = (c2dSize*)realloc(chunk->ends, chunk->ends_capacity * sizeof(c2dSize));
+				}
+				chunk->ends[chunk->num_ends++] = chunk->num_lits;
+				continue;
+			}
+			if (value > chunk->num_vars) {
+				snprintf(chunk->error, maxLength, "Literal %s%lu of %s is not over one of its %lu variables", negative ? "-" : "", value, chunk->file_name, chunk->num_vars);
+				return;
+			}
+			if (chunk->num_lits == chunk->lits_capacity) {
+				chunk->lits_capacity *= 2;
+				chunk->lits = (c2dLiteral*)realloc(chunk->lits, chunk->lits_capacity * sizeof(c2dLiteral));
+			}
+			chunk->lits[chunk->num_lits++] = negative ? -(c2dLiteral)value : (c2dLiteral)value;
+		}
+		else if (c == 'c') {
+			p = (const char*)memchr(p, '\n', end - p);
+			if (p == NULL)
+				p = end;
+		}
+		else if (c == '%') {
+			chunk->done = 1;
+			return;
+		}
+		else {
+			snprintf(chunk->error, maxLength, "Unexpected character '%c' in %s", c, chunk->file_name);
+			return;
+		}
+	}
+}
+
+//Copy the literals kept of the chunks of a CnfChunks into its arena, one chunk at a time
+//@param data: the CnfChunks, merged
+//@return NULL
+void* copy_cnf_chunks(void* data) {
+	CnfChunks* work = (CnfChunks*)data;
+	c2dSize i;
+	while ((i = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED)) < work->num_chunks)
+		memcpy(work->arena->lits + work->chunks[i].offset, work->chunks[i].lits, work->chunks[i].num_kept * sizeof(c2dLiteral));
+	return NULL;
+}
+
+//Stop a sat state from sharing an arena, which is freed once no sat state shares it
+//@param arena: the arena
+void release_clause_arena(ClauseArena* arena) {
+	if (__atomic_sub_fetch(&arena->refs, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+	reset_clause_arena(arena);
+	free(arena);
+}
+
+//Construct a SatState over the clauses of an arena, which it then shares
+//@param arena: the arena
+//@return the SatState
+SatState* sat_state_from_arena(ClauseArena* arena) {
+	SatState* satState = (SatState*)malloc(sizeof(SatState));
+	satState->CNF = NULL;
+	satState->clause_lits = NULL;
+	satState->clause_occurs = NULL;
+	init_sat_state(satState, arena);
+	return satState;
+}
+
+//constructs a SatState from an input cnf file, reusing the memory of a sat state which is no longer needed
+//(the given sat state must not be used afterwards, except through the returned one)
+//exits if the file cannot be read or is not a cnf (see sat_state_try_renew())
+SatState* sat_state_renew(SatState* sat_state, const char* file_name) {
+	char error[maxLength];
+	SatState* renewed = sat_state_try_renew(sat_state, file_name, error, maxLength);
+	if (renewed == NULL) {
+		fprintf(stderr, "%s\n", error);
+		exit(1);
+	}
+	return renewed;
+}
+
+//renews a SatState like sat_state_renew(), but returns NULL if the file cannot be read or is not a cnf,
+//instead of exiting (the given sat state is then freed)
+//@param sat_state: the SatState, which must not be used afterwards (except through the returned one)
+//@param file_name: the cnf file
+//@param error: set to the reason the file could not be read
+//@param error_size: the number of characters error has room for
+//@return the SatState, NULL if the file could not be read
+SatState* sat_state_try_renew(SatState* sat_state, const char* file_name, char* error, size_t error_size) {
+	free_sat_state_contents(sat_state);
+
+	//The arena is refilled in place unless clones still share it
+	ClauseArena* arena = sat_state->arena;
+	if (__atomic_load_n(&arena->refs, __ATOMIC_ACQUIRE) == 1) {
+		if (!fill_clause_arena(arena, file_name, error, error_size)) {
+			free(arena);
+			arena = NULL;
+		}
+	}
+	else {
+		release_clause_arena(arena);
+		arena = read_clause_arena(file_name, error, error_size);
+	}
+
+	if (arena == NULL) {
+		sat_region_free(sat_state->clause_lits);
+		sat_region_free(sat_state->clause_occurs);
+		sat_region_free(sat_state->CNF);
+		free(sat_state);
+		return NULL;
+	}
+	init_sat_state(sat_state, arena);
+	return sat_state;
+}
+
+//Set up a SatState over the clauses of an arena, which it then shares
+//@param satState: the SatState, whose CNF, clause_lits and clause_occurs blocks are reused (if not NULL)
+//@param arena: the arena
+void init_sat_state(SatState* satState, ClauseArena* arena) {
+	// Add basic values to the SatState
+	c2dSize num_vars = arena->num_vars;
+	c2dSize num_clauses = arena->num_clauses;
+	satState->num_vars = num_vars;
+	satState->num_clauses = num_clauses;
+	satState->num_lits = 2 * num_vars;
+	satState->decision_level = 1;
+	satState->num_learned = 0;
+	satState->learnedClauses = (clauseList*) malloc(sizeof(clauseList));
+	satState->learnedClauses->head = NULL;
+	satState->addedClauses = (clauseList*) malloc(sizeof(clauseList));
+	satState->addedClauses->head = NULL;
+	satState->num_added = 0;
+	satState->decisions = (decList*) malloc(sizeof(decList));
+	satState->decisions->head = NULL;
+	satState->assertion_clause = NULL;
+	satState->var_inc = 1;
+	satState->failed = (Lit**)malloc((num_vars + 1) * sizeof(Lit*));
+	satState->num_failed = 0;
+	satState->level_marks = (unsigned long*)calloc(num_vars + 2, sizeof(unsigned long));
+	satState->lbd_stamp = 0;
+	satState->random_state = 0;
+	satState->random_freq = 0;
+	satState->restart_interval = 0;
+	satState->luby_restarts = 0;
+	satState->local_search_flips = 0;
+	satState->local_search_period = 0;
+	satState->local_search = NULL;
+	satState->num_conflicts = 0;
+	satState->num_learned_lits = 0;
+	satState->num_propagations = 0;
+	satState->num_decisions = 0;
+	satState->num_restarts = 0;
+	satState->num_dropped = 0;
+	memset(satState->learned_sizes, 0, sizeof(satState->learned_sizes));
+	memset(satState->learned_lbds, 0, sizeof(satState->learned_lbds));
+	satState->start_time = monotonic_seconds();
+	satState->stop = NULL;
+	satState->on_learned = NULL;
+	satState->on_restart = NULL;
+	satState->hook_data = NULL;
+	satState->proof = NULL;
+	satState->trace = NULL;
+
+	// The nodes of all its lists come from its pools, which are released all at once when it is freed
+	nodePool_init(&satState->list_nodes, sizeof(clauseNode));
+	nodePool_init(&satState->unit_nodes, sizeof(dlitNode));
+	nodePool_init(&satState->decision_nodes, sizeof(Decision) + sizeof(dlitList));
+	blockPool_init(&satState->clause_blocks);
+	litVector_init(&satState->scratch_lits);
+
+	// Decision holding the units implied at the start level (nothing is decided at that level)
+	Decision* root = new_decision(NULL, satState);
+	decList_push(satState->decisions, root, &satState->list_nodes);
+
+	/*************************************************************/
+	/*********************SETUP VARS AND LITS*********************/
+	/*************************************************************/
+
+	satState->vars = (Var**)malloc((num_vars + 1) * sizeof(Var*));
+	satState->lits = (Lit**)malloc(((2 * num_vars) + 1) * sizeof(Lit*));
+	satState->var_cells = (VarCell*)sat_region_alloc((num_vars + 1) * sizeof(VarCell), stateRegion);
+	satState->var_order = NULL;
+	satState->clause_positions = NULL;
+
+
+	// This step sets the start of the literals array in the middle, so we can index in + and - direction
+	satState->lits = satState->lits + num_vars;
+
+	satState->vars[0] = NULL;
+	satState->lits[0] = NULL;
+
+	for (c2dLiteral i = 1; i <= num_vars; i++) {
+		// The variable and its literals lie together, in the order of the indices
+		VarCell* cell = &satState->var_cells[i];
+		Var* var = &cell->var;
+		Lit* litp = &cell->pos_lit;
+		Lit* litn = &cell->neg_lit;
+
+		// Initialize Variable
+		var->index = i;
+		var->instantiated = 0;
+		var->decision_level = -1;
+		var->pos_lit = litp;
+		var->neg_lit = litn;
+		var->num_mentioned = 0;
+		var->seen = 0;
+		var->phase = 0;
+		var->activity = 0;
+		var->model_value = -1;
+		var->projected = 0;
+		var->mark = 0;
+		satState->vars[i] = var; // add to satState
+
+		// Initialize positive literal
+		litp->index = i;
+		litp->var = var;
+		litp->truth_value = -1;
+		litp->learnedClauses = NULL;
+		litp->num_learned = 0;
+		litp->learned_capacity = 0;
+		litp->unit_on = NULL;
+		satState->lits[i] = litp; // add to satState
+
+		// Initialize negative literal
+		litn->index = i * -1;
+		litn->var = var;
+		litn->truth_value = -1;
+		litn->learnedClauses = NULL;
+		litn->num_learned = 0;
+		litn->learned_capacity = 0;
+		litn->unit_on = NULL;
+		satState->lits[i * -1] = litn; // add to satState
+	}
+
+
+	/*************************************************************/
+	/************************SETUP CLAUSES************************/
+	/*************************************************************/
+
+	__atomic_add_fetch(&arena->refs, 1, __ATOMIC_ACQ_REL);
+	satState->arena = arena;
+
+	// Malloc space for clauses, and for the literals of all of them (and the clauses of each literal) at once
+	Clause* clauses = (Clause*)sat_region_realloc(satState->CNF, (num_clauses + 1) * sizeof(Clause), stateRegion); // 1 indexed array
+	satState->clause_lits = (Lit**)sat_region_realloc(satState->clause_lits, (arena->starts[num_clauses + 1] + 1) * sizeof(Lit*), stateRegion);
+	satState->clause_occurs = (Clause**)sat_region_realloc(satState->clause_occurs, (arena->starts[num_clauses + 1] + 1) * sizeof(Clause*), stateRegion);
+
+	// Setup each clause (index starting at 1)
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		c2dSize num_lits = arena->starts[i + 1] - arena->starts[i];
+		clauses[i].literals = satState->clause_lits + arena->starts[i];
+
+		for (c2dSize j = 0; j < num_lits; j++) {
+			c2dLiteral lit_index = arena->lits[arena->starts[i] + j];
+			clauses[i].literals[j] = satState->lits[lit_index];
+		}
+
+		// Set the other values for this Clause struct
+		clauses[i].subsumed = 0;
+		clauses[i].free_lits = num_lits;
+		clauses[i].subsumed_on = NULL;
+		clauses[i].index = i;
+		clauses[i].num_lits = num_lits;
+		clauses[i].dec_level = -1;
+		clauses[i].lbd = 0;
+		clauses[i].mark = 0;
+	}
+
+	satState->CNF = clauses;
+
+	// The clauses of each literal are those of the arena's occurrence index, in the same order
+	for (c2dSize i = 0; i < arena->starts[num_clauses + 1]; i++)
+		satState->clause_occurs[i] = &clauses[arena->occurs[i]];
+	for (c2dLiteral i = -(c2dLiteral)num_vars; i <= (c2dLiteral)num_vars; i++) {
+		if (i == 0)
+			continue;
+		Lit* lit = satState->lits[i];
+		lit->clauses = satState->clause_occurs + arena->occurs_starts[i];
+		lit->num_clauses = arena->occurs_starts[i + 1] - arena->occurs_starts[i];
+		lit->var->num_mentioned += lit->num_clauses;
+	}
+
+	/******DEBUG / TEST SETUP CODE *************
+	SatState* s = satState;
+	printf("num_lits=%ld num_vars=%lu num_clauses=%lu\n", s->num_lits, s->num_vars, s->num_clauses);
+	for(int i = 1; i <= s->num_vars; i++) {
+		Var* var = s->vars[i];
+		printf("var %lu instantiated %d\n", var->index, var->instantiated);
+		printf("negLit %ld posLit %ld \n\n", var->neg_lit->index, var->pos_lit->index);
+	}
+	// printouts below should match intput CNF format
+	for(int i = 1; i <= s->num_clauses; i++) {
+		Clause clause = s->CNF[i];
+		for(int j = 0; j < clause.num_lits-1; j++) {
+			printf("%ld ", clause.literals[j]->index);
+		}
+		printf("%ld 0\n", clause.literals[clause.num_lits-1]->index);
+	}
+	// print literals and list of clauses belonging to them
+	for(int i = 1; i <= s->num_vars; i++) {
+		Lit* lit = s->lits[i];
+		printf("lit %ld clauses ", lit->index);
+		for(c2dSize j = 0; j < lit->num_clauses; j++)
+			printf("%lu ", lit->clauses[j]->index);
+		printf("\n");
+	}
+
+	for(int i = -1; i >= -1*(s->num_vars); i--) {
+		Lit* lit = s->lits[i];
+		printf("lit %ld clauses ", lit->index);
+		for(c2dSize j = 0; j < lit->num_clauses; j++)
+			printf("%lu ", lit->clauses[j]->index);
+		printf("\n");
+	}
+	*************************************/
+}
+
+//constructs a SatState which shares the cnf of the given sat state, and copies its added and
+//learned clauses, variable activities, saved phases and settings (but not its stop flag and hooks)
+SatState* sat_state_clone(const SatState* sat_state) {
+	SatState* clone = sat_state_from_arena(sat_state->arena);
+
+	//The clone is laid out like the sat state (var_order lists the variables from index 1)
+	if (sat_state->var_order != NULL) {
+		BOOLEAN laid_out = sat_state_reorder(sat_state->var_order + 1, clone);
+		assert(laid_out);
+		(void)laid_out;
+	}
+
+	clone->var_inc = sat_state->var_inc;
+	clone->random_state = sat_state->random_state;
+	clone->random_freq = sat_state->random_freq;
+	clone->restart_interval = sat_state->restart_interval;
+	clone->luby_restarts = sat_state->luby_restarts;
+	clone->local_search_flips = sat_state->local_search_flips;
+	clone->local_search_period = sat_state->local_search_period;
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++) {
+		clone->vars[i]->activity = sat_state->vars[i]->activity;
+		clone->vars[i]->phase = sat_state->vars[i]->phase;
+	}
+
+	copy_clause_list(sat_state->addedClauses, sat_state->num_added, clone->addedClauses, clone);
+	clone->num_added = sat_state->num_added;
+	copy_clause_list(sat_state->learnedClauses, sat_state->num_learned, clone->learnedClauses, clone);
+	clone->num_learned = sat_state->num_learned;
+	clone->num_learned_lits = sat_state->num_learned_lits;
+
+	return clone;
+}
+
+//Copy a list of clauses of another sat state (over the same variables) into a list of this sat state, in the same order
+//@param from: the list to copy
+//@param count: the number of clauses in the list
+//@param into: the list to copy into
+//@param sat_state: the SatState copied into
+void copy_clause_list(const clauseList* from, c2dSize count, clauseList* into, SatState* sat_state)
+{
+	//The head of a list is the clause pushed last, so the clauses are pushed back from the tail
+	const Clause** clauses = (const Clause**)malloc((count + 1) * sizeof(Clause*));
+	c2dSize num_clauses = 0;
+	for (clauseNode* trav = from->head; trav != NULL; trav = trav->next)
+		clauses[num_clauses++] = trav->node_clause;
+
+	while (num_clauses > 0)
+		copy_clause(clauses[--num_clauses], into, sat_state);
+	free(clauses);
+}
+
+//Copy a clause of another sat state (over the same variables) into a list of this sat state
+//@param clause: the clause to copy
+//@param list: the list the copy is pushed to
+//@param sat_state: the SatState copied into
+//@return the copy, with none of its literals set
+Clause* copy_clause(const Clause* clause, clauseList* list, SatState* sat_state)
+{
+	Clause* copy = new_clause(clause->num_lits, sat_state);
+	copy->index = clause->index;
+	copy->dec_level = clause->dec_level;
+	copy->lbd = clause->lbd;
+
+	//Added and learned clauses are both kept with the learned clauses of each literal
+	for (c2dSize i = 0; i < clause->num_lits; i++)
+	{
+		copy->literals[i] = sat_state->lits[clause->literals[i]->index];
+		add_learned_clause(copy->literals[i], copy);
+	}
+
+	clauseList_push(list, copy, &sat_state->list_nodes);
+	return copy;
+}
+
+//lays out the variables (each one with its literals) and the clauses of a sat state in memory, so that
+//related ones lie close to each other (see the header for the order)
+BOOLEAN sat_state_reorder(const c2dSize* var_order, SatState* sat_state) {
+	c2dSize num_vars = sat_state->num_vars;
+	if (sat_state->decision_level != 1 || sat_state->num_learned != 0 || sat_state->num_added != 0)
+		return 0;
+	for (c2dSize i = 1; i <= num_vars; i++)
+		if (sat_state->vars[i]->instantiated)
+			return 0;
+
+	//The order given must list each variable once
+	c2dSize* order = (c2dSize*)malloc((num_vars + 1) * sizeof(c2dSize));
+	c2dSize* positions = (c2dSize*)calloc(num_vars + 1, sizeof(c2dSize));
+	if (var_order == NULL)
+		cuthill_mckee_order(order, sat_state);
+	else
+		memcpy(order + 1, var_order, num_vars * sizeof(c2dSize));
+	for (c2dSize p = 1; p <= num_vars; p++) {
+		if (order[p] < 1 || order[p] > num_vars || positions[order[p]] != 0) {
+			free(order);
+			free(positions);
+			return 0;
+		}
+		positions[order[p]] = p;
+	}
+
+	//Each variable is moved with its literals to its position, and every pointer to them follows (the
+	//literals of the clauses are placed anew with the clauses)
+	VarCell* cells = (VarCell*)sat_region_alloc((num_vars + 1) * sizeof(VarCell), stateRegion);
+	for (c2dSize i = 1; i <= num_vars; i++) {
+		VarCell* cell = &cells[positions[i]];
+		*cell = *(VarCell*)sat_state->vars[i];
+		cell->var.pos_lit = &cell->pos_lit;
+		cell->var.neg_lit = &cell->neg_lit;
+		cell->pos_lit.var = &cell->var;
+		cell->neg_lit.var = &cell->var;
+		sat_state->vars[i] = &cell->var;
+		sat_state->lits[i] = &cell->pos_lit;
+		sat_state->lits[-(c2dLiteral)i] = &cell->neg_lit;
+	}
+	sat_region_free(sat_state->var_cells);
+	sat_state->var_cells = cells;
+	sat_state->num_failed = 0;
+	sat_state->assertion_clause = NULL;
+
+	free(sat_state->var_order);
+	sat_state->var_order = order;
+	reorder_clauses(positions, sat_state);
+	free(positions);
+	return 1;
+}
+
+//Order the variables of a sat state by breadth first searches of the primal graph of its cnf (Cuthill-McKee):
+//each search starts from the variable mentioned least among those not ordered yet, and the variables
+//reached from a variable (through its clauses not searched yet) are ordered by how often they are mentioned
+//@param order: filled with the variable at each position (1 to n)
+//@param sat_state: the SatState
+void cuthill_mckee_order(c2dSize* order, const SatState* sat_state) {
+	c2dSize num_vars = sat_state->num_vars;
+	const ClauseArena* arena = sat_state->arena;
+	VarRank* ranks = (VarRank*)malloc((num_vars + 1) * sizeof(VarRank));
+	VarRank* queue = (VarRank*)malloc((num_vars + 1) * sizeof(VarRank));
+	BOOLEAN* queued = (BOOLEAN*)calloc(num_vars + 1, sizeof(BOOLEAN));
+	BOOLEAN* searched = (BOOLEAN*)calloc(sat_state->num_clauses + 1, sizeof(BOOLEAN));
+
+	for (c2dSize i = 1; i <= num_vars; i++) {
+		ranks[i].degree = var_degree(i, arena);
+		ranks[i].index = i;
+	}
+	qsort(ranks + 1, num_vars, sizeof(VarRank), compare_var_ranks);
+
+	c2dSize head = 1, tail = 1, start = 1;
+	while (head <= num_vars) {
+		if (head == tail) {
+			while (queued[ranks[start].index])
+				start++;
+			queue[tail++] = ranks[start];
+			queued[ranks[start].index] = 1;
+		}
+		c2dSize var = queue[head++].index;
+
+		//The variables of the clauses of both literals, which no search reached yet, come next
+		c2dSize reached = tail;
+		for (c2dLiteral lit = -(c2dLiteral)var; lit <= (c2dLiteral)var; lit += 2 * (c2dLiteral)var) {
+			for (c2dSize k = arena->occurs_starts[lit]; k < arena->occurs_starts[lit + 1]; k++) {
+				c2dSize clause = arena->occurs[k];
+				if (searched[clause])
+					continue;
+				searched[clause] = 1;
+				for (c2dSize j = arena->starts[clause]; j < arena->starts[clause + 1]; j++) {
+					c2dSize other = (c2dSize)(arena->lits[j] < 0 ? -arena->lits[j] : arena->lits[j]);
+					if (queued[other])
+						continue;
+					queued[other] = 1;
+					queue[tail].degree = var_degree(other, arena);
+					queue[tail++].index = other;
+				}
+			}
+		}
+		qsort(queue + reached, tail - reached, sizeof(VarRank), compare_var_ranks);
+	}
+
+	for (c2dSize p = 1; p <= num_vars; p++)
+		order[p] = queue[p].index;
+	free(ranks);
+	free(queue);
+	free(queued);
+	free(searched);
+}
+
+//returns the number of clauses of an arena mentioning a variable
+//@param var: the index of the variable
+//@param arena: the arena, with its occurrence index
+c2dSize var_degree(c2dSize var, const ClauseArena* arena) {
+	c2dLiteral lit = (c2dLiteral)var;
+	return arena->occurs_starts[lit + 1] - arena->occurs_starts[lit] + arena->occurs_starts[-lit + 1] - arena->occurs_starts[-lit];
+}
+
+//Order VarRanks by increasing degree, then by increasing index
+//@return a negative number if a comes first, a positive one if b does
+int compare_var_ranks(const void* a, const void* b) {
+	const VarRank* first = (const VarRank*)a;
+	const VarRank* second = (const VarRank*)b;
+	if (first->degree != second->degree)
+		return first->degree < second->degree ? -1 : 1;
+	return first->index < second->index ? -1 : first->index > second->index;
+}
+
+//Lay out the clauses of the CNF of a sat state by the first position of their variables (clauses with the
+//same one keep the order of their indices), the literals of each clause following the same order
+//The literals and clauses are found from the arena, whose arrays are smaller than those of the sat state
+//@param positions: the position of each variable (indices 1 to n)
+//@param sat_state: the SatState, as constructed, whose literals were moved (but not those of its clauses)
+void reorder_clauses(const c2dSize* positions, SatState* sat_state) {
+	const ClauseArena* arena = sat_state->arena;
+	c2dSize num_vars = sat_state->num_vars;
+	c2dSize num_clauses = sat_state->num_clauses;
+	c2dSize num_lits = arena->starts[num_clauses + 1];
+
+	//The clauses are counted by their first position, then placed
+	c2dSize* firsts = (c2dSize*)malloc((num_clauses + 1) * sizeof(c2dSize));
+	c2dSize* counts = (c2dSize*)calloc(num_vars + 2, sizeof(c2dSize));
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		firsts[i] = num_vars;
+		for (c2dSize j = arena->starts[i]; j < arena->starts[i + 1]; j++) {
+			c2dSize position = positions[arena->lits[j] < 0 ? -arena->lits[j] : arena->lits[j]];
+			if (position < firsts[i])
+				firsts[i] = position;
+		}
+		counts[firsts[i] + 1]++;
+	}
+	for (c2dSize p = 1; p <= num_vars; p++)
+		counts[p + 1] += counts[p];
+
+	c2dSize* clause_positions = (c2dSize*)malloc((num_clauses + 1) * sizeof(c2dSize));
+	c2dSize* placed = (c2dSize*)malloc((num_clauses + 1) * sizeof(c2dSize));
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		clause_positions[i] = 1 + counts[firsts[i]]++;
+		placed[clause_positions[i]] = i;
+	}
+
+	//The literals of each clause follow those of the clause placed before it (firsts now holds where)
+	c2dSize size = 0;
+	for (c2dSize p = 1; p <= num_clauses; p++) {
+		firsts[placed[p]] = size;
+		size += arena->starts[placed[p] + 1] - arena->starts[placed[p]];
+	}
+
+	//Each clause is copied to its position, with its literals, and the clauses of each literal follow
+	Clause* clauses = (Clause*)sat_region_alloc((num_clauses + 1) * sizeof(Clause), stateRegion);
+	Lit** clause_lits = (Lit**)sat_region_alloc((num_lits + 1) * sizeof(Lit*), stateRegion);
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		Clause* clause = &clauses[clause_positions[i]];
+		*clause = *sat_index2clause(i, sat_state);
+		clause->literals = clause_lits + firsts[i];
+		for (c2dSize j = 0; j < clause->num_lits; j++)
+			clause->literals[j] = sat_state->lits[arena->lits[arena->starts[i] + j]];
+	}
+	for (c2dSize i = 0; i < num_lits; i++)
+		sat_state->clause_occurs[i] = &clauses[clause_positions[arena->occurs[i]]];
+
+	sat_region_free(sat_state->CNF);
+	sat_region_free(sat_state->clause_lits);
+	free(sat_state->clause_positions);
+	sat_state->CNF = clauses;
+	sat_state->clause_lits = clause_lits;
+	sat_state->clause_positions = clause_positions;
+	free(firsts);
+	free(counts);
+	free(placed);
+}
+
+//frees the SatState
+void sat_state_free(SatState* sat_state) {
+	free_sat_state_contents(sat_state);
+
+	// Free the literals of the clauses, and the clauses, in sat_state
+	sat_region_free(sat_state->clause_lits);
+	sat_region_free(sat_state->clause_occurs);
+	sat_region_free(sat_state->CNF);
+	release_clause_arena(sat_state->arena);
+
+	// Free sat_state struct itself
+	free(sat_state);
+}
+
+//Free what a SatState allocated, except for the SatState itself, its CNF, clause_lits and clause_occurs blocks, and its arena
+//@param sat_state: the SatState
+void free_sat_state_contents(SatState* sat_state) {
+	// Free decisions list in satState (including the start level), before the literals they point to
+	decList* decisionList = sat_state->decisions;
+	Decision* decision;
+	while((decision = decList_pop(decisionList, &sat_state->list_nodes)) != NULL)
+		free_decision(decision, sat_state);
+	free(decisionList);
+
+	// // Free what each Var and Lit struct points to
+	for (c2dLiteral i = 1; i <= sat_state->num_vars; i++) {
+		// Free the learned clauses of the positive and negative literals (their clauses of the CNF lie in clause_occurs)
+		free(sat_state->lits[i]->learnedClauses);
+		free(sat_state->lits[i*-1]->learnedClauses);
+	}
+
+	// Free the Var and Lit structs, the list of Var/Lit pointers in sat_state, and their layout
+	sat_region_free(sat_state->var_cells);
+	free(sat_state->vars);
+	free(sat_state->lits - sat_state->num_vars);
+	free(sat_state->var_order);
+	free(sat_state->clause_positions);
+
+	// Free the lists of learned and added clauses (the clauses and the nodes of the lists go with the pools below)
+	free(sat_state->learnedClauses);
+	free(sat_state->addedClauses);
+	
+	free(sat_state->failed);
+	free(sat_state->level_marks);
+	nodePool_release(&sat_state->list_nodes);
+	nodePool_release(&sat_state->unit_nodes);
+	nodePool_release(&sat_state->decision_nodes);
+	blockPool_release(&sat_state->clause_blocks);
+	litVector_free(&sat_state->scratch_lits);
+	if (sat_state->local_search != NULL)
+		free_local_search(sat_state->local_search, sat_state);
+
+	if (sat_state->proof != NULL)
+		sat_proof_close(sat_state);
+	sat_trace_stop(sat_state);
+}
+
+/******************************************************************************
+* Given a SatState, which should contain data related to the current setting
+* (i.e., decided literals, subsumed clauses, decision level, etc.), this function
+* should perform unit resolution at the current decision level
+*
+* It returns 1 if succeeds, 0 otherwise (after constructing an asserting
+* clause)
+*
+* There are three possible places where you should perform unit resolution:
+* (1) after deciding on a new literal (i.e., in sat_decide_literal())
+* (2) after adding an asserting clause (i.e., in sat_assert_clause(...))
+* (3) neither the above, which would imply literals appearing in unit clauses
+*
+* (3) would typically happen only once and before the other two cases
+* It may be useful to distinguish between the above three cases
+*
+* Note if the current decision level is L, then the literals implied by unit
+* resolution must have decision level L
+*
+* This implies that there must be a start level S, which will be the level
+* where the decision sequence would be empty
+*
+* We require you to choose S as 1, then literals implied by (3) would have 1 as
+* their decision level (this level will also be the assertion level of unit
+* clauses)
+*
+* Yet, the first decided literal must have 2 as its decision level
+******************************************************************************/
+
+//applies unit resolution to the cnf of sat state
+//returns 1 if unit resolution succeeds, 0 if it finds a contradiction
+BOOLEAN sat_unit_resolution(SatState* sat_state) {
+	//Clause for containing a contradiction if found
+	Clause* contradiction = NULL;
+
+	//At the start level, the units come from unit clauses instead of a decision
+	if (sat_state->decision_level == 1) {
+		if (initial_unit_resolution(sat_state) == 0)
+			return 0;
+	}
+
+	//Create a litNode to traverse the decision's list of unit literals
+	Decision* decision = get_latest_decision(sat_state);
+	dlitNode* trav = decision->units->head;
+
+	//While not at the end of the literal list (units found while traversing are pushed to its end)
+	while (trav != NULL)
+	{	
+		//Skip the units which were set by an earlier call
+		if (trav->node_lit->truth_value == -1)
+		{
+			//Set the literal and get a contradiction clause if one exists
+			TRACE_EVENT(traceImply, trav->node_lit->index, trav->node_lit->unit_on->index, sat_state);
+			contradiction = set_literal(trav->node_lit, sat_state);
+
+			//Set the literal and return 0 if unit resolution returns a contradiction clause
+			if (contradiction != NULL)
+			{
+				clear_pending_units(decision, sat_state);
+
+				//Get the assertion clause
+				sat_state->assertion_clause = get_assertion_clause(contradiction, sat_state);
+				return 0;
+			}
+		}
+		trav = trav->next;
+	}
+	return 1;		//Resolution completed without returning a contradiction clause i.e. unit resolution succeeded
+}
+
+//Queue the unit literals of the clauses in the CNF, added clauses and learned clauses at the start level
+//@param sat_state: the SatState to investigate
+//@return 0 if a clause has no free literal left, 1 otherwise
+BOOLEAN initial_unit_resolution(SatState* sat_state)
+{
+	//Loop through each clause in the CNF
+	for (c2dSize i = 1; i <= sat_state->num_clauses; i++)
+	{
+		Clause* clause = sat_index2clause(i, sat_state);
+
+		//Subsumed clauses cannot become unit
+		if (clause->subsumed == 1)
+			continue;
+
+		//If the clause has one free literal, queue it for unit resolution
+		if (clause->free_lits == 1)
+			queue_unit(get_unit_lit(clause), clause, sat_state);
+
+		//A clause without free literals is a contradiction at the start level
+		else if (clause->free_lits == 0)
+		{
+			sat_state->assertion_clause = get_assertion_clause(clause, sat_state);
+			return 0;
+		}
+	}
+
+	//Loop through all added and learned clauses
+	if (queue_unit_clauses(sat_state->addedClauses, sat_state) == 0)
+		return 0;
+	return queue_unit_clauses(sat_state->learnedClauses, sat_state);
+}
+
+//Queue the unit literals of the clauses in a list
+//@param clauses: the clauses to check
+//@param sat_state: the SatState to investigate
+//@return 0 if a clause has no free literal left, 1 otherwise
+BOOLEAN queue_unit_clauses(clauseList* clauses, SatState* sat_state)
+{
+	//Node for traversing the clauses
+	clauseNode* trav = clauses->head;
+
+	while (trav != NULL)
+	{
+		if (trav->node_clause->subsumed == 0)
+		{
+			//If the clause has one free literal, queue it for unit resolution
+			if (trav->node_clause->free_lits == 1)
+				queue_unit(get_unit_lit(trav->node_clause), trav->node_clause, sat_state);
+
+			//A clause without free literals is a contradiction at the start level
+			else if (trav->node_clause->free_lits == 0)
+			{
+				sat_state->assertion_clause = get_assertion_clause(trav->node_clause, sat_state);
+				return 0;
+			}
+		}
+		trav = trav->next;
+	}
+	return 1;
+}
+
+//undoes sat_unit_resolution(), leading to un-instantiating variables that have been instantiated
+//after sat_unit_resolution()
+void sat_undo_unit_resolution(SatState* sat_state) {
+	//Clear the assertion clause
+	sat_state->assertion_clause = NULL;
+
+	//Literal currently being undone
+	Lit* undo_lit;
+
+	//Undo the units in the reverse order they were set (the start level has a decision without a literal)
+	Decision* decision = get_latest_decision(sat_state);
+	while ((undo_lit = dlitList_pop_back(decision->units, &sat_state->unit_nodes)) != NULL)
+	{
+		//Undo the unit resolution on the current literal
+		if (undo_lit->truth_value == 1)
+			undo_set_literal(undo_lit, sat_state);
+		undo_lit->unit_on = NULL;
+	}
+}
+
+//Undoes every decision and the resolution at the start level
+//@param sat_state: the SatState to undo resolution on
+void undo_all_resolution(SatState* sat_state)
+{
+	//Undo decisions until the start level is reached
+	while (sat_state->decision_level > 1)
+		sat_undo_decide_literal(sat_state);
+
+	//Undo the units implied at the start level
+	sat_undo_unit_resolution(sat_state);
+}
+
+//Take a clause from the pool of a SatState, with room for its literals right after it
+//The clause is neither subsumed nor learned yet, and all its literals are free
+//@param num_lits: the number of literals of the clause
+//@param sat_state: the SatState whose pool the clause is taken from
+//@return the clause
+Clause* new_clause(c2dSize num_lits, SatState* sat_state)
+{
+	Clause* clause = (Clause*)blockPool_get(&sat_state->clause_blocks, sizeof(Clause) + num_lits * sizeof(Lit*));
+	clause->index = 0;			//Set when the clause is asserted or added
+	clause->num_lits = num_lits;
+	clause->free_lits = num_lits;
+	clause->literals = (Lit**)(clause + 1);
+	clause->subsumed = 0;
+	clause->subsumed_on = NULL;
+	clause->dec_level = -1;
+	clause->lbd = 0;
+	clause->mark = 0;
+	return clause;
+}
+
+//Drop a learned clause which was not asserted
+//Its room is reused by the next clause if it was the last one taken, it is kept with the others until the SatState is freed otherwise
+//@param clause: the clause to drop
+//@param sat_state: the SatState the clause was taken from
+void drop_clause(Clause* clause, SatState* sat_state)
+{
+	sat_state->num_dropped++;
+	blockPool_unget(&sat_state->clause_blocks, clause);
+}
+
+//Take a decision from the pool of a SatState, with an empty list of units lying right after it
+//@param dec_lit: the literal decided (NULL at the start level)
+//@param sat_state: the SatState whose pool the decision is taken from
+//@return the decision
+Decision* new_decision(Lit* dec_lit, SatState* sat_state)
+{
+	Decision* decision = (Decision*)nodePool_get(&sat_state->decision_nodes);
+	decision->dec_lit = dec_lit;
+	decision->units = (dlitList*)(decision + 1);
+	decision->units->head = NULL;
+	decision->units->tail = NULL;
+	return decision;
+}
+
+//Free the decision and all its underlying pointers
+//@param undo_dec: decision to free
+//@param sat_state: the SatState whose pools the decision and the nodes of its units are given back to
+void free_decision(Decision* undo_dec, SatState* sat_state)
+{
+	//Free the units list (units are normally already undone by sat_undo_unit_resolution)
+	while (undo_dec->units->head != NULL)
+		dlitList_pop(undo_dec->units, &sat_state->unit_nodes)->unit_on = NULL;
+
+	//Give the decision (and its list of units) back
+	nodePool_put(&sat_state->decision_nodes, undo_dec);
+}
+
+
+//returns 1 if the decision level of the sat state equals to the assertion level of clause,
+//0 otherwise
+//
+//this function is called after sat_decide_literal() or sat_assert_clause() returns clause.
+//it is used to decide whether the sat state is at the right decision level for adding clause.
+BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state) {
+	if (clause->dec_level == sat_state->decision_level)
+		return 1;
+	return 0;
+}
+
+// Returns the latest decision made in the current SatState
+Decision* get_latest_decision(SatState* sat_state) {
+	if(sat_state == NULL)
+		return NULL;
+	else if(sat_state->decisions->head == NULL)
+		return NULL;
+	else {
+		return sat_state->decisions->head->node_dec;
+	}
+}
+
+void debug_print_clauses(SatState* sat_state) {
+	/************* DEBUG PRINTOUTS ********************/
+	printf("Clauses at decision level %d:\n", sat_state->decision_level);
+	for(c2dSize i = 1; i <= sat_state->num_clauses; i++) {
+		Clause* clause = sat_index2clause(i, sat_state);
+		printf("Clause %2lu has %2d free lits. Subsumed = %d\n", clause->index, clause->free_lits, clause->subsumed);
+		for(c2dSize j = 0; j < clause->num_lits; j++) {
+			printf("%ld ", clause->literals[j]->index);
+		}
+		printf("\n");
+	}
+}
+
+//Mark the literals of a clause for conflict analysis
+//Literals at the current decision level are only counted, the others are added to lower_lits
+//Literals set at the start level are left out, as they hold no matter what is decided
+//@param clause: the contradiction clause, or the clause on which a literal became unit
+//@param skip: the variable the clause was unit on (NULL for the contradiction clause)
+//@param lower_lits: the literals set below the current decision level
+//@param sat_state: the SatState to search
+//@return the number of newly marked literals at the current decision level
+int mark_conflict_lits(Clause* clause, const Var* skip, litVector* lower_lits, SatState* sat_state)
+{
+	int marked = 0;		//Number of literals marked at the current decision level
+	Var* var;			//Variable of the literal being marked
+
+	for (int i = 0; i < clause->num_lits; i++)
+	{
+		var = sat_literal_var(clause->literals[i]);
+		if (var == skip || var->seen == 1 || var->decision_level <= 1)
+			continue;
+		var->seen = 1;
+
+		//Variables involved in the contradiction are preferred for the next decisions
+		var->activity += sat_state->var_inc;
+		if (var->activity > activityLimit)
+		{
+			for (c2dSize j = 1; j <= sat_state->num_vars; j++)
+				sat_state->vars[j]->activity /= activityLimit;
+			sat_state->var_inc /= activityLimit;
+		}
+
+		if (var->decision_level == sat_state->decision_level)
+			marked++;
+		else
+			litVector_push(lower_lits, clause->literals[i]);
+	}
+	return marked;
+}
+
+//Get the assertion clause
+//The clause holds the opposite of the first uip and the literals below the current decision level
+//that lead to the contradiction. Its assertion level is the highest level among the latter.
+//@param contradiction: the contradiction clause found at the current level
+//@param sat_state: the SatState to search
+//@return the assertion clause (the empty clause, with assertion level 0, for a contradiction at the start level)
+Clause* get_assertion_clause(Clause* contradiction, SatState* sat_state)
+{
+	Clause* assertion;
+	sat_state->num_conflicts++;
+	TRACE_EVENT(traceConflict, 0, contradiction->index, sat_state);
+
+	//Nothing was decided at the start level, so the contradiction cannot be undone
+	if (sat_state->decision_level <= 1)
+	{
+		assertion = new_clause(0, sat_state);
+		assertion->dec_level = 0;
+		if (sat_state->proof != NULL)
+			proof_clause(assertion, 'a', sat_state->proof);
+		TRACE_EVENT(traceLearn, 0, 0, sat_state);
+		return assertion;
+	}
+
+	//The literals below this decision level are gathered in the scratch vector, until the size of the clause is known
+	litVector* lower_lits = &sat_state->scratch_lits;
+	litVector_clear(lower_lits);
+
+	//Number of marked literals at this decision level which have not been resolved yet
+	int pending = mark_conflict_lits(contradiction, NULL, lower_lits, sat_state);
+
+	/**UIP**/
+	//Walk back from the last unit of this decision level until a single marked literal is left
+	Decision* decision = get_latest_decision(sat_state);
+	dlitNode* trav = decision->units->tail;
+	Lit* uip;
+	while (1)
+	{
+		//Move to the most recently set marked literal
+		while (trav != NULL && sat_literal_var(trav->node_lit)->seen == 0)
+			trav = trav->prev;
+		uip = (trav == NULL) ? decision->dec_lit : trav->node_lit;
+
+		//The only marked literal left is the uip
+		if (--pending == 0)
+			break;
+
+		//Replace the literal by the literals of the clause it became unit on
+		assert(trav != NULL);
+		pending += mark_conflict_lits(uip->unit_on, sat_literal_var(uip), lower_lits, sat_state);
+		trav = trav->prev;
+	}
+
+	//The assertion clause holds the uip and the literals below this decision level
+	assertion = new_clause(lower_lits->size + 1, sat_state);
+
+	//Add opposite of uip to assertion clause
+	assertion->literals[0] = opp_lit(uip);
+
+	//Place each literal into the list of literals in the clause, keeping the highest decision level
+	assertion->dec_level = 1;
+	for (int i = 1; i < assertion->num_lits; i++)
+	{
+		assertion->literals[i] = litVector_pop(lower_lits);
+		sat_literal_var(assertion->literals[i])->seen = 0;
+		if (sat_literal_var(assertion->literals[i])->decision_level > assertion->dec_level)
+			assertion->dec_level = sat_literal_var(assertion->literals[i])->decision_level;
+	}
+
+	//Count the decision levels among the literals
+	sat_state->lbd_stamp++;
+	for (int i = 0; i < assertion->num_lits; i++)
+	{
+		int level = sat_literal_var(assertion->literals[i])->decision_level;
+		if (sat_state->level_marks[level] != sat_state->lbd_stamp)
+		{
+			sat_state->level_marks[level] = sat_state->lbd_stamp;
+			assertion->lbd++;
+		}
+	}
+
+	//Clear the marks left at this decision level
+	for (trav = decision->units->head; trav != NULL; trav = trav->next)
+		sat_literal_var(trav->node_lit)->seen = 0;
+	sat_literal_var(decision->dec_lit)->seen = 0;
+
+	//Later contradictions weigh more than this one
+	sat_state->var_inc /= varDecay;
+
+	TRACE_EVENT(traceLearn, assertion->literals[0]->index, assertion->num_lits, sat_state);
+	return assertion;
 }
 
 /******************************************************************************
-* Given a SatState, which should contain data related to the current setting
-* (i.e., decided literals, subsumed clauses, decision level, etc.), this function
-* should perform unit resolution at the current decision level
-*
-* It returns 1 if succeeds, 0 otherwise (after constructing an asserting
-* clause)
-*
-* There are three possible places where you should perform unit resolution:
-* (1) after deciding on a new literal (i.e., in sat_decide_literal())
-* (2) after adding an asserting clause (i.e., in sat_assert_clause(...))
-* (3) neither the above, which would imply literals appearing in unit clauses
+* Builders
 *
-* (3) would typically happen only once and before the other two cases
-* It may be useful to distinguish between the above three cases
+* A builder puts the clauses of a cnf given in memory into an arena, as the
+* parser does with the text of a file, so a program can construct a SatState
+* without writing its cnf out. Borrowed clauses are used where they lie: they
+* are only copied if they must be cleaned up (see normalize_clause_arena()).
+******************************************************************************/
+
+//constructs a builder of a cnf over num_vars variables (more are added as the clauses use them)
+SatBuilder* sat_builder_new(c2dSize num_vars) {
+	SatBuilder* builder = (SatBuilder*)malloc(sizeof(SatBuilder));
+	ClauseArena* arena = new_clause_arena();
+	arena->num_vars = num_vars;
+	arena->num_clauses = 0;
+	arena->starts_capacity = 16;
+	arena->starts = (c2dSize*)sat_region_alloc(arena->starts_capacity * sizeof(c2dSize), clauseRegion);
+	arena->starts[1] = 0;
+	arena->num_duplicate_lits = 0;
+	arena->num_tautologies = 0;
+	arena->num_duplicate_clauses = 0;
+	arena->refs = 0;
+	builder->arena = arena;
+	builder->num_lits = 0;
+	return builder;
+}
+
+//adds a clause (copying its literals, given by their indices) to the cnf of a builder
+//an empty clause is skipped, as it is in a cnf file
+void sat_builder_add_clause(const c2dLiteral* lits, c2dSize num_lits, SatBuilder* builder) {
+	ClauseArena* arena = builder->arena;
+	if (num_lits == 0)
+		return;
+	check_builder_literals(lits, num_lits, builder);
+	if (arena->lits_borrowed)
+		own_clause_literals(arena, builder->num_lits);
+
+	if (arena->num_clauses + 3 > arena->starts_capacity) {
+		arena->starts_capacity = 2 * arena->starts_capacity;
+		arena->starts = (c2dSize*)sat_region_realloc(arena->starts, arena->starts_capacity * sizeof(c2dSize), clauseRegion);
+	}
+	if (builder->num_lits + num_lits > arena->lits_capacity) {
+		arena->lits_capacity = 2 * arena->lits_capacity + num_lits + 16;
+		arena->lits = (c2dLiteral*)sat_region_realloc(arena->lits, arena->lits_capacity * sizeof(c2dLiteral), clauseRegion);
+	}
+	memcpy(arena->lits + builder->num_lits, lits, num_lits * sizeof(c2dLiteral));
+	builder->num_lits += num_lits;
+	arena->starts[++arena->num_clauses + 1] = builder->num_lits;
+}
+
+//adds clauses whose literals stay where they lie to the cnf of a builder: clause i (from 0) is
+//lits[offsets[i]] to lits[offsets[i + 1] - 1], so offsets has num_clauses + 1 entries
+//the literals must neither change nor be freed until the SatState constructed from the builder
+//(and its clones) are freed; they are copied anyway if the builder already has clauses
+void sat_builder_borrow_clauses(const c2dLiteral* lits, const c2dSize* offsets, c2dSize num_clauses, SatBuilder* builder) {
+	ClauseArena* arena = builder->arena;
+	if (arena->num_clauses > 0) {
+		for (c2dSize i = 0; i < num_clauses; i++)
+			sat_builder_add_clause(lits + offsets[i], offsets[i + 1] - offsets[i], builder);
+		return;
+	}
+
+	c2dSize first = offsets[0];
+	check_builder_literals(lits + first, offsets[num_clauses] - first, builder);
+	if (!arena->lits_borrowed)
+		sat_region_free(arena->lits);
+	arena->lits = (c2dLiteral*)(lits + first);
+	arena->lits_capacity = 0;
+	arena->lits_borrowed = 1;
+
+	if (num_clauses + 2 > arena->starts_capacity) {
+		arena->starts_capacity = num_clauses + 2;
+		arena->starts = (c2dSize*)sat_region_realloc(arena->starts, arena->starts_capacity * sizeof(c2dSize), clauseRegion);
+	}
+	// Empty clauses are skipped, which leaves the others where they are
+	for (c2dSize i = 0; i < num_clauses; i++)
+		if (offsets[i + 1] > offsets[i])
+			arena->starts[++arena->num_clauses] = offsets[i] - first;
+	builder->num_lits = offsets[num_clauses] - first;
+	arena->starts[arena->num_clauses + 1] = builder->num_lits;
+}
+
+//constructs a SatState from the cnf of a builder, which is freed
+SatState* sat_builder_finish(SatBuilder* builder) {
+	ClauseArena* arena = builder->arena;
+	free(builder);
+	normalize_clause_arena(arena);
+	index_clause_arena(arena);
+	return sat_state_from_arena(arena);
+}
+
+//Check that literals given to a builder are not 0, and add the variables they are over to its cnf
+//@param lits: the literals
+//@param num_lits: the number of literals
+//@param builder: the builder
+void check_builder_literals(const c2dLiteral* lits, c2dSize num_lits, SatBuilder* builder) {
+	for (c2dSize i = 0; i < num_lits; i++) {
+		c2dSize var = lits[i] > 0 ? (c2dSize)lits[i] : (c2dSize)-lits[i];
+		if (var == 0) {
+			fprintf(stderr, "Literal 0 in a clause given to a builder\n");
+			exit(1);
+		}
+		if (var > builder->arena->num_vars)
+			builder->arena->num_vars = var;
+	}
+}
+
+/******************************************************************************
+* Incremental solving
 *
-* Note if the current decision level is L, then the literals implied by unit
-* resolution must have decision level L
+* A SatState can be solved several times, under different assumptions and with
+* clauses added in between. Learned clauses, variable activities and saved
+* phases are kept from one call to the next, so later calls start from what
+* earlier calls found.
+******************************************************************************/
+
+//adds a clause over the given literals to the cnf of sat state and returns it
+//it can only be called at the start level (returns NULL otherwise), and undoes unit
+//resolution at that level
+Clause* sat_add_clause(Lit** lits, c2dSize num_lits, SatState* sat_state) {
+	if (sat_state == NULL || sat_state->decision_level != 1)
+		return NULL;
+
+	//Clause counts are only right when nothing is set
+	sat_undo_unit_resolution(sat_state);
+
+	Clause* clause = new_clause(num_lits, sat_state);
+
+	//Added clauses are kept with the learned clauses of each literal for unit resolution
+	for (c2dSize i = 0; i < num_lits; i++)
+	{
+		clause->literals[i] = lits[i];
+		add_learned_clause(lits[i], clause);
+	}
+
+	clauseList_push(sat_state->addedClauses, clause, &sat_state->list_nodes);
+	sat_state->num_added++;
+	sat_state->num_learned_lits += num_lits;
+	clause->index = sat_state->num_clauses + sat_state->num_added + sat_state->num_learned;
+
+	return clause;
+}
+
+//checks the satisfiability of the cnf of sat state with the given literals assumed true
+//returns 1 if satisfiable (see sat_model_value()), 0 otherwise (see sat_failed_assumptions()),
+//and -1 if the stop flag was set before an answer was found
+BOOLEAN sat_solve_with_assumptions(Lit** assumptions, c2dSize num_assumptions, SatState* sat_state) {
+	BOOLEAN ret = 0;
+	sat_state->num_failed = 0;
+
+	if (sat_unit_resolution(sat_state))
+		ret = search_with_assumptions(assumptions, num_assumptions, sat_state);
+	else
+	{
+		//The empty clause learned at the start level is not kept
+		drop_clause(sat_state->assertion_clause, sat_state);
+		sat_state->assertion_clause = NULL;
+	}
+
+	//Everything goes back to the start level
+	undo_all_resolution(sat_state);
+	return ret;
+}
+
+//Search for a model once unit resolution at the start level succeeded
+//Assumptions are decided first (in order), then the free literal with the highest activity
+//@param assumptions: literals assumed true
+//@param num_assumptions: number of assumptions
+//@param sat_state: the SatState to search
+//@return 1 if a model is found (and stored in the variables), 0 if there is none, -1 if stopped
+BOOLEAN search_with_assumptions(Lit** assumptions, c2dSize num_assumptions, SatState* sat_state)
+{
+	Lit* lit;				//Literal to decide next
+	c2dSize restarts = 0;	//Number of restarts so far
+	c2dSize conflicts = 0;	//Number of contradictions since the last restart
+	c2dSize next_local_search = 0;	//Restarts before the next local search
+
+	while (1)
+	{
+		if (sat_state->stop != NULL && *sat_state->stop)
+			return -1;
+
+		//Start over from the start level, keeping what was learned
+		if (sat_state->restart_interval != 0 && conflicts >= restart_limit(restarts, sat_state))
+		{
+			conflicts = 0;
+			restarts++;
+			if (restart_search(sat_state) == 0)
+				return 0;
+		}
+
+		//Local search from the start level sets the phases of the next decisions
+		if (sat_state->local_search_flips != 0 && sat_state->decision_level == 1 && restarts >= next_local_search)
+		{
+			sat_local_search(sat_state->local_search_flips, sat_state);
+			next_local_search = restarts + (sat_state->local_search_period == 0 ? 1 : sat_state->local_search_period);
+		}
+
+		//Find the first assumption which is not implied yet
+		lit = NULL;
+		for (c2dSize i = 0; i < num_assumptions && lit == NULL; i++)
+		{
+			if (assumptions[i]->truth_value != 1)
+				lit = assumptions[i];
+		}
+
+		//An assumption contradicts the cnf and the earlier assumptions
+		if (lit != NULL && lit->truth_value == 0)
+		{
+			find_failed_assumptions(lit, sat_state);
+			return 0;
+		}
+
+		//Every literal is set: store the model
+		if (lit == NULL && (lit = get_branch_literal(sat_state)) == NULL)
+		{
+			for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+				sat_state->vars[i]->model_value = sat_state->vars[i]->pos_lit->truth_value;
+			return 1;
+		}
+
+		if (!assert_learned_clauses(sat_decide_literal(lit, sat_state), &conflicts, sat_state))
+			return 0;
+	}
+}
+
+//Backtrack to the assertion level of each learned clause and assert it there, until
+//unit resolution finds no contradiction
+//@param learned: the clause learned from the last contradiction (NULL if there was none)
+//@param conflicts: counter incremented on each contradiction
+//@param sat_state: the SatState being solved
+//@return 0 if a contradiction is found at the start level (the cnf is unsatisfiable), 1 otherwise
+BOOLEAN assert_learned_clauses(Clause* learned, c2dSize* conflicts, SatState* sat_state)
+{
+	while (learned != NULL)
+	{
+		(*conflicts)++;
+
+		//Contradiction at the start level: the cnf is unsatisfiable
+		if (learned->dec_level < 1)
+		{
+			drop_clause(learned, sat_state);
+			sat_state->assertion_clause = NULL;
+			return 0;
+		}
+
+		if (sat_state->on_learned != NULL)
+			sat_state->on_learned(learned, sat_state->hook_data);
+
+		while (sat_state->decision_level > learned->dec_level)
+			sat_undo_decide_literal(sat_state);
+		learned = sat_assert_clause(learned, sat_state);
+	}
+	return 1;
+}
+
+//Undo every decision, and let the restart hook add clauses at the start level
+//@param sat_state: the SatState being solved
+//@return 0 if unit resolution at the start level then finds a contradiction, 1 otherwise
+BOOLEAN restart_search(SatState* sat_state)
+{
+	sat_state->num_restarts++;
+	TRACE_EVENT(traceRestart, 0, 0, sat_state);
+	while (sat_state->decision_level > 1)
+		sat_undo_decide_literal(sat_state);
+
+	if (sat_state->on_restart == NULL)
+		return 1;
+
+	//Clauses can only be added with nothing set
+	sat_undo_unit_resolution(sat_state);
+	sat_state->on_restart(sat_state, sat_state->hook_data);
+	if (sat_unit_resolution(sat_state))
+		return 1;
+
+	//The empty clause learned at the start level is not kept
+	drop_clause(sat_state->assertion_clause, sat_state);
+	sat_state->assertion_clause = NULL;
+	return 0;
+}
+
+//Gets the number of contradictions allowed before the next restart
+//@param restarts: the number of restarts so far
+//@param sat_state: the SatState being solved
+//@return the number of contradictions
+c2dSize restart_limit(c2dSize restarts, const SatState* sat_state)
+{
+	if (sat_state->luby_restarts)
+		return sat_state->restart_interval * luby(restarts);
+
+	double limit = sat_state->restart_interval;
+	for (c2dSize i = 0; i < restarts; i++)
+		limit *= 1.5;
+	return (c2dSize)limit;
+}
+
+//Gets the i^th term (from 0) of the luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+//@param i: the position of the term
+//@return the term
+c2dSize luby(c2dSize i)
+{
+	c2dSize size = 1;		//Size of the smallest complete subsequence containing position i
+	c2dSize exponent = 0;	//Its last term is 2^exponent
+
+	while (size < i + 1)
+	{
+		exponent++;
+		size = 2 * size + 1;
+	}
+
+	//Subsequences repeat the smaller ones before their last term
+	while (size - 1 != i)
+	{
+		size = (size - 1) / 2;
+		exponent--;
+		i = i % size;
+	}
+	return (c2dSize)1 << exponent;
+}
+
+//Gets the next number of the random generator of the sat state (xorshift)
+//@param sat_state: the SatState owning the generator
+//@return the number
+unsigned long next_random(SatState* sat_state)
+{
+	unsigned long x = sat_state->random_state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	sat_state->random_state = x;
+	return x * 2685821657736338717UL;
+}
+
+//Gets the free literal with the highest activity, in its saved phase
+//@param sat_state: the SatState to search
+//@return the literal, NULL if every variable is instantiated
+Lit* get_branch_literal(SatState* sat_state)
+{
+	Var* best = NULL;		//Free variable with the highest activity so far
+
+	//Some decisions are made on a random variable, away from where the activities lead
+	if (sat_state->random_state != 0 && sat_state->random_freq > 0 &&
+		(next_random(sat_state) % 1000000) < sat_state->random_freq * 1000000)
+	{
+		best = sat_state->vars[1 + next_random(sat_state) % sat_state->num_vars];
+		if (best->instantiated == 0)
+			return best->phase ? best->pos_lit : best->neg_lit;
+		best = NULL;
+	}
+
+	//The variables are gone through in the order they lie in memory, ties going to the lowest index
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+	{
+		Var* var = &sat_state->var_cells[i].var;
+		if (var->instantiated == 0 && (best == NULL || var->activity > best->activity ||
+			(var->activity == best->activity && var->index < best->index)))
+			best = var;
+	}
+
+	if (best == NULL)
+		return NULL;
+	return best->phase ? best->pos_lit : best->neg_lit;
+}
+
+//Collect the assumptions that imply the opposite of a failed assumption
+//Every decision is an assumption when this is called
+//@param failed_lit: the assumption found to be false
+//@param sat_state: the SatState to search
+void find_failed_assumptions(Lit* failed_lit, SatState* sat_state)
+{
+	sat_state->failed[0] = failed_lit;
+	sat_state->num_failed = 1;
+
+	//The opposite of the assumption is implied by the cnf alone
+	if (sat_literal_var(failed_lit)->decision_level <= 1)
+		return;
+	sat_literal_var(failed_lit)->seen = 1;
+
+	//Walk the implications backwards, from the latest decision to the first one
+	for (decNode* dec = sat_state->decisions->head; dec != NULL && dec->node_dec->dec_lit != NULL; dec = dec->next)
+	{
+		for (dlitNode* trav = dec->node_dec->units->tail; trav != NULL; trav = trav->prev)
+		{
+			Var* var = sat_literal_var(trav->node_lit);
+			if (var->seen == 0)
+				continue;
+
+			//Mark the literals which made this literal unit
+			for (int i = 0; i < trav->node_lit->unit_on->num_lits; i++)
+			{
+				if (sat_literal_var(trav->node_lit->unit_on->literals[i])->decision_level > 1)
+					sat_literal_var(trav->node_lit->unit_on->literals[i])->seen = 1;
+			}
+			var->seen = 0;
+		}
+
+		//A marked decision is one of the failed assumptions
+		Var* dec_var = sat_literal_var(dec->node_dec->dec_lit);
+		if (dec_var->seen == 1 && dec->node_dec->dec_lit != failed_lit)
+			sat_state->failed[sat_state->num_failed++] = dec->node_dec->dec_lit;
+		dec_var->seen = 0;
+	}
+}
+
+//returns the assumptions responsible for the last unsatisfiable result, and stores their number in count
+Lit** sat_failed_assumptions(c2dSize* count, const SatState* sat_state) {
+	*count = sat_state->num_failed;
+	return sat_state->failed;
+}
+
+//returns the value (1 or 0) of a variable in the last model found, -1 if there is none
+BOOLEAN sat_model_value(const Var* var) {
+	if (var == NULL)
+		return -1;
+	return var->model_value;
+}
+
+//decides the literal, counts the literals unit resolution implies from it and undoes the decision
+//returns the number of literals set by the decision (itself included), or -1 if unit resolution
+//finds a contradiction (the clause learned from it is dropped)
+long sat_lookahead_literal(Lit* lit, SatState* sat_state) {
+	long count = -1;
+	Clause* learned = sat_decide_literal(lit, sat_state);
+
+	if (learned == NULL)
+	{
+		count = 1;
+		for (dlitNode* trav = get_latest_decision(sat_state)->units->head; trav != NULL; trav = trav->next)
+			if (trav->node_lit->truth_value == 1)
+				count++;
+	}
+	sat_undo_decide_literal(sat_state);
+
+	if (learned != NULL)
+		drop_clause(learned, sat_state);
+	return count;
+}
+
+/******************************************************************************
+* Model enumeration
 *
-* This implies that there must be a start level S, which will be the level
-* where the decision sequence would be empty
+* The variables of the projection are decided before any other variable, so once
+* they are all set their values follow from the decisions made on them. Each model
+* is then blocked by a clause over the opposites of those decisions only, which is
+* asserted at the level of the last but one of them: the search goes on from
+* there, with the opposite of the last decision implied, instead of starting over.
+******************************************************************************/
+
+//enumerates the models of the cnf of sat state projected onto the given variables (onto every
+//variable if num_vars is 0): on_model is called once per projected model with the literals of the
+//projection true in it (in the order of vars), while sat_model_value() gives a full model
+//enumeration ends once every model was found, on_model returns 0, or the stop flag is set
+//returns the number of models passed to on_model
+//
+//the clauses blocking the models found are kept as learned clauses, which are not implied by the cnf:
+//the sat state should be freed (or renewed) once the enumeration ends, and it enumerates nothing
+//(returning 0) while a proof is open, as the proof would not check
+c2dSize sat_enumerate_models(Var** vars, c2dSize num_vars, BOOLEAN (*on_model)(Lit** lits, c2dSize num_lits, void* data), void* data, SatState* sat_state) {
+	c2dSize count = 0;
+	c2dSize conflicts = 0;
+	if (sat_state->proof != NULL)
+		return 0;
+	if (num_vars == 0)
+	{
+		vars = sat_state->vars + 1;
+		num_vars = sat_state->num_vars;
+	}
+	Lit** model = (Lit**)malloc((num_vars + 1) * sizeof(Lit*));
+	for (c2dSize i = 0; i < num_vars; i++)
+		vars[i]->projected = 1;
+
+	BOOLEAN searching = sat_unit_resolution(sat_state);
+	if (!searching)
+	{
+		//The empty clause learned at the start level is not kept
+		drop_clause(sat_state->assertion_clause, sat_state);
+		sat_state->assertion_clause = NULL;
+	}
+
+	while (searching && (sat_state->stop == NULL || !*sat_state->stop))
+	{
+		Lit* lit = get_projected_literal(sat_state);
+		if (lit != NULL)
+		{
+			searching = assert_learned_clauses(sat_decide_literal(lit, sat_state), &conflicts, sat_state);
+			continue;
+		}
+
+		//Every variable is set: pass the model on
+		for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+			sat_state->vars[i]->model_value = sat_state->vars[i]->pos_lit->truth_value;
+		for (c2dSize i = 0; i < num_vars; i++)
+			model[i] = vars[i]->pos_lit->truth_value == 1 ? vars[i]->pos_lit : vars[i]->neg_lit;
+		count++;
+		if (!on_model(model, num_vars, data))
+			break;
+
+		//Without decisions on the projection, the model found was the only one
+		Clause* blocking = get_blocking_clause(sat_state);
+		if (blocking == NULL)
+			break;
+		while (sat_state->decision_level > blocking->dec_level)
+			sat_undo_decide_literal(sat_state);
+		searching = assert_learned_clauses(sat_assert_clause(blocking, sat_state), &conflicts, sat_state);
+	}
+
+	//Everything goes back to the start level
+	undo_all_resolution(sat_state);
+	for (c2dSize i = 0; i < num_vars; i++)
+		vars[i]->projected = 0;
+	free(model);
+	return count;
+}
+
+//Gets the free variable of the projection with the highest activity (or the free literal
+//get_branch_literal() picks once the projection is set), in its saved phase
+//@param sat_state: the SatState to search
+//@return the literal, NULL if every variable is instantiated
+Lit* get_projected_literal(SatState* sat_state)
+{
+	Var* best = NULL;		//Free variable of the projection with the highest activity so far
+
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+	{
+		Var* var = sat_state->vars[i];
+		if (var->projected && var->instantiated == 0 && (best == NULL || var->activity > best->activity))
+			best = var;
+	}
+
+	if (best == NULL)
+		return get_branch_literal(sat_state);
+	return best->phase ? best->pos_lit : best->neg_lit;
+}
+
+//Gets the clause over the opposites of the decisions made on variables of the projection
+//Its assertion level is the level of the last but one of those decisions (the start level if there is one)
+//@param sat_state: the SatState holding a model
+//@return the clause, NULL if no variable of the projection was decided
+Clause* get_blocking_clause(SatState* sat_state)
+{
+	int dec_level = 1;		//Level of the last but one decision on the projection
+
+	//Decisions on the projection come before any other decision
+	//The opposite of the last decision comes first, as the literal the clause implies
+	litVector* lits = &sat_state->scratch_lits;
+	litVector_clear(lits);
+	for (decNode* dec = sat_state->decisions->head; dec != NULL && dec->node_dec->dec_lit != NULL; dec = dec->next)
+	{
+		Lit* dec_lit = dec->node_dec->dec_lit;
+		if (!sat_literal_var(dec_lit)->projected)
+			continue;
+		if (lits->size == 1)
+			dec_level = sat_literal_var(dec_lit)->decision_level;
+		litVector_push(lits, opp_lit(dec_lit));
+	}
+	if (lits->size == 0)
+		return NULL;
+
+	Clause* blocking = new_clause(lits->size, sat_state);
+	memcpy(blocking->literals, lits->items, blocking->num_lits * sizeof(Lit*));
+	blocking->dec_level = dec_level;
+	blocking->lbd = blocking->num_lits;
+	return blocking;
+}
+
+/******************************************************************************
+* Local search
 *
-* We require you to choose S as 1, then literals implied by (3) would have 1 as
-* their decision level (this level will also be the assertion level of unit
-* clauses)
+* ProbSAT over the clauses of the arena and the added clauses (learned clauses
+* are implied by them). It starts from the saved phases (and the literals set
+* at the start level, which stay fixed), repeatedly picks a falsified clause at
+* random and flips one of its variables, picked with a probability that falls
+* exponentially with the number of clauses the flip would falsify (its break
+* count). The best assignment found becomes the saved phases if it falsifies
+* fewer clauses than the starting one.
 *
-* Yet, the first decided literal must have 2 as its decision level
+* The clauses of the arena and their occurrences are read where they lie, and
+* only the added clauses are indexed again by each search.
 ******************************************************************************/
 
-//applies unit resolution to the cnf of sat state
-//returns 1 if unit resolution succeeds, 0 if it finds a contradiction
-BOOLEAN sat_unit_resolution(SatState* sat_state) {
-	//Clause for containing a contradiction if found
-	Clause* contradiction = NULL;
+//returns a local search over the clauses of sat state, with the arrays which only depend on its variables
+//(those depending on the added clauses are allocated by init_local_search())
+//@param sat_state: the SatState searched
+//@return the local search
+LocalSearch* new_local_search(SatState* sat_state)
+{
+	c2dSize num_vars = sat_state->num_vars;
+	LocalSearch* search = (LocalSearch*)malloc(sizeof(LocalSearch));
+	search->arena = sat_state->arena;
+	search->num_clauses = 0;
+	search->clause_capacity = 0;
+	search->num_added = 0;
+	search->added_starts = NULL;
+	search->added_lits = NULL;
+	search->added_occurs_starts = (c2dSize*)malloc((2 * num_vars + 2) * sizeof(c2dSize)) + num_vars;
+	search->added_occurs = NULL;
+	search->added_capacity = 0;
+	search->added_lits_capacity = 0;
+	search->fixed = (BOOLEAN*)malloc((num_vars + 1) * sizeof(BOOLEAN));
+	search->values = (BOOLEAN*)malloc((num_vars + 1) * sizeof(BOOLEAN));
+	search->best = (BOOLEAN*)malloc((num_vars + 1) * sizeof(BOOLEAN));
+	search->num_true = NULL;
+	search->unsat = NULL;
+	search->unsat_pos = NULL;
+
+	//ProbSAT's exponential break function: cb^-break
+	search->break_probs[0] = 1;
+	for (c2dSize b = 1; b <= maxBreak; b++)
+		search->break_probs[b] = search->break_probs[b - 1] / breakBase;
+	return search;
+}
+
+//Set up the added clauses, counts and assignment of a local search over the phases of sat state
+//The arrays only grow, so a search after the first allocates nothing unless clauses were added
+//@param search: the local search
+//@param sat_state: the SatState searched
+void init_local_search(LocalSearch* search, SatState* sat_state)
+{
+	const ClauseArena* arena = search->arena;
+	c2dSize num_vars = sat_state->num_vars;
+
+	//The added clauses are indexed on their own, numbered from 1
+	c2dSize num_added = sat_state->num_added, added_lits = 0;
+	for (clauseNode* trav = sat_state->addedClauses->head; trav != NULL; trav = trav->next)
+		added_lits += trav->node_clause->num_lits;
+	if (num_added + 2 > search->added_capacity) {
+		search->added_capacity = 2 * num_added + 2;
+		search->added_starts = (c2dSize*)realloc(search->added_starts, search->added_capacity * sizeof(c2dSize));
+	}
+	if (added_lits + 1 > search->added_lits_capacity) {
+		search->added_lits_capacity = 2 * added_lits + 1;
+		search->added_lits = (c2dLiteral*)realloc(search->added_lits, search->added_lits_capacity * sizeof(c2dLiteral));
+		search->added_occurs = (c2dSize*)realloc(search->added_occurs, search->added_lits_capacity * sizeof(c2dSize));
+	}
+	c2dSize c = 0, size = 0;
+	for (clauseNode* trav = sat_state->addedClauses->head; trav != NULL; trav = trav->next)
+	{
+		search->added_starts[++c] = size;
+		for (c2dSize i = 0; i < trav->node_clause->num_lits; i++)
+			search->added_lits[size++] = trav->node_clause->literals[i]->index;
+	}
+	search->added_starts[num_added + 1] = size;
+	search->num_added = num_added;
+	build_clause_occurrences(num_vars, num_added, search->added_starts, search->added_lits, search->added_occurs_starts, search->added_occurs, 1);
+
+	//The clauses of the arena are followed by the added clauses
+	search->num_clauses = arena->num_clauses + num_added;
+	if (search->num_clauses + 1 > search->clause_capacity) {
+		search->clause_capacity = search->num_clauses + num_added + 1;
+		search->num_true = (c2dSize*)realloc(search->num_true, search->clause_capacity * sizeof(c2dSize));
+		search->unsat = (c2dSize*)realloc(search->unsat, search->clause_capacity * sizeof(c2dSize));
+		search->unsat_pos = (c2dSize*)realloc(search->unsat_pos, search->clause_capacity * sizeof(c2dSize));
+	}
+
+	//Start from the literals set at the start level, which stay fixed, and the saved phases
+	for (c2dSize i = 1; i <= num_vars; i++)
+	{
+		Var* var = sat_state->vars[i];
+		search->fixed[i] = var->instantiated && var->decision_level <= 1;
+		search->values[i] = search->fixed[i] ? var->pos_lit->truth_value : var->phase;
+	}
+
+	search->num_unsat = 0;
+	for (c = 1; c <= search->num_clauses; c++)
+	{
+		c2dSize num_lits;
+		const c2dLiteral* lits = search_clause_literals(search, c, &num_lits);
+		search->num_true[c] = 0;
+		for (c2dSize i = 0; i < num_lits; i++)
+			if (search->values[labs(lits[i])] == (lits[i] > 0))
+				search->num_true[c]++;
+		if (search->num_true[c] == 0)
+		{
+			search->unsat_pos[c] = search->num_unsat;
+			search->unsat[search->num_unsat++] = c;
+		}
+	}
+	memcpy(search->best, search->values, (num_vars + 1) * sizeof(BOOLEAN));
+	search->best_unsat = search->num_unsat;
+}
+
+//Free a local search and its arrays
+//@param search: the local search
+//@param sat_state: the SatState searched
+void free_local_search(LocalSearch* search, SatState* sat_state)
+{
+	free(search->added_starts);
+	free(search->added_lits);
+	free(search->added_occurs_starts - sat_state->num_vars);
+	free(search->added_occurs);
+	free(search->fixed);
+	free(search->values);
+	free(search->best);
+	free(search->num_true);
+	free(search->unsat);
+	free(search->unsat_pos);
+	free(search);
+}
 
-	printf("\nstart unit resolution at decision_level = %d\n", sat_state->decision_level);
-	//Run a special unit resolution if no decision has been made
-	if (sat_state->decision_level == 1) {
-		printf("run initial unit resolution\n");
-		return initial_unit_resolution(sat_state);
+//returns the literals of a clause of a local search, and sets num_lits to their number
+//@param search: the local search
+//@param clause: the clause (those of the arena first, then the added ones)
+//@param num_lits: set to the number of literals of the clause
+//@return the indices of its literals
+const c2dLiteral* search_clause_literals(const LocalSearch* search, c2dSize clause, c2dSize* num_lits)
+{
+	const ClauseArena* arena = search->arena;
+	if (clause <= arena->num_clauses)
+	{
+		*num_lits = arena->starts[clause + 1] - arena->starts[clause];
+		return arena->lits + arena->starts[clause];
 	}
+	clause -= arena->num_clauses;
+	*num_lits = search->added_starts[clause + 1] - search->added_starts[clause];
+	return search->added_lits + search->added_starts[clause];
+}
 
-	//Create a litNode to traverse the decision's list of unit literals
-	Decision* decision = get_latest_decision(sat_state);
-	if(decision->units != NULL) {
-		dlitNode* trav = decision->units->head;
-		//While not at the end of the literal list
-		while (trav != NULL)
-		{	
-			//Set the literal and get a contradiction clause if one exists
-			contradiction = set_literal(trav->node_lit, sat_state);
+//Count the clauses only satisfied by the variable, which flipping it would falsify
+c2dSize break_count(LocalSearch* search, c2dSize var)
+{
+	const ClauseArena* arena = search->arena;
+	c2dLiteral true_lit = search->values[var] ? (c2dLiteral)var : -(c2dLiteral)var;
+	c2dSize count = 0;
+	for (c2dSize i = arena->occurs_starts[true_lit]; i < arena->occurs_starts[true_lit + 1]; i++)
+		if (search->num_true[arena->occurs[i]] == 1)
+			count++;
+	for (c2dSize i = search->added_occurs_starts[true_lit]; i < search->added_occurs_starts[true_lit + 1]; i++)
+		if (search->num_true[arena->num_clauses + search->added_occurs[i]] == 1)
+			count++;
+	return count;
+}
 
-			//Set the literal and return 0 if unit resolution returns a contradiction clause
-			if (contradiction != NULL)
-			{
-				printf("Found a contradiction clause:  %lu\n", contradiction->index);
-				//Get the assertion clause
-				sat_state->assertion_clause = get_assertion_clause(contradiction, sat_state);
-				return 0;
-			}
-			trav = trav->next;
-		}
+//Count one more true literal in a clause, which leaves the falsified clauses if it had none
+void satisfy_search_clause(LocalSearch* search, c2dSize clause)
+{
+	if (search->num_true[clause]++ == 0)
+	{
+		c2dSize moved = search->unsat[--search->num_unsat];
+		search->unsat[search->unsat_pos[clause]] = moved;
+		search->unsat_pos[moved] = search->unsat_pos[clause];
 	}
-	return 1;		//Resolution completed without returning a contradiction clause i.e. unit resolution succeeded
 }
 
-//Check all of the initial clauses in the CNF are unit, and perform unit resolution if they are
-//@param sat_state: the SatState to investigate
-//@return 0 if a contradiction is found, 1 otherwise
-BOOLEAN initial_unit_resolution(SatState* sat_state)
+//Count one less true literal in a clause, which joins the falsified clauses if it has none left
+void falsify_search_clause(LocalSearch* search, c2dSize clause)
 {
-	//Loop through each clause in the CNF
-	for (int i = 0; i < sat_state->num_clauses; i++)
+	if (--search->num_true[clause] == 0)
 	{
-		//If the clause has one free literal, perform unit resolution
-		if (sat_state->CNF[i].free_lits == 1)
-		{
-			//Check if a contradiction is found when setting the unit literal
-			if (set_literal(get_unit_lit(&sat_state->CNF[i]), sat_state) != NULL)
-				return 0;
-		}
+		search->unsat_pos[clause] = search->num_unsat;
+		search->unsat[search->num_unsat++] = clause;
 	}
+}
 
-	//Node for traversing learned clauses
-	clauseNode* trav = sat_state->learnedClauses->head;
+//Flip a variable, updating the counts and the falsified clauses
+void flip_var(LocalSearch* search, c2dSize var)
+{
+	const ClauseArena* arena = search->arena;
+	c2dLiteral old_lit = search->values[var] ? (c2dLiteral)var : -(c2dLiteral)var;
+	search->values[var] = !search->values[var];
+
+	//Clauses of the literal made true
+	for (c2dSize i = arena->occurs_starts[-old_lit]; i < arena->occurs_starts[-old_lit + 1]; i++)
+		satisfy_search_clause(search, arena->occurs[i]);
+	for (c2dSize i = search->added_occurs_starts[-old_lit]; i < search->added_occurs_starts[-old_lit + 1]; i++)
+		satisfy_search_clause(search, arena->num_clauses + search->added_occurs[i]);
+
+	//Clauses of the literal made false
+	for (c2dSize i = arena->occurs_starts[old_lit]; i < arena->occurs_starts[old_lit + 1]; i++)
+		falsify_search_clause(search, arena->occurs[i]);
+	for (c2dSize i = search->added_occurs_starts[old_lit]; i < search->added_occurs_starts[old_lit + 1]; i++)
+		falsify_search_clause(search, arena->num_clauses + search->added_occurs[i]);
+}
 
-	//Loop through all learned clauses
-	while (trav != NULL)
+//runs local search for at most the given number of flips, starting from the saved phases
+//(and the literals set at the start level), and saves the best assignment found as the phases
+//if it falsifies fewer clauses than the starting one
+//returns the number of clauses the best assignment falsifies (0 if it satisfies the cnf)
+c2dSize sat_local_search(c2dSize max_flips, SatState* sat_state) {
+	if (sat_state->local_search == NULL)
+		sat_state->local_search = new_local_search(sat_state);
+	LocalSearch* search = sat_state->local_search;
+	init_local_search(search, sat_state);
+	c2dSize start_unsat = search->num_unsat;
+
+	//Local search is random even when decisions are not
+	unsigned long saved_random = sat_state->random_state;
+	if (saved_random == 0)
+		sat_state->random_state = 1;
+
+	double probs[maxSlsClause];
+	c2dSize candidates[maxSlsClause];
+	for (c2dSize flips = 0; flips < max_flips && search->num_unsat > 0; flips++)
 	{
-		//If the clause has one free literal, perform unit resolution
-		if (trav->node_clause->free_lits == 1)
+		c2dSize c = search->unsat[next_random(sat_state) % search->num_unsat];
+		c2dSize num_lits;
+		const c2dLiteral* lits = search_clause_literals(search, c, &num_lits);
+		if (num_lits > maxSlsClause)
+			num_lits = maxSlsClause;
+
+		//Pick a variable of the clause which is not fixed, with a probability that falls with its break count
+		double sum = 0;
+		c2dSize num_candidates = 0;
+		for (c2dSize i = 0; i < num_lits; i++)
 		{
-			//Check if a contradiction is found when setting the unit literal
-			if (set_literal(get_unit_lit(trav->node_clause), sat_state) != NULL)
-				return 0;
+			c2dSize var = labs(lits[i]);
+			if (search->fixed[var])
+				continue;
+			c2dSize b = break_count(search, var);
+			candidates[num_candidates] = var;
+			probs[num_candidates] = search->break_probs[b < maxBreak ? b : maxBreak];
+			sum += probs[num_candidates++];
+		}
+		if (num_candidates == 0)
+			continue;
+		double pick = (next_random(sat_state) % 1000000) / 1000000.0 * sum;
+		c2dSize i = 0;
+		while (i + 1 < num_candidates && pick >= probs[i])
+			pick -= probs[i++];
+		flip_var(search, candidates[i]);
 
+		if (search->num_unsat < search->best_unsat)
+		{
+			search->best_unsat = search->num_unsat;
+			memcpy(search->best, search->values, (sat_state->num_vars + 1) * sizeof(BOOLEAN));
 		}
-		trav = trav->next;
 	}
-	return 1;
-}
 
-//undoes sat_unit_resolution(), leading to un-instantiating variables that have been instantiated
-//after sat_unit_resolution()
-void sat_undo_unit_resolution(SatState* sat_state) {
-	printf("undoing unit resolution\n");
-	//Clear the assertion clause
-	sat_state->assertion_clause = NULL;
+	if (saved_random == 0)
+		sat_state->random_state = 0;
 
-	//Special case if at decision level 1
-	if (sat_state->decision_level == 1)
+	//The best assignment found leads the next decisions
+	if (search->best_unsat < start_unsat)
 	{
-		undo_all_resolution(sat_state);
-		return;
+		for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+			sat_state->vars[i]->phase = search->best[i];
 	}
-	
-	//Create a litNode to traverse the decision's list of unit literals
-	dlitNode* trav = get_latest_decision(sat_state)->units->tail;
+	return search->best_unsat;
+}
 
-	//While not at the end of the literal list
-	while (trav != NULL)
+/******************************************************************************
+* Scenarios
+*
+* Unit resolution is run over 64 scenarios at once, bit s of a mask standing
+* for scenario s. A clause is falsified in the scenarios where all its literals
+* are false, and unit in those where exactly one of them is not false and none
+* is true: a visit of the clause finds both with a few word operations per
+* literal, whatever the number of scenarios it changes. Scenarios in which a
+* contradiction was found imply nothing more.
+******************************************************************************/
+
+//Make a literal true in more scenarios, and queue it so the clauses of its opposite get visited
+//@param lit: the literal
+//@param scenarios: the scenarios in which it is true (those it was already true in included)
+//@param propagation: the unit resolution over the scenarios
+void add_scenarios(Lit* lit, c2dScenarios scenarios, ScenarioPropagation* propagation)
+{
+	c2dScenarios* masks = propagation->masks;
+	if ((scenarios & ~masks[lit->index]) == 0)
+		return;
+
+	masks[lit->index] |= scenarios;
+	propagation->conflicts |= masks[lit->index] & masks[-lit->index];
+	if (!propagation->queued[lit->index])
 	{
-		//Undo the unit resolution on the current literal
-		undo_set_literal((Lit*)trav->node_lit, sat_state);
-		
-		//Go to the next unit to undo resolution on
-		trav = trav->prev;
+		propagation->queued[lit->index] = 1;
+		propagation->queue[(propagation->head + propagation->num_queued++) % propagation->capacity] = lit;
 	}
 }
 
-//Undoes resolution at decision level 0 (i.e. before a decision is made)
-//@param sat_state: the SatState to undo resolution on
-void undo_all_resolution(SatState* sat_state)
+//Find the scenarios in which a clause is falsified, and those in which it is unit (whose free literal is made true)
+//@param clause: the clause visited
+//@param propagation: the unit resolution over the scenarios
+void propagate_clause_scenarios(const Clause* clause, ScenarioPropagation* propagation)
 {
-	//Loop through all clauses
-	for (int i = 0; i < sat_state->num_clauses; i++)
+	c2dScenarios* masks = propagation->masks;
+	c2dScenarios satisfied = 0, one_not_false = 0, two_not_false = 0;
+	for (c2dSize i = 0; i < clause->num_lits; i++)
 	{
-		//If the clause contains 1 literal, undo the setting of that literal
-		if (sat_state->CNF[i].num_lits == 1)
-			undo_set_literal(sat_state->CNF[i].literals[0], sat_state);
+		c2dScenarios not_false = ~masks[-clause->literals[i]->index];
+		satisfied |= masks[clause->literals[i]->index];
+		two_not_false |= one_not_false & not_false;
+		one_not_false |= not_false;
 	}
 
-	//Node for traversing learned clauses
-	clauseNode* trav = sat_state->learnedClauses->head;
+	propagation->conflicts |= ~one_not_false;
+	c2dScenarios units = one_not_false & ~two_not_false & ~satisfied & ~propagation->conflicts;
+	for (c2dSize i = 0; units != 0 && i < clause->num_lits; i++)
+		add_scenarios(clause->literals[i], units & ~masks[-clause->literals[i]->index], propagation);
+}
 
-	//Loop through all learned clauses
-	while (trav != NULL)
+//runs unit resolution over up to 64 scenarios at once: scenario s assumes true the variables whose
+//bit s is set in true_masks, and false those whose bit s is set in false_masks (both indexed 1 to n),
+//on top of the literals currently set (which hold in every scenario)
+//the masks are extended in place with the literals unit resolution implies in each scenario
+//returns the scenarios in which unit resolution finds a contradiction (their bits in the masks are then meaningless)
+//
+//the sat state is left as it was, and the literals implied are those which deciding the
+//assumptions of a scenario one after the other would imply
+c2dScenarios sat_propagate_scenarios(c2dScenarios* true_masks, c2dScenarios* false_masks, SatState* sat_state) {
+	c2dSize num_vars = sat_state->num_vars;
+	ScenarioPropagation propagation;
+	propagation.masks = (c2dScenarios*)calloc(2 * num_vars + 1, sizeof(c2dScenarios)) + num_vars;
+	propagation.capacity = 2 * num_vars + 1;
+	propagation.queue = (Lit**)malloc(propagation.capacity * sizeof(Lit*));
+	propagation.head = propagation.num_queued = 0;
+	propagation.queued = (BOOLEAN*)calloc(2 * num_vars + 1, sizeof(BOOLEAN)) + num_vars;
+	propagation.conflicts = 0;
+
+	for (c2dSize i = 1; i <= num_vars; i++)
 	{
-		//If the clause contains 1 literal, undo the setting of that literal
-		if (trav->node_clause->num_lits == 1)
-			undo_set_literal(trav->node_clause->literals[0], sat_state);
-		trav = trav->next;
+		Var* var = sat_state->vars[i];
+		if (var->instantiated)
+			add_scenarios(var->pos_lit->truth_value == 1 ? var->pos_lit : var->neg_lit, ~(c2dScenarios)0, &propagation);
+		add_scenarios(var->pos_lit, true_masks[i], &propagation);
+		add_scenarios(var->neg_lit, false_masks[i], &propagation);
 	}
-}
-
-//Free the decision and all its underlying pointers
-//@param undo_dec: decision to free
-void free_decision(Decision* undo_dec)
-{
-	//Literal that stores which unit literal is currently being inspected
-	Lit* free_lit;
 
-	//Free the units list and all literal information in each literal that became unit based on this decision
-	while (undo_dec->units->head != NULL)
+	//Clauses are visited until no literal is true in more scenarios, or every scenario has a contradiction
+	while (propagation.num_queued > 0 && propagation.conflicts != ~(c2dScenarios)0)
 	{
-		free_lit = dlitList_pop(undo_dec->units);
-		free_lit->unit_on = NULL;
-		free_lit->in_contradiction_clause = 0;
+		Lit* lit = propagation.queue[propagation.head];
+		propagation.head = (propagation.head + 1) % propagation.capacity;
+		propagation.num_queued--;
+		propagation.queued[lit->index] = 0;
+
+		Lit* opposite = opp_lit(lit);
+		for (c2dSize i = 0; i < opposite->num_clauses; i++)
+			propagate_clause_scenarios(opposite->clauses[i], &propagation);
+		for (c2dSize i = 0; i < opposite->num_learned; i++)
+			propagate_clause_scenarios(opposite->learnedClauses[i], &propagation);
+	}
 
-		while (free_lit->unit_children->head != NULL)
-			litList_pop(free_lit->unit_children);
+	for (c2dSize i = 1; i <= num_vars; i++)
+	{
+		true_masks[i] = propagation.masks[i];
+		false_masks[i] = propagation.masks[-(c2dLiteral)i];
 	}
+	free(propagation.masks - num_vars);
+	free(propagation.queue);
+	free(propagation.queued - num_vars);
+	return propagation.conflicts;
+}
 
-	//Free the implication graph list
-	while (undo_dec->implication_graph->head != NULL)
-		dlitList_pop(undo_dec->implication_graph);
+/******************************************************************************
+* Snapshots
+*
+* A snapshot holds the arrays of an arena as they lie in memory, so loading one
+* is mapping the file and checking its checksum. It also holds the occurrences
+* of each literal, which are built by two counting passes when it is written.
+******************************************************************************/
 
-	//Free the decision itself
-	free(undo_dec);
-}
+//writes the cnf of sat state to a snapshot file; if simplify is 1, the clauses are first simplified
+//by unit resolution at the start level (subsumed clauses and false literals are left out, while
+//each literal implied is written as a unit clause), which keeps the models of the cnf
+//it must be called at the start level
+//returns 1 if the snapshot was written, 0 otherwise
+BOOLEAN sat_snapshot_save(const char* file_name, BOOLEAN simplify, SatState* sat_state) {
+	ClauseArena* arena = sat_state->arena;
+	if (sat_state->decision_level != 1)
+		return 0;
 
+	//A contradiction found by unit resolution is left to the solver
+	if (!simplify || !sat_unit_resolution(sat_state))
+	{
+		if (simplify)
+			sat_undo_unit_resolution(sat_state);
+		return write_snapshot(file_name, arena->num_vars, arena->num_clauses, arena->starts, arena->lits, arena->occurs_starts, arena->occurs);
+	}
 
-//returns 1 if the decision level of the sat state equals to the assertion level of clause,
-//0 otherwise
-//
-//this function is called after sat_decide_literal() or sat_assert_clause() returns clause.
-//it is used to decide whether the sat state is at the right decision level for adding clause.
-BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state) {
-	if (clause->dec_level == sat_state->decision_level)
-		return 1;
-	return 0;
-}
+	c2dSize* starts = (c2dSize*)malloc((arena->num_clauses + arena->num_vars + 2) * sizeof(c2dSize));
+	c2dLiteral* lits = (c2dLiteral*)malloc((arena->starts[arena->num_clauses + 1] + arena->num_vars + 1) * sizeof(c2dLiteral));
+	c2dSize num_clauses = 0;
+	c2dSize size = 0;
 
-// Returns the latest decision made in the current SatState
-Decision* get_latest_decision(SatState* sat_state) {
-	if(sat_state == NULL)
-		return NULL;
-	else if(sat_state->decisions->head == NULL)
-		return NULL;
-	else {
-		return sat_state->decisions->head->node_dec;
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+	{
+		Var* var = sat_state->vars[i];
+		if (var->instantiated == 0)
+			continue;
+		starts[++num_clauses] = size;
+		lits[size++] = var->pos_lit->truth_value == 1 ? var->pos_lit->index : var->neg_lit->index;
+	}
+	for (c2dSize i = 1; i <= sat_state->num_clauses; i++)
+	{
+		Clause* clause = sat_index2clause(i, sat_state);
+		if (clause->subsumed)
+			continue;
+		starts[++num_clauses] = size;
+		for (c2dSize j = 0; j < clause->num_lits; j++)
+			if (clause->literals[j]->truth_value != 0)
+				lits[size++] = clause->literals[j]->index;
 	}
+	starts[num_clauses + 1] = size;
+	sat_undo_unit_resolution(sat_state);
+
+	BOOLEAN written = write_snapshot(file_name, arena->num_vars, num_clauses, starts, lits, NULL, NULL);
+	free(starts);
+	free(lits);
+	return written;
 }
 
-void debug_print_clauses(SatState* sat_state) {
-	/************* DEBUG PRINTOUTS ********************/
-	printf("Clauses at decision level %d:\n", sat_state->decision_level);
-	for(c2dSize i = 1; i <= sat_state->num_clauses; i++) {
-		Clause* clause = sat_index2clause(i, sat_state);
-		printf("Clause %2lu has %2d free lits. Subsumed = %d\n", clause->index, clause->free_lits, clause->subsumed);
-		for(c2dSize j = 0; j < clause->num_lits; j++) {
-			printf("%ld ", clause->literals[j]->index);
-		}
-		printf("\n");
+//Write clauses, and the occurrences of their literals, to a snapshot file
+//@param file_name: the snapshot file
+//@param num_vars: the number of variables
+//@param num_clauses: the number of clauses
+//@param starts: the position in lits of the first literal of each clause (1 indexed, starts[num_clauses + 1] is the end)
+//@param lits: the literals of all the clauses, one clause after the other
+//@param index_starts: the position in index of the first clause of each literal (indices -n to n+1), NULL to build the index
+//@param index: the clauses containing each literal, one literal after the other (NULL to build it)
+//@return 1 if the snapshot was written, 0 otherwise
+BOOLEAN write_snapshot(const char* file_name, c2dSize num_vars, c2dSize num_clauses, const c2dSize* starts, const c2dLiteral* lits, const c2dSize* index_starts, const c2dSize* index)
+{
+	c2dSize num_lits = starts[num_clauses + 1];
+	c2dSize* built_starts = NULL;
+	c2dSize* built = NULL;
+	if (index == NULL) {
+		built_starts = (c2dSize*)malloc((2 * num_vars + 2) * sizeof(c2dSize)) + num_vars;
+		built = (c2dSize*)malloc((num_lits + 1) * sizeof(c2dSize));
+		build_clause_occurrences(num_vars, num_clauses, starts, lits, built_starts, built, num_worker_threads());
+		index_starts = built_starts;
+		index = built;
+	}
+	const c2dSize* occurs_starts = index_starts - num_vars;
+	const c2dSize* occurs = index;
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+	header.version = snapshotVersion;
+	header.num_vars = num_vars;
+	header.num_clauses = num_clauses;
+	header.num_lits = num_lits;
+
+	//The entry before the first clause is not used
+	c2dSize first = 0;
+	header.checksum = hash_words(0, &first, 1);
+	header.checksum = hash_words(header.checksum, starts + 1, num_clauses + 1);
+	header.checksum = hash_words(header.checksum, lits, num_lits);
+	header.checksum = hash_words(header.checksum, occurs_starts, 2 * num_vars + 2);
+	header.checksum = hash_words(header.checksum, occurs, num_lits);
+
+	FILE* file = fopen(file_name, "wb");
+	BOOLEAN written = file != NULL
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(&first, sizeof(c2dSize), 1, file) == 1
+		&& fwrite(starts + 1, sizeof(c2dSize), num_clauses + 1, file) == num_clauses + 1
+		&& fwrite(lits, sizeof(c2dLiteral), num_lits, file) == num_lits
+		&& fwrite(occurs_starts, sizeof(c2dSize), 2 * num_vars + 2, file) == 2 * num_vars + 2
+		&& fwrite(occurs, sizeof(c2dSize), num_lits, file) == num_lits;
+	if (file != NULL && fclose(file) != 0)
+		written = 0;
+
+	if (built != NULL) {
+		free(built_starts - num_vars);
+		free(built);
 	}
+	return written;
 }
 
-//Gets the uip
-//@param contradiction: the contradiction clause found at the current level
-//@param sat_state: the SatState to search
-//@return the shared literal/uip of the implication graph
-Lit* sat_get_uip(Clause* contradiction, SatState* sat_state)
+//Fold 8 byte words into a hash, used as the checksum of snapshots (FNV-1a over words rather than bytes)
+//The high bits of the hash are the best mixed
+//@param hash: the hash of the words before (0 for none)
+//@param words: the words
+//@param num_words: the number of words
+//@return the hash of all the words
+unsigned long hash_words(unsigned long hash, const void* words, c2dSize num_words)
 {
-	//Get list of literals at this decision level on the path to the contradiction clause
-	find_uip_lits(contradiction, sat_state);
+	const unsigned long* word = (const unsigned long*)words;
+	if (hash == 0)
+		hash = 14695981039346656037UL;
+	for (c2dSize i = 0; i < num_words; i++)
+		hash = (hash ^ word[i]) * 1099511628211UL;
+	return hash;
+}
 
-	//If there is only one literal at  this decision level in the contradiction clause, then it is the contradiction literal
-	if (sat_state->decisions->head->node_dec->contradiction_lits == 1)
-		return sat_state->decisions->head->node_dec->implication_graph->head->node_lit;
+/******************************************************************************
+* Proofs
+*
+* Each record is the letter 'a' (addition) or 'd' (deletion) followed by the
+* literals of a clause and a 0. A literal l is written as 2l if positive and
+* -2l + 1 if negative, 7 bits per byte from the lowest ones, with the top bit of
+* each byte set when more bytes follow.
+*
+* Clauses added with sat_add_clause() are not implied by the cnf and are not
+* written, so the proof of a sat state with added clauses will not check.
+* Neither are the clauses blocking the models found by sat_enumerate_models(),
+* nor the clauses learned from them, so models are not enumerated while a
+* proof is open.
+******************************************************************************/
 
-	//Node for traveling the implication graph literals in reverse order
-	dlitNode* trav = sat_state->decisions->head->node_dec->implication_graph->head;
+//starts writing a binary DRAT proof to a file, piped through gzip, xz or bzip2 if the file
+//name ends with .gz, .xz or .bz2; every clause asserted from then on is added to the proof,
+//and so is the empty clause once a contradiction is found at the start level
+//returns 1 if the file could be opened, 0 otherwise
+BOOLEAN sat_proof_open(const char* file_name, SatState* sat_state) {
+	if (sat_state->proof != NULL)
+		sat_proof_close(sat_state);
+
+	BOOLEAN piped;
+	FILE* file = open_compressed(file_name, 1, &piped);
+	if (file == NULL)
+		return 0;
 
-	//Counter to track which literal is being inspected (for skipping the literals in the contradiction clause)
-	int lit_counter = 0;
+	Proof* proof = (Proof*)malloc(sizeof(Proof));
+	proof->file = file;
+	proof->piped = piped;
+	proof->failed = 0;
+	proof->closing = 0;
+	proof->buffers[0] = (unsigned char*)malloc(proofBufferSize);
+	proof->buffers[1] = (unsigned char*)malloc(proofBufferSize);
+	proof->filling = 0;
+	proof->used = 0;
+	proof->pending = 0;
+	pthread_mutex_init(&proof->lock, NULL);
+	pthread_cond_init(&proof->cond, NULL);
+	pthread_create(&proof->writer, NULL, write_proof, proof);
+
+	sat_state->proof = proof;
+	return 1;
+}
 
-	//For each literal in the implication graph until the decision literal is reached (reverse order)
-	while (trav->node_lit != sat_state->decisions->head->node_dec->dec_lit)
-	{
-		//No need to inspect the literals in the contradiction clause since there is more than 1 (cannot be the uip)
-		if (lit_counter >= sat_state->decisions->head->node_dec->contradiction_lits)
-		{
-			//Flag the literal to be ignored by DFS
-			trav->node_lit->DFS_ignore = 1;
+//writes what is left of the proof and closes its file
+//returns 1 if all of the proof was written, 0 otherwise (and if no proof was being written)
+BOOLEAN sat_proof_close(SatState* sat_state) {
+	Proof* proof = sat_state->proof;
+	if (proof == NULL)
+		return 0;
+	sat_state->proof = NULL;
+
+	swap_proof_buffers(proof);
+	pthread_mutex_lock(&proof->lock);
+	proof->closing = 1;
+	pthread_cond_broadcast(&proof->cond);
+	pthread_mutex_unlock(&proof->lock);
+	pthread_join(proof->writer, NULL);
+
+	BOOLEAN written = !proof->failed;
+	if ((proof->piped ? pclose(proof->file) : fclose(proof->file)) != 0)
+		written = 0;
+
+	pthread_mutex_destroy(&proof->lock);
+	pthread_cond_destroy(&proof->cond);
+	free(proof->buffers[0]);
+	free(proof->buffers[1]);
+	free(proof);
+	return written;
+}
 
-			//If the DFS cannot reach the contradiction clause, this is the uip
-			if (uip_DFS(sat_state) == 0)
-				return trav->node_lit;
+//Write the records of the buffer handed over by the solving thread, until the proof is closed
+//@param data: the Proof
+//@return NULL
+void* write_proof(void* data)
+{
+	Proof* proof = (Proof*)data;
 
-			//Remove the DFS flag
-			trav->node_lit->DFS_ignore = 0;
-		}
+	pthread_mutex_lock(&proof->lock);
+	while (1)
+	{
+		while (proof->pending == 0 && !proof->closing)
+			pthread_cond_wait(&proof->cond, &proof->lock);
+		if (proof->pending == 0)
+			break;
 
-		//Move to the next literal
-		trav = trav->next;
-		lit_counter++;
+		//The solving thread does not touch the buffer until pending goes back to 0
+		size_t size = proof->pending;
+		unsigned char* buffer = proof->buffers[1 - proof->filling];
+		pthread_mutex_unlock(&proof->lock);
+		if (fwrite(buffer, 1, size, proof->file) != size)
+			proof->failed = 1;
+		pthread_mutex_lock(&proof->lock);
+
+		proof->pending = 0;
+		pthread_cond_broadcast(&proof->cond);
 	}
+	pthread_mutex_unlock(&proof->lock);
+	return NULL;
+}
 
-	//The decision literal has been reached, it must be the implcation literal
-	return sat_state->decisions->head->node_dec->dec_lit;
+//Hand the buffer being filled over to the writer, once it wrote the other one
+//@param proof: the Proof
+void swap_proof_buffers(Proof* proof)
+{
+	pthread_mutex_lock(&proof->lock);
+	while (proof->pending != 0)
+		pthread_cond_wait(&proof->cond, &proof->lock);
+	proof->filling = 1 - proof->filling;
+	proof->pending = proof->used;
+	proof->used = 0;
+	pthread_cond_broadcast(&proof->cond);
+	pthread_mutex_unlock(&proof->lock);
 }
 
-//Gets a queue of literals leading to the contradiciton clause in reverse order
-//@param contradiction: the contradiction clause found at the current level
-//@param sat_state: the SatState to search
-void find_uip_lits(Clause* contradiction, SatState* sat_state)
+//Add a byte to the buffer being filled
+//@param byte: the byte
+//@param proof: the Proof
+void proof_byte(unsigned char byte, Proof* proof)
 {
-	dlitNode* curr;			//Literal currently being inspected
-	sat_state->decisions->head->node_dec->contradiction_lits = 0;	//Reset the number of literals at this decision level in the contradiction clause
+	if (proof->used == proofBufferSize)
+		swap_proof_buffers(proof);
+	proof->buffers[proof->filling][proof->used++] = byte;
+}
 
-	//Check each literal in the contradiction clause
-	for (int i = 0; i < contradiction->num_lits; i++)
+//Add a record to a proof
+//@param clause: the clause added or deleted
+//@param record: 'a' to add the clause, 'd' to delete it
+//@param proof: the Proof
+void proof_clause(const Clause* clause, unsigned char record, Proof* proof)
+{
+	proof_byte(record, proof);
+	for (c2dSize i = 0; i < clause->num_lits; i++)
 	{
-		//If the literal is at the current decision level, add it to the list of literals to inspect
-		if (sat_literal_var(contradiction->literals[i])->decision_level == sat_state->decision_level)
+		c2dLiteral index = clause->literals[i]->index;
+		unsigned long code = index > 0 ? 2 * (unsigned long)index : 2 * (unsigned long)(-index) + 1;
+		while (code > 127)
 		{
-			//Add the literal to the list of literals to inspect
-			dlitList_push_back(sat_state->decisions->head->node_dec->implication_graph, contradiction->literals[i]);
-
-			//This literal is in the contradiction clause, mark it as such
-			contradiction->literals[i]->in_contradiction_clause = 1;
-
-			//Increment the number of literals at this decision level in the contradiction clause
-			sat_state->decisions->head->node_dec->contradiction_lits++;
+			proof_byte(128 | (code & 127), proof);
+			code >>= 7;
 		}
+		proof_byte(code, proof);
 	}
+	proof_byte(0, proof);
+}
+
+/******************************************************************************
+* Tracing
+*
+* Recording an event is a write into the ring buffer, so tracing can stay on
+* while solving large cnfs. A saved trace is a TraceHeader followed by its
+* events as they lie in memory, which sat_trace_decode() (and the trace_decode
+* tool of the solver) renders as text.
+******************************************************************************/
 
-	//Get the first literal to inspect
-	curr = sat_state->decisions->head->node_dec->implication_graph->head;
+//starts recording the events of the search of sat state in a ring buffer which keeps the last
+//num_events of them (rounded up to a power of 2), dropping the events recorded so far
+//returns 1 if tracing started, 0 if the library was built without it (SAT_TRACE_LEVEL 0)
+BOOLEAN sat_trace_start(c2dSize num_events, SatState* sat_state) {
+	if (SAT_TRACE_LEVEL == 0)
+		return 0;
+	sat_trace_stop(sat_state);
+
+	Trace* trace = (Trace*)malloc(sizeof(Trace));
+	trace->capacity = 1;
+	while (trace->capacity < num_events)
+		trace->capacity *= 2;
+	trace->events = (TraceEvent*)malloc(trace->capacity * sizeof(TraceEvent));
+	trace->num_recorded = 0;
+	sat_state->trace = trace;
+	return 1;
+}
+
+//stops recording events and frees the ring buffer
+void sat_trace_stop(SatState* sat_state) {
+	if (sat_state->trace == NULL)
+		return;
+	free(sat_state->trace->events);
+	free(sat_state->trace);
+	sat_state->trace = NULL;
+}
+
+//returns the number of events recorded since tracing started (the ring buffer keeps the last ones)
+c2dSize sat_trace_count(const SatState* sat_state) {
+	return sat_state->trace == NULL ? 0 : sat_state->trace->num_recorded;
+}
 
-	//Repeat until all literals that lead to the contradiction clause at its decision level have been inspected
-	while (curr != NULL)
+//writes the events held by the ring buffer to a file (in binary, see sat_trace_decode())
+//returns 1 if the file was written, 0 otherwise (and if no events are being recorded)
+BOOLEAN sat_trace_save(const char* file_name, const SatState* sat_state) {
+	Trace* trace = sat_state->trace;
+	if (trace == NULL)
+		return 0;
+
+	TraceHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, traceMagic, sizeof(traceMagic));
+	header.version = traceVersion;
+	header.num_recorded = trace->num_recorded;
+	header.num_events = trace->num_recorded < trace->capacity ? trace->num_recorded : trace->capacity;
+	header.level = SAT_TRACE_LEVEL;
+
+	//The oldest event kept lies right after the newest one once the buffer wrapped around
+	c2dSize first = (trace->num_recorded - header.num_events) % trace->capacity;
+	c2dSize num_before_end = trace->capacity - first < header.num_events ? trace->capacity - first : header.num_events;
+
+	FILE* file = fopen(file_name, "wb");
+	BOOLEAN written = file != NULL
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(trace->events + first, sizeof(TraceEvent), num_before_end, file) == num_before_end
+		&& fwrite(trace->events, sizeof(TraceEvent), header.num_events - num_before_end, file) == header.num_events - num_before_end;
+	if (file != NULL && fclose(file) != 0)
+		written = 0;
+	return written;
+}
+
+//renders the events of a file written by sat_trace_save() as text, one event per line
+//returns 1 if the file was a trace and was read in full, 0 otherwise
+BOOLEAN sat_trace_decode(const char* file_name, FILE* out) {
+	FILE* file = fopen(file_name, "rb");
+	if (file == NULL)
+		return 0;
+
+	TraceHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, traceMagic, sizeof(traceMagic)) != 0 || header.version != traceVersion)
 	{
-		//Check every literal in the clause that led to the unit resolution of the currently inspected literal
-		for (int i = 0; i < curr->node_lit->unit_on->num_lits; i++)
-		{
-			//Add the literal to the list of literals to inspect if it is at this decision level
-			if (sat_literal_var(curr->node_lit->unit_on->literals[i])->decision_level == sat_state->decision_level)
-				dlitList_push_back(sat_state->decisions->head->node_dec->implication_graph, curr->node_lit->unit_on->literals[i]);
+		fclose(file);
+		return 0;
+	}
+	fprintf(out, "c %lu of %lu events (trace level %lu)\n", header.num_events, header.num_recorded, header.level);
+
+	TraceEvent event;
+	c2dSize i;
+	for (i = 0; i < header.num_events && fread(&event, sizeof(event), 1, file) == 1; i++)
+	{
+		fprintf(out, "%lu ", header.num_recorded - header.num_events + i + 1);
+		switch (event.type) {
+		case traceDecide: fprintf(out, "decide %ld", event.lit); break;
+		case traceImply: fprintf(out, "imply %ld clause %lu", event.lit, event.data); break;
+		case traceConflict: fprintf(out, "conflict clause %lu", event.data); break;
+		case traceLearn: fprintf(out, "learn %ld size %lu", event.lit, event.data); break;
+		case traceBackjump: fprintf(out, "backjump assert %ld clause %lu", event.lit, event.data); break;
+		case traceRestart: fprintf(out, "restart"); break;
+		default: fprintf(out, "unknown %d", event.type); break;
 		}
-		curr = curr->next;
+		fprintf(out, " level %d\n", event.level);
 	}
+	fclose(file);
+	return i == header.num_events;
 }
 
-//Perform DFS from the decision literal to the contradiciton clause
-//@param sat_state: the SatState to search
-//@return false if the contradiction clause could not be reached
-BOOLEAN uip_DFS(SatState* sat_state)
+//Add an event to the ring buffer of a sat state being traced (see TRACE_EVENT())
+//@param type: the kind of event
+//@param lit: the literal of the event (0 if it has none)
+//@param data: the clause, size or level of the event (0 if it has none)
+//@param sat_state: the SatState being traced
+void record_trace_event(int type, c2dLiteral lit, c2dSize data, SatState* sat_state)
 {
-	//Create a DFS stack and add the first decision literal to it
-	litList* stack_DFS = (litList*)malloc(sizeof(litList));
-	litList_push(stack_DFS, sat_state->decisions->head->node_dec->dec_lit);
+	Trace* trace = sat_state->trace;
+	TraceEvent* event = &trace->events[trace->num_recorded++ & (trace->capacity - 1)];
+	event->lit = lit;
+	event->data = data;
+	event->level = sat_state->decision_level;
+	event->type = type;
+}
 
-	//Literal to check whether or not is in the contradiction clause
-	Lit* in_cc;
+/******************************************************************************
+* Regions
+*
+* A block of a megabyte or more gets a mapping of its own: twice its size, rounded
+* up to huge pages, aligned on a huge page and advised to be backed by huge pages.
+* A page nothing can access follows it, so the kernel never merges two mappings and
+* the huge pages of each one can be told apart in /proc/self/smaps. The block grows
+* within its mapping by touching more of it, and is moved to a new mapping once it
+* outgrows it. Smaller blocks are allocated by malloc, behind the same header.
+******************************************************************************/
 
-	//Repeat until the stack is empty
-	while (stack_DFS->head != NULL)
-	{
-		//Check the next literal
-		in_cc = litList_pop(stack_DFS);
+static Region regions[numRegions] = {
+	{ "clauses", 0, NULL },
+	{ "occurrences", 0, NULL },
+	{ "states", 0, NULL },
+	{ "cache", 0, NULL }
+};
+static pthread_mutex_t regions_lock = PTHREAD_MUTEX_INITIALIZER;		//Protects the regions
+
+//Map an aligned range of bytes backed by huge pages, with a page nothing can access after it
+//@param length: the number of bytes of the range (a multiple of hugePageSize)
+//@return the range, NULL if it could not be mapped
+void* map_huge_range(size_t length) {
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t mapped = length + hugePageSize + page;
+	char* range = (char*)mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (range == (char*)MAP_FAILED)
+		return NULL;
+	allocated_blocks++;
+
+	//The bytes before the first huge page boundary and after the guard page are given back
+	char* start = (char*)(((size_t)range + hugePageSize - 1) & ~(hugePageSize - 1));
+	if (start > range)
+		munmap(range, start - range);
+	if (range + mapped > start + length + page)
+		munmap(start + length + page, range + mapped - (start + length + page));
+	mprotect(start + length, page, PROT_NONE);
+#ifdef MADV_HUGEPAGE
+	madvise(start, length, MADV_HUGEPAGE);
+#endif
+	return start;
+}
 
-		//If the literal is in the contradiction clause, the contradiciton clause can be reached
-		if (in_cc->in_contradiction_clause == 1)
-			return 1;
+//allocates a block of a region, freed by sat_region_free(): blocks of a megabyte or more are
+//mapped on their own and backed by huge pages
+void* sat_region_alloc(size_t size, int region) {
+	RegionBlock* block = NULL;
+	size_t reserved = 0;
+	if (size >= hugeBlockSize) {
+		reserved = (2 * (size + regionHeaderSize) + hugePageSize - 1) / hugePageSize * hugePageSize;
+		block = (RegionBlock*)map_huge_range(reserved);
 	}
+	if (block == NULL) {
+		reserved = 0;
+		block = (RegionBlock*)malloc(regionHeaderSize + size);
+	}
+	block->size = size;
+	block->reserved = reserved;
+	block->region = region;
+	block->prev = NULL;
+
+	pthread_mutex_lock(&regions_lock);
+	regions[region].bytes += size;
+	block->next = reserved == 0 ? NULL : regions[region].mapped_blocks;
+	if (reserved != 0) {
+		if (block->next != NULL)
+			block->next->prev = block;
+		regions[region].mapped_blocks = block;
+	}
+	pthread_mutex_unlock(&regions_lock);
+	return (char*)block + regionHeaderSize;
+}
 
-	//Contradiction clause could not be reached (
-	return 0;
+//allocates a block of a region whose bytes are all 0, freed by sat_region_free() (the pages of a
+//block mapped on its own are only touched, and zeroed by the kernel, once they are used)
+void* sat_region_calloc(size_t size, int region) {
+	void* data = sat_region_alloc(size, region);
+	if (((RegionBlock*)((char*)data - regionHeaderSize))->reserved == 0)
+		memset(data, 0, size);
+	return data;
 }
 
-//Get the assertion clause
-//@param contradiction: the contradiction clause found at the current level
-//@param sat_state: the SatState to search
-//@return the assertion clause
-Clause* get_assertion_clause(Clause* contradiction, SatState* sat_state)
-{
-	//Create the assertion clause
-	Clause* assertion = (Clause*)malloc(sizeof(Clause));
+//resizes a block of a region (allocates one if block is NULL), in place if its mapping has room
+void* sat_region_realloc(void* data, size_t size, int region) {
+	if (data == NULL)
+		return sat_region_alloc(size, region);
+	RegionBlock* block = (RegionBlock*)((char*)data - regionHeaderSize);
+
+	//A mapped block grows into the rest of its mapping, and a small one is reallocated by malloc
+	if ((block->reserved != 0 && regionHeaderSize + size <= block->reserved) || (block->reserved == 0 && size < hugeBlockSize)) {
+		pthread_mutex_lock(&regions_lock);
+		regions[block->region].bytes += size - block->size;
+		pthread_mutex_unlock(&regions_lock);
+		if (block->reserved == 0)
+			block = (RegionBlock*)realloc(block, regionHeaderSize + size);
+		block->size = size;
+		return (char*)block + regionHeaderSize;
+	}
+
+	void* moved = sat_region_alloc(size, block->region);
+	memcpy(moved, data, size < block->size ? size : block->size);
+	sat_region_free(data);
+	return moved;
+}
 
-	//Initialize the clause
-	assertion->subsumed = 0;		
-	assertion->subsumed_on = NULL;
-	assertion->index = sat_state->num_learned;
+//frees a block allocated by sat_region_alloc() or sat_region_realloc() (nothing if block is NULL)
+void sat_region_free(void* data) {
+	if (data == NULL)
+		return;
+	RegionBlock* block = (RegionBlock*)((char*)data - regionHeaderSize);
+	Region* region = &regions[block->region];
+
+	pthread_mutex_lock(&regions_lock);
+	region->bytes -= block->size;
+	if (block->reserved != 0) {
+		if (block->prev != NULL)
+			block->prev->next = block->next;
+		else
+			region->mapped_blocks = block->next;
+		if (block->next != NULL)
+			block->next->prev = block->prev;
+	}
+	pthread_mutex_unlock(&regions_lock);
 
-	//List to store literals in assertion clause (clause has an array of literals, so this is temporary storage until size is found)
-	litList* temp_assert_lits = (litList*)malloc(sizeof(litList));
+	if (block->reserved != 0)
+		munmap(block, block->reserved + (size_t)sysconf(_SC_PAGESIZE));
+	else
+		free(block);
+}
 
-	//Number of literals in the assertion clause (for creating the array of literals in the assertion clause)
-	assertion->num_lits = 1;
+//returns the name of a region (see clauseRegion and the like), NULL if there is no such region
+const char* sat_region_name(int region) {
+	if (region < 0 || region >= numRegions)
+		return NULL;
+	return regions[region].name;
+}
 
-	/**NON-DECISION LEVEL LITERALS IN CONTRADICTION CLAUSE**/
-	//Add opposite of every non-decision literal in the contradiction clause to the assertion clause
-	for (int i = 0; i < contradiction->num_lits; i++)
-	{ 
-		//If the literal was not learned at this decision level add its opposite to the assertion clause
-		if (sat_literal_var(contradiction->literals[i])->decision_level != sat_state->decision_level)
-			litList_push(temp_assert_lits, opp_lit(contradiction->literals[i]));
+//returns the number of bytes asked for the blocks of a region, and stores in huge_bytes (if not NULL)
+//how many of the bytes mapped for them lie in huge pages
+c2dSize sat_region_usage(int region, c2dSize* huge_bytes) {
+	if (region < 0 || region >= numRegions)
+		return 0;
+	pthread_mutex_lock(&regions_lock);
+	c2dSize bytes = regions[region].bytes;
+
+	//Each mapping of the region is a range of its own in smaps, followed by its AnonHugePages line
+	if (huge_bytes != NULL) {
+		*huge_bytes = 0;
+		FILE* smaps = regions[region].mapped_blocks == NULL ? NULL : fopen("/proc/self/smaps", "r");
+		char line[256];
+		BOOLEAN inside = 0;
+		while (smaps != NULL && fgets(line, sizeof(line), smaps) != NULL) {
+			unsigned long start, end, kilobytes;
+			if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+				inside = 0;
+				for (RegionBlock* block = regions[region].mapped_blocks; block != NULL && !inside; block = block->next)
+					inside = start >= (unsigned long)block && end <= (unsigned long)block + block->reserved;
+			}
+			else if (inside && sscanf(line, "AnonHugePages: %lu kB", &kilobytes) == 1)
+				*huge_bytes += kilobytes * 1024;
+		}
+		if (smaps != NULL)
+			fclose(smaps);
 	}
+	pthread_mutex_unlock(&regions_lock);
+	return bytes;
+}
 
-	/**UIP**/
-	//Get the uip
-	Lit* uip = sat_get_uip(contradiction, sat_state);
+/******************************************************************************
+* Solver configuration
+******************************************************************************/
 
-	//Add opposite of uip to assertion clause
-	litList_push(temp_assert_lits,opp_lit(uip));
+//seeds the random generator used for decisions, and gives the activities a small random
+//start so that differently seeded states branch differently (0 turns randomness off)
+void sat_set_seed(unsigned long seed, SatState* sat_state) {
+	sat_state->random_state = seed;
+	if (seed == 0)
+		return;
+
+	//The start is small enough to be overtaken by the first contradiction
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+		sat_state->vars[i]->activity += (next_random(sat_state) % 1000) * 1e-6 * sat_state->var_inc;
+}
 
-	/**NON-DECISION LEVEL PARENTS OF UNIT CHILDREN OF UIP**/
-	//Node for traversing the list of unit children of uip
-	litNode* trav = uip->unit_children->head;
+//sets the fraction of decisions made on a random free variable (needs a non-zero seed)
+void sat_set_random_freq(double freq, SatState* sat_state) {
+	sat_state->random_freq = freq;
+}
 
-	//Traverse every unit child of the uip
-	while (trav != NULL)
+//sets the phase (1 positive, 0 negative) of every variable for its next decision
+void sat_set_default_phase(BOOLEAN phase, SatState* sat_state) {
+	for (c2dSize i = 1; i <= sat_state->num_vars; i++)
+		sat_state->vars[i]->phase = phase;
+}
+
+//restarts the search after interval contradictions (0 for no restarts); later intervals
+//follow the luby sequence if luby is 1, and grow by half each time otherwise
+void sat_set_restarts(c2dSize interval, BOOLEAN luby, SatState* sat_state) {
+	sat_state->restart_interval = interval;
+	sat_state->luby_restarts = luby;
+}
+
+//makes solving run local search for at most the given number of flips before its first decision, and
+//then every period restarts (0 flips turns local search off)
+void sat_set_local_search(c2dSize flips, c2dSize period, SatState* sat_state) {
+	sat_state->local_search_flips = flips;
+	sat_state->local_search_period = period;
+}
+
+//sets a flag which makes sat_solve_with_assumptions() give up once it is set
+void sat_set_stop_flag(const volatile BOOLEAN* stop, SatState* sat_state) {
+	sat_state->stop = stop;
+}
+
+//sets the functions called on each learned clause (before it is asserted) and on each restart
+void sat_set_hooks(void (*on_learned)(const Clause*, void*), void (*on_restart)(SatState*, void*), void* data, SatState* sat_state) {
+	sat_state->on_learned = on_learned;
+	sat_state->on_restart = on_restart;
+	sat_state->hook_data = data;
+}
+
+//returns the number of decision levels among the literals of a learned clause when it was learned
+c2dSize sat_clause_lbd(const Clause* clause) {
+	if (clause == NULL)
+		return 0;
+	return clause->lbd;
+}
+
+//returns the number of contradictions found by the sat state so far
+c2dSize sat_conflict_count(const SatState* sat_state) {
+	return sat_state->num_conflicts;
+}
+
+//returns the number of literals set by the sat state so far (decisions included)
+c2dSize sat_propagation_count(const SatState* sat_state) {
+	return sat_state->num_propagations;
+}
+
+//returns the number of literals left out of the clauses of the cnf of sat state as repeated in their clause
+c2dSize sat_duplicate_literal_count(const SatState* sat_state) {
+	return sat_state->arena->num_duplicate_lits;
+}
+
+//returns the number of clauses left out of the cnf of sat state as containing a literal and its opposite
+c2dSize sat_tautology_count(const SatState* sat_state) {
+	return sat_state->arena->num_tautologies;
+}
+
+//returns the number of clauses left out of the cnf of sat state as having the literals of an earlier clause
+c2dSize sat_duplicate_clause_count(const SatState* sat_state) {
+	return sat_state->arena->num_duplicate_clauses;
+}
+
+//stores the counters of sat state in stats: decisions, propagations, contradictions, learned clauses
+//(with histograms of their sizes and lbds), deleted and dropped clauses, restarts, propagations per second and memory
+void sat_state_stats(SatStats* stats, const SatState* sat_state) {
+	stats->decisions = sat_state->num_decisions;
+	stats->propagations = sat_state->num_propagations;
+	stats->conflicts = sat_state->num_conflicts;
+	stats->learned = sat_state->num_learned;
+	memcpy(stats->learned_sizes, sat_state->learned_sizes, sizeof(stats->learned_sizes));
+	memcpy(stats->learned_lbds, sat_state->learned_lbds, sizeof(stats->learned_lbds));
+	stats->deleted = 0;
+	stats->dropped = sat_state->num_dropped;
+	stats->restarts = sat_state->num_restarts;
+	stats->seconds = monotonic_seconds() - sat_state->start_time;
+	stats->propagations_per_second = stats->seconds > 0 ? sat_state->num_propagations / stats->seconds : 0;
+	stats->memory = sat_memory_usage(sat_state);
+
+	//The peak resident set is given in bytes by macOS, in kilobytes by Linux
+	struct rusage usage;
+	stats->peak_memory = getrusage(RUSAGE_SELF, &usage) == 0 ? (c2dSize)usage.ru_maxrss : 0;
+#ifndef __APPLE__
+	stats->peak_memory *= 1024;
+#endif
+}
+
+//Gets the bucket of a histogram of learned clauses a value falls in (see statsBuckets)
+//@param value: the size or lbd of a learned clause
+//@return the bucket
+int stats_bucket(c2dSize value)
+{
+	int bucket = 0;
+	while (value > 1 && bucket < statsBuckets - 1)
 	{
-		//Add opposite of non-decision level parents of uip's children to assertion clause
-		for (int i = 0; i < trav->node_lit->unit_on->num_lits; i++)
-		{
-			//If the literal was not learned at this decision level add its opposite to the assertion clause
-			if (sat_literal_var(trav->node_lit->unit_on->literals[i])->decision_level != sat_state->decision_level)
-				litList_push(temp_assert_lits, opp_lit(trav->node_lit->unit_on->literals[i]));
-		}
-		trav = trav->next;	//Move to the next unit child literal
+		value >>= 1;
+		bucket++;
 	}
-	
-	//Create the list of literals in the clause
-	assertion->literals = (Lit**)malloc(assertion->num_lits * sizeof(Lit *));
-	assertion->free_lits = assertion->num_lits;
-	 
-	//Place each literal into the list of literals in the clause
-	for (int i = 0; i < assertion->num_lits; i++)
-		assertion->literals[i] = litList_pop(temp_assert_lits);
+	return bucket;
+}
+
+//Gets the time of a monotonic clock, in seconds
+double monotonic_seconds()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
 
-	free(temp_assert_lits);
+//returns an estimate of the number of bytes allocated by the sat state (its arena included)
+c2dSize sat_memory_usage(const SatState* sat_state) {
+	c2dSize cnf_lits = sat_state->arena->starts[sat_state->num_clauses + 1];
+	c2dSize num_extra = sat_state->num_learned + sat_state->num_added;
+
+	return sizeof(SatState)
+		+ sat_state->num_vars * (sizeof(Var) + 2 * sizeof(Lit) + 2 * sizeof(c2dSize) + 4 * sizeof(Lit*) + sizeof(unsigned long))
+		+ (sat_state->num_clauses + 2) * (sizeof(Clause) + sizeof(c2dSize))
+		+ cnf_lits * (sizeof(Lit*) + sizeof(Clause*) + sizeof(c2dLiteral) + sizeof(c2dSize))
+		+ num_extra * (sizeof(Clause) + sizeof(clauseNode))
+		+ sat_state->num_learned_lits * (sizeof(Lit*) + sizeof(Clause*));
+}
 
-	return assertion;
+//returns the number of blocks the calling thread allocated (or reallocated) in the library so far
+//the difference before and after a call is what the call allocated
+c2dSize sat_allocation_count() {
+	return allocated_blocks;
 }
 
 /******************************************************************************
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compares the time ./sat takes on the ISCAS benchmarks without a proof, with a
+# binary DRAT proof, and with a gzipped one.
+#
+# Usage: bench/proof_overhead.sh [seconds per run] [sat options...]
+# (run from sat_solver, after make)
+
+LIMIT=${1:-60}
+[ $# -gt 0 ] && shift
+PROOF=${TMPDIR:-/tmp}/proof_overhead.$$
+
+now() { date +%s.%N; }
+
+# prints the seconds a run takes, or TIMEOUT
+run() {
+	start=$(now)
+	timeout "$LIMIT" ./sat "$@" > /dev/null 2>&1
+	[ $? -eq 124 ] && { echo TIMEOUT; return; }
+	echo "$(now) $start" | awk '{ printf "%.3f", $1 - $2 }'
+}
+
+printf "%-24s %10s %10s %10s %10s\n" file none drat drat.gz proof_kB
+for f in ../benchmarks/iscas85/*.cnf ../benchmarks/iscas89/*.cnf; do
+	none=$(run -c "$f" "$@")
+	drat=$(run -c "$f" "$@" --proof "$PROOF")
+	size=$(($(wc -c < "$PROOF") / 1024))
+	gz=$(run -c "$f" "$@" --proof "$PROOF.gz")
+	printf "%-24s %10s %10s %10s %10s\n" "$(basename "$f")" "$none" "$drat" "$gz" "$size"
+	rm -f "$PROOF" "$PROOF.gz"
+done | awk '{ print }
+	$2 != "TIMEOUT" && $3 != "TIMEOUT" && $4 != "TIMEOUT" { none += $2; drat += $3; gz += $4 }
+	END { if (none > 0) printf "total (finished runs)    %10.3f %10.3f %10.3f   drat %+.1f%%  gz %+.1f%%\n", none, drat, gz, 100 * (drat - none) / none, 100 * (gz - none) / none }'
@@ -0,0 +1,31 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "sat_api.h"
+
+/******************************************************************************
+* Batch solving
+*
+* Solves many cnf files (the .cnf files of a directory, compressed or not, or
+* the files listed one per line in a file) with a fixed number of workers,
+* starting with the largest files. Each worker keeps its sat state from one
+* file to the next (see sat_state_renew()) instead of freeing and rebuilding
+* it. A worker gives up on a file once it ran for the time limit (counted
+* from the end of the reading of the file, which cannot be stopped) or its sat
+* state grew past the memory limit. A file which cannot be read or is not a
+* cnf is reported as an error, and the worker goes on with the next one.
+*
+* One line is printed per file as soon as it is solved:
+*   r <SAT|UNSAT|TIMEOUT|MEMOUT|ERROR> <seconds> <contradictions> <file>
+******************************************************************************/
+
+//solves every cnf file of source (a directory or a file listing them) with num_workers workers
+//a limit of 0 means no limit, the memory limit is in bytes
+//returns the number of files which could not be solved (timeouts, memouts and errors)
+int batch_sat(const char* source, int num_workers, double time_limit, c2dSize memory_limit);
+
+#endif //BATCH_H_
+
+/******************************************************************************
+* end
+******************************************************************************/
@@ -0,0 +1,26 @@
+#ifndef CUBE_H_
+#define CUBE_H_
+
+#include "sat_api.h"
+
+/******************************************************************************
+* Cube and conquer
+*
+* A lookahead splits the cnf into cubes: each branch decides the variable
+* whose two literals imply the most literals, and a literal which leads to a
+* contradiction is not branched on. The cubes are dealt out to the workers,
+* each of which solves its cubes as assumptions of its own sat state and
+* steals from the others once its own cubes are done. The failed assumptions
+* of a refuted cube are shared so that no worker solves a cube containing
+* them, and are added as a clause by the workers.
+******************************************************************************/
+
+//solves the cnf in cnf_fname by splitting it into cubes solved by num_workers workers running in parallel
+//returns 1 if the cnf is satisfiable, 0 otherwise
+BOOLEAN cube_sat(const char* cnf_fname, int num_workers);
+
+#endif //CUBE_H_
+
+/******************************************************************************
+* end
+******************************************************************************/
@@ -0,0 +1,29 @@
+#ifndef PORTFOLIO_H_
+#define PORTFOLIO_H_
+
+#include "sat_api.h"
+
+/******************************************************************************
+* Portfolio solving
+*
+* Several sat states solve the same cnf at once, each in its own thread and
+* with its own settings (seed, random decisions, phases, restarts). Learned
+* clauses which are short or have a low lbd are exported by each worker into
+* a ring that the other workers read (without locks) when they restart. The
+* first worker to find an answer stops the others.
+*
+* In deterministic mode, the workers only exchange clauses at fixed numbers
+* of literals set, each waiting for all the others, so that the answer and
+* the contradictions found are the same from one run to the next.
+******************************************************************************/
+
+//solves the cnf in cnf_fname with num_workers differently configured workers running in parallel
+//returns 1 if the cnf is satisfiable, 0 otherwise, and stores the number of contradictions found
+//by the worker which answered in conflicts (if not NULL)
+BOOLEAN portfolio_sat(const char* cnf_fname, int num_workers, BOOLEAN deterministic, c2dSize* conflicts);
+
+#endif //PORTFOLIO_H_
+
+/******************************************************************************
+* end
+******************************************************************************/
@@ -15,12 +15,32 @@ typedef char BOOLEAN; //signed
 typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
 typedef double c2dWmc;          //for (weighted) model count
+typedef unsigned long long c2dScenarios; //for sets of up to 64 scenarios, one bit each
 
 typedef struct var Var;
 typedef struct literal Lit;
 typedef struct clause Clause;
 typedef struct sat_state_t SatState;
 typedef struct decision Decision;
+typedef struct sat_builder_t SatBuilder;
+
+#define statsBuckets 16 //buckets of the histograms of learned clauses (bucket i counts the values from 2^i to 2^(i+1) - 1)
+
+typedef struct sat_stats_t {
+	c2dSize decisions;
+	c2dSize propagations;
+	c2dSize conflicts;
+	c2dSize learned;
+	c2dSize learned_sizes[statsBuckets];
+	c2dSize learned_lbds[statsBuckets];
+	c2dSize deleted;
+	c2dSize dropped;
+	c2dSize restarts;
+	double seconds;
+	double propagations_per_second;
+	c2dSize memory;
+	c2dSize peak_memory;
+} SatStats;
 
 /******************************************************************************
 * function prototypes
@@ -77,19 +97,119 @@ void sat_unmark_clause(Clause* clause);
 ******************************************************************************/
 
 SatState* sat_state_new(const char* file_name);
+SatState* sat_state_try_new(const char* file_name, char* error, size_t error_size);
+SatState* sat_state_clone(const SatState* sat_state);
+SatState* sat_state_renew(SatState* sat_state, const char* file_name);
+SatState* sat_state_try_renew(SatState* sat_state, const char* file_name, char* error, size_t error_size);
+BOOLEAN sat_state_reorder(const c2dSize* var_order, SatState* sat_state);
 void sat_state_free(SatState* sat_state);
 BOOLEAN sat_unit_resolution(SatState* sat_state);
 void sat_undo_unit_resolution(SatState* sat_state);
 void undo_all_resolution(SatState* sat_state);
-void free_decision(Decision* undo_dec);
+void free_decision(Decision* undo_dec, SatState* sat_state);
 BOOLEAN sat_at_assertion_level(const Clause* clause, const SatState* sat_state);
 Decision* get_latest_decision(SatState* sat_state);
 void debug_print_clauses(SatState*);
-Lit* sat_get_uip(Clause* contradiction, SatState* sat_state);
-void find_uip_lits(Clause* contradiction, SatState* sat_state);
-BOOLEAN uip_DFS(SatState* sat_state);
 Clause* get_assertion_clause(Clause* contradiction, SatState* sat_state);
 
+/******************************************************************************
+* Builders
+******************************************************************************/
+
+SatBuilder* sat_builder_new(c2dSize num_vars);
+void sat_builder_add_clause(const c2dLiteral* lits, c2dSize num_lits, SatBuilder* builder);
+void sat_builder_borrow_clauses(const c2dLiteral* lits, const c2dSize* offsets, c2dSize num_clauses, SatBuilder* builder);
+SatState* sat_builder_finish(SatBuilder* builder);
+
+/******************************************************************************
+* Incremental solving
+******************************************************************************/
+
+Clause* sat_add_clause(Lit** lits, c2dSize num_lits, SatState* sat_state);
+BOOLEAN sat_solve_with_assumptions(Lit** assumptions, c2dSize num_assumptions, SatState* sat_state);
+Lit** sat_failed_assumptions(c2dSize* count, const SatState* sat_state);
+BOOLEAN sat_model_value(const Var* var);
+long sat_lookahead_literal(Lit* lit, SatState* sat_state);
+
+/******************************************************************************
+* Model enumeration
+******************************************************************************/
+
+c2dSize sat_enumerate_models(Var** vars, c2dSize num_vars, BOOLEAN (*on_model)(Lit** lits, c2dSize num_lits, void* data), void* data, SatState* sat_state);
+
+/******************************************************************************
+* Local search
+******************************************************************************/
+
+c2dSize sat_local_search(c2dSize max_flips, SatState* sat_state);
+
+/******************************************************************************
+* Scenarios
+******************************************************************************/
+
+c2dScenarios sat_propagate_scenarios(c2dScenarios* true_masks, c2dScenarios* false_masks, SatState* sat_state);
+
+/******************************************************************************
+* Snapshots
+******************************************************************************/
+
+BOOLEAN sat_snapshot_save(const char* file_name, BOOLEAN simplify, SatState* sat_state);
+
+/******************************************************************************
+* Proofs
+******************************************************************************/
+
+BOOLEAN sat_proof_open(const char* file_name, SatState* sat_state);
+BOOLEAN sat_proof_close(SatState* sat_state);
+
+/******************************************************************************
+* Tracing
+******************************************************************************/
+
+BOOLEAN sat_trace_start(c2dSize num_events, SatState* sat_state);
+void sat_trace_stop(SatState* sat_state);
+c2dSize sat_trace_count(const SatState* sat_state);
+BOOLEAN sat_trace_save(const char* file_name, const SatState* sat_state);
+BOOLEAN sat_trace_decode(const char* file_name, FILE* out);
+
+/******************************************************************************
+* Regions
+******************************************************************************/
+
+#define clauseRegion 0
+#define occursRegion 1
+#define stateRegion 2
+#define cacheRegion 3
+#define numRegions 4
+
+const char* sat_region_name(int region);
+c2dSize sat_region_usage(int region, c2dSize* huge_bytes);
+void* sat_region_alloc(size_t size, int region);
+void* sat_region_calloc(size_t size, int region);
+void* sat_region_realloc(void* block, size_t size, int region);
+void sat_region_free(void* block);
+
+/******************************************************************************
+* Solver configuration
+******************************************************************************/
+
+void sat_set_seed(unsigned long seed, SatState* sat_state);
+void sat_set_random_freq(double freq, SatState* sat_state);
+void sat_set_default_phase(BOOLEAN phase, SatState* sat_state);
+void sat_set_restarts(c2dSize interval, BOOLEAN luby, SatState* sat_state);
+void sat_set_local_search(c2dSize flips, c2dSize period, SatState* sat_state);
+void sat_set_stop_flag(const volatile BOOLEAN* stop, SatState* sat_state);
+void sat_set_hooks(void (*on_learned)(const Clause*, void*), void (*on_restart)(SatState*, void*), void* data, SatState* sat_state);
+c2dSize sat_clause_lbd(const Clause* clause);
+c2dSize sat_conflict_count(const SatState* sat_state);
+c2dSize sat_propagation_count(const SatState* sat_state);
+c2dSize sat_memory_usage(const SatState* sat_state);
+c2dSize sat_allocation_count();
+c2dSize sat_duplicate_literal_count(const SatState* sat_state);
+c2dSize sat_tautology_count(const SatState* sat_state);
+c2dSize sat_duplicate_clause_count(const SatState* sat_state);
+void sat_state_stats(SatStats* stats, const SatState* sat_state);
+
 #endif //SATAPI_H_
 
 /******************************************************************************
@@ -0,0 +1,283 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "batch.h"
+
+#define maxPathLength 4096		//Longest line read from a file listing cnf files
+#define monitorPeriod 10		//Milliseconds between two checks of the time limits
+
+/******************************************************************************
+* Instances
+******************************************************************************/
+
+typedef struct instance_t {
+	char* path;						//Path of the cnf file
+	long size;						//Size of the file in bytes, -1 if it cannot be read
+} Instance;
+
+typedef struct instance_list_t {
+	c2dSize count;					//Number of instances in the list
+	c2dSize capacity;				//Number of instances the list has room for
+	Instance* instances;			//The instances
+} InstanceList;
+
+//Append a cnf file to a list of instances
+static void add_instance(InstanceList* list, const char* path) {
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity == 0 ? 64 : 2 * list->capacity;
+		list->instances = (Instance*)realloc(list->instances, list->capacity * sizeof(Instance));
+	}
+	Instance* instance = &list->instances[list->count++];
+	instance->path = strdup(path);
+
+	//Files which cannot be read are reported instead of solved
+	struct stat st;
+	FILE* file = fopen(path, "r");
+	instance->size = (file != NULL && stat(path, &st) == 0 && S_ISREG(st.st_mode)) ? (long)st.st_size : -1;
+	if (file != NULL)
+		fclose(file);
+}
+
+//returns 1 if a file name ends with .cnf, or with .cnf followed by the suffix of a compressed file
+static BOOLEAN is_cnf_name(const char* name) {
+	const char* suffixes[] = { ".cnf", ".cnf.gz", ".cnf.xz", ".cnf.bz2" };
+	size_t length = strlen(name);
+	for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+		size_t suffix = strlen(suffixes[i]);
+		if (length >= suffix && strcmp(name + length - suffix, suffixes[i]) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+//Add the .cnf files (compressed or not) of a directory, or the files listed (one per line) in a file, to a list of instances
+//@return 1 if source could be read, 0 otherwise
+static BOOLEAN read_instances(const char* source, InstanceList* list) {
+	struct stat st;
+	char path[maxPathLength];
+	if (stat(source, &st) != 0)
+		return 0;
+
+	if (S_ISDIR(st.st_mode)) {
+		DIR* dir = opendir(source);
+		if (dir == NULL)
+			return 0;
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (!is_cnf_name(entry->d_name))
+				continue;
+			snprintf(path, maxPathLength, "%s/%s", source, entry->d_name);
+			add_instance(list, path);
+		}
+		closedir(dir);
+		return 1;
+	}
+
+	FILE* file = fopen(source, "r");
+	if (file == NULL)
+		return 0;
+	while (fgets(path, maxPathLength, file) != NULL) {
+		size_t length = strlen(path);
+		while (length > 0 && (path[length - 1] == '\n' || path[length - 1] == '\r' || path[length - 1] == ' '))
+			path[--length] = '\0';
+		if (length > 0)
+			add_instance(list, path);
+	}
+	fclose(file);
+	return 1;
+}
+
+//Order instances by decreasing size (then by path, so the order does not depend on the directory)
+static int compare_instances(const void* a, const void* b) {
+	const Instance* first = (const Instance*)a;
+	const Instance* second = (const Instance*)b;
+	if (first->size != second->size)
+		return first->size > second->size ? -1 : 1;
+	return strcmp(first->path, second->path);
+}
+
+/******************************************************************************
+* Workers
+******************************************************************************/
+
+typedef struct batch_t Batch;
+
+typedef struct batch_worker_t {
+	Batch* batch;					//Batch the worker belongs to
+	SatState* sat_state;			//Sat state of the worker's current file, reused for the next one
+	volatile BOOLEAN stop;			//Set when the worker must give up on its current file
+	BOOLEAN memout;					//1 if the worker gave up because of the memory limit
+	BOOLEAN busy;					//1 while the worker is solving a file
+	double deadline;				//Time at which the worker must give up on its current file
+} BatchWorker;
+
+struct batch_t {
+	InstanceList instances;			//Files to solve, largest first
+	c2dSize next;					//Next file to solve
+	int num_workers;				//Number of workers
+	BatchWorker* workers;			//The workers
+	int workers_done;				//Number of workers which found no file left
+	double time_limit;				//Seconds spent on a file before giving up (0 for no limit)
+	c2dSize memory_limit;			//Bytes a sat state can grow to before giving up (0 for no limit)
+	int failures;					//Number of files which could not be solved
+	pthread_mutex_t lock;			//Protects everything above that changes, the workers' deadlines and the output
+};
+
+//returns the current time in seconds
+static double now_seconds() {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Give up on the current file once the sat state grew past the memory limit (on_learned hook)
+static void check_memory(const Clause* clause, void* data) {
+	BatchWorker* worker = (BatchWorker*)data;
+	if (sat_memory_usage(worker->sat_state) > worker->batch->memory_limit) {
+		worker->memout = 1;
+		worker->stop = 1;
+	}
+}
+
+//Print the result of a file
+static void report(Batch* batch, const Instance* instance, const char* result, double seconds, c2dSize conflicts) {
+	pthread_mutex_lock(&batch->lock);
+	printf("r %s %.3f %lu %s\n", result, seconds, conflicts, instance->path);
+	fflush(stdout);
+	if (strcmp(result, "SAT") != 0 && strcmp(result, "UNSAT") != 0)
+		batch->failures++;
+	pthread_mutex_unlock(&batch->lock);
+}
+
+//Solve files until none is left
+static void* run_batch_worker(void* data) {
+	BatchWorker* worker = (BatchWorker*)data;
+	Batch* batch = worker->batch;
+
+	while (1) {
+		pthread_mutex_lock(&batch->lock);
+		c2dSize index = batch->next < batch->instances.count ? batch->next++ : batch->instances.count;
+		pthread_mutex_unlock(&batch->lock);
+		if (index == batch->instances.count)
+			break;
+
+		Instance* instance = &batch->instances.instances[index];
+		if (instance->size < 0) {
+			report(batch, instance, "ERROR", 0, 0);
+			continue;
+		}
+
+		//The time limit starts once the file is read, as reading cannot be stopped
+		double start = now_seconds();
+		char error[256];
+		if (worker->sat_state == NULL)
+			worker->sat_state = sat_state_try_new(instance->path, error, sizeof(error));
+		else
+			worker->sat_state = sat_state_try_renew(worker->sat_state, instance->path, error, sizeof(error));
+		if (worker->sat_state == NULL) {
+			fprintf(stderr, "%s\n", error);
+			report(batch, instance, "ERROR", now_seconds() - start, 0);
+			continue;
+		}
+
+		pthread_mutex_lock(&batch->lock);
+		worker->stop = 0;
+		worker->memout = batch->memory_limit != 0 && sat_memory_usage(worker->sat_state) > batch->memory_limit;
+		worker->deadline = start + batch->time_limit;
+		worker->busy = 1;
+		pthread_mutex_unlock(&batch->lock);
+
+		BOOLEAN result = -1;
+		if (!worker->memout) {
+			sat_set_stop_flag(&worker->stop, worker->sat_state);
+			if (batch->memory_limit != 0)
+				sat_set_hooks(check_memory, NULL, worker, worker->sat_state);
+			result = sat_solve_with_assumptions(NULL, 0, worker->sat_state);
+		}
+
+		pthread_mutex_lock(&batch->lock);
+		worker->busy = 0;
+		pthread_mutex_unlock(&batch->lock);
+
+		const char* answer = result == 1 ? "SAT" : result == 0 ? "UNSAT" : worker->memout ? "MEMOUT" : "TIMEOUT";
+		report(batch, instance, answer, now_seconds() - start, sat_conflict_count(worker->sat_state));
+	}
+
+	pthread_mutex_lock(&batch->lock);
+	batch->workers_done++;
+	pthread_mutex_unlock(&batch->lock);
+	return NULL;
+}
+
+//solves every cnf file of source (a directory or a file listing them) with num_workers workers
+//a limit of 0 means no limit, the memory limit is in bytes
+//returns the number of files which could not be solved (timeouts, memouts and errors)
+int batch_sat(const char* source, int num_workers, double time_limit, c2dSize memory_limit) {
+	Batch batch;
+	batch.instances.count = batch.instances.capacity = 0;
+	batch.instances.instances = NULL;
+	if (!read_instances(source, &batch.instances)) {
+		fprintf(stderr, "Could not read %s\n", source);
+		return -1;
+	}
+	qsort(batch.instances.instances, batch.instances.count, sizeof(Instance), compare_instances);
+
+	batch.next = 0;
+	batch.num_workers = num_workers;
+	batch.workers_done = 0;
+	batch.time_limit = time_limit;
+	batch.memory_limit = memory_limit;
+	batch.failures = 0;
+	pthread_mutex_init(&batch.lock, NULL);
+
+	batch.workers = (BatchWorker*)malloc(num_workers * sizeof(BatchWorker));
+	pthread_t* threads = (pthread_t*)malloc(num_workers * sizeof(pthread_t));
+	for (int i = 0; i < num_workers; i++) {
+		BatchWorker* worker = &batch.workers[i];
+		worker->batch = &batch;
+		worker->sat_state = NULL;
+		worker->stop = 0;
+		worker->memout = 0;
+		worker->busy = 0;
+		worker->deadline = 0;
+		pthread_create(&threads[i], NULL, run_batch_worker, worker);
+	}
+
+	//Stop the workers which ran past the time limit on their file
+	struct timespec period = { 0, monitorPeriod * 1000000L };
+	while (1) {
+		pthread_mutex_lock(&batch.lock);
+		BOOLEAN done = batch.workers_done == num_workers;
+		double time = now_seconds();
+		for (int i = 0; i < num_workers && time_limit > 0; i++) {
+			if (batch.workers[i].busy && time > batch.workers[i].deadline)
+				batch.workers[i].stop = 1;
+		}
+		pthread_mutex_unlock(&batch.lock);
+		if (done)
+			break;
+		nanosleep(&period, NULL);
+	}
+
+	for (int i = 0; i < num_workers; i++) {
+		pthread_join(threads[i], NULL);
+		if (batch.workers[i].sat_state != NULL)
+			sat_state_free(batch.workers[i].sat_state);
+	}
+	for (c2dSize i = 0; i < batch.instances.count; i++)
+		free(batch.instances.instances[i].path);
+	free(batch.instances.instances);
+	free(batch.workers);
+	free(threads);
+	pthread_mutex_destroy(&batch.lock);
+
+	return batch.failures;
+}
+
+/******************************************************************************
+* end
+******************************************************************************/
@@ -0,0 +1,352 @@
+#include <pthread.h>
+
+#include "cube.h"
+
+#define cubesPerWorker 16		//Cubes made for each worker (rounded up to a power of 2)
+#define maxSplitDepth 20		//Most variables split on to make a cube
+#define maxCandidates 64		//Free variables (with the most occurences) looked ahead on for each split
+
+/******************************************************************************
+* Cubes
+******************************************************************************/
+
+typedef struct cube_t {
+	c2dSize size;					//Number of literals in the cube
+	c2dLiteral* lits;				//Indices of the literals in the cube
+} Cube;
+
+typedef struct cube_list_t {
+	c2dSize count;					//Number of cubes in the list
+	c2dSize capacity;				//Number of cubes the list has room for
+	Cube* cubes;					//The cubes
+} CubeList;
+
+//Append a copy of the given literals to a list of cubes
+static void cube_list_push(CubeList* list, const c2dLiteral* lits, c2dSize size) {
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity == 0 ? 64 : 2 * list->capacity;
+		list->cubes = (Cube*)realloc(list->cubes, list->capacity * sizeof(Cube));
+	}
+	Cube* cube = &list->cubes[list->count++];
+	cube->size = size;
+	cube->lits = (c2dLiteral*)malloc((size == 0 ? 1 : size) * sizeof(c2dLiteral));
+	if (size > 0)
+		memcpy(cube->lits, lits, size * sizeof(c2dLiteral));
+}
+
+static void cube_list_free(CubeList* list) {
+	for (c2dSize i = 0; i < list->count; i++)
+		free(list->cubes[i].lits);
+	free(list->cubes);
+}
+
+//returns 1 if every literal of core is in cube, 0 otherwise
+static BOOLEAN cube_contains(const Cube* cube, const Cube* core) {
+	for (c2dSize i = 0; i < core->size; i++) {
+		c2dSize j = 0;
+		while (j < cube->size && cube->lits[j] != core->lits[i])
+			j++;
+		if (j == cube->size)
+			return 0;
+	}
+	return 1;
+}
+
+/******************************************************************************
+* Lookahead
+******************************************************************************/
+
+//Find the free variable to split on: among the free variables with the most occurences, the
+//one whose literals imply the most literals (product of both counts), or the first one found
+//with a literal leading to a contradiction
+//@return the variable, or NULL if every variable is set
+static Var* lookahead_var(SatState* sat_state, long* pos_count, long* neg_count) {
+	Var* candidates[maxCandidates];
+	c2dSize num_candidates = 0;
+
+	//Keep the free variables with the most occurences, sorted by decreasing occurences
+	for (c2dSize i = 1; i <= sat_var_count(sat_state); i++) {
+		Var* var = sat_index2var(i, sat_state);
+		if (sat_instantiated_var(var))
+			continue;
+		c2dSize pos = num_candidates < maxCandidates ? num_candidates++ : maxCandidates;
+		while (pos > 0 && sat_var_occurences(candidates[pos - 1]) < sat_var_occurences(var)) {
+			if (pos < maxCandidates)
+				candidates[pos] = candidates[pos - 1];
+			pos--;
+		}
+		if (pos < maxCandidates)
+			candidates[pos] = var;
+	}
+
+	Var* best = NULL;
+	double best_score = -1;
+	for (c2dSize i = 0; i < num_candidates; i++) {
+		long pos = sat_lookahead_literal(sat_pos_literal(candidates[i]), sat_state);
+		long neg = sat_lookahead_literal(sat_neg_literal(candidates[i]), sat_state);
+
+		//A literal leading to a contradiction leaves a single branch
+		if (pos == -1 || neg == -1) {
+			*pos_count = pos;
+			*neg_count = neg;
+			return candidates[i];
+		}
+
+		if ((double)pos * neg > best_score) {
+			best_score = (double)pos * neg;
+			best = candidates[i];
+			*pos_count = pos;
+			*neg_count = neg;
+		}
+	}
+	return best;
+}
+
+//Split the cnf below the current decisions (whose literals are in prefix) into cubes
+//@param splits: number of splits left, a cube ends once no split is left or every variable is set
+static void split_cubes(SatState* sat_state, c2dLiteral* prefix, c2dSize size, c2dSize splits, CubeList* cubes) {
+	long pos_count, neg_count;
+	Var* var = splits == 0 ? NULL : lookahead_var(sat_state, &pos_count, &neg_count);
+	if (var == NULL) {
+		cube_list_push(cubes, prefix, size);
+		return;
+	}
+
+	//A literal which can only be one way is not a split
+	if (pos_count == -1 || neg_count == -1)
+		splits++;
+
+	Lit* branches[2] = { sat_pos_literal(var), sat_neg_literal(var) };
+	long counts[2] = { pos_count, neg_count };
+	for (int b = 0; b < 2; b++) {
+		if (counts[b] == -1)
+			continue;
+		prefix[size] = sat_literal_index(branches[b]);
+		if (sat_decide_literal(branches[b], sat_state) == NULL)
+			split_cubes(sat_state, prefix, size + 1, splits - 1, cubes);
+		sat_undo_decide_literal(sat_state);
+	}
+}
+
+/******************************************************************************
+* Workers
+*
+* Each worker has a queue of cubes. It takes its cubes from the head of its
+* queue, so that it solves neighbouring cubes (and their shared literals) one
+* after the other, and steals from the tail of the others' queues.
+******************************************************************************/
+
+typedef struct cube_queue_t {
+	c2dSize* cubes;					//Indices of the queued cubes
+	c2dSize head;					//Position of the next cube to take
+	c2dSize tail;					//Position after the last cube to take
+	pthread_mutex_t lock;			//Protects head and tail
+} CubeQueue;
+
+typedef struct conquer_t Conquer;
+
+typedef struct cube_worker_t {
+	int id;							//Position of the worker in the pool
+	Conquer* conquer;				//Pool the worker belongs to
+	CubeQueue queue;				//Cubes left to the worker
+	c2dSize cores_added;			//Number of shared cores the worker added as clauses
+} CubeWorker;
+
+struct conquer_t {
+	const SatState* original;		//Sat state of the cnf, cloned by the workers
+	CubeList cubes;					//Cubes to solve
+	c2dSize max_cube_size;			//Number of literals in the largest cube
+	int num_workers;				//Number of workers
+	CubeWorker* workers;			//The workers
+	CubeList cores;					//Failed assumptions of the refuted cubes
+	pthread_mutex_t cores_lock;		//Protects cores
+	volatile BOOLEAN stop;			//Set once the cnf is known to be satisfiable or unsatisfiable
+	BOOLEAN result;					//Answer found for the cnf, -1 until then
+	pthread_mutex_t lock;			//Protects result
+};
+
+//Take a cube from the worker's queue, or steal one from another worker
+//@return 1 if a cube was found (its index is stored in index), 0 if every queue is empty
+static BOOLEAN next_cube(CubeWorker* worker, c2dSize* index) {
+	Conquer* conquer = worker->conquer;
+	for (int k = 0; k < conquer->num_workers; k++) {
+		CubeQueue* queue = &conquer->workers[(worker->id + k) % conquer->num_workers].queue;
+		BOOLEAN found = 0;
+
+		pthread_mutex_lock(&queue->lock);
+		if (queue->head < queue->tail) {
+			*index = k == 0 ? queue->cubes[queue->head++] : queue->cubes[--queue->tail];
+			found = 1;
+		}
+		pthread_mutex_unlock(&queue->lock);
+
+		if (found)
+			return 1;
+	}
+	return 0;
+}
+
+//Add the negation of the cores shared since the worker's last cube as clauses, and check if the cube is refuted by a core
+//@return 1 if a shared core is in the cube, 0 otherwise
+static BOOLEAN refuted_cube(CubeWorker* worker, const Cube* cube, SatState* sat_state) {
+	Conquer* conquer = worker->conquer;
+	BOOLEAN refuted = 0;
+	Lit** clause = (Lit**)malloc((conquer->max_cube_size + 1) * sizeof(Lit*));
+
+	pthread_mutex_lock(&conquer->cores_lock);
+	for (; worker->cores_added < conquer->cores.count; worker->cores_added++) {
+		Cube* core = &conquer->cores.cubes[worker->cores_added];
+		for (c2dSize i = 0; i < core->size; i++)
+			clause[i] = sat_index2literal(-core->lits[i], sat_state);
+		sat_add_clause(clause, core->size, sat_state);
+	}
+	for (c2dSize i = 0; i < conquer->cores.count && !refuted; i++)
+		refuted = cube_contains(cube, &conquer->cores.cubes[i]);
+	pthread_mutex_unlock(&conquer->cores_lock);
+
+	free(clause);
+	return refuted;
+}
+
+//Record the answer of a worker, and stop the other workers
+static void set_result(Conquer* conquer, BOOLEAN result) {
+	pthread_mutex_lock(&conquer->lock);
+	if (conquer->result == -1)
+		conquer->result = result;
+	conquer->stop = 1;
+	pthread_mutex_unlock(&conquer->lock);
+}
+
+//Clone the cnf's sat state and solve cubes until every cube is refuted or an answer is found
+static void* run_cube_worker(void* data) {
+	CubeWorker* worker = (CubeWorker*)data;
+	Conquer* conquer = worker->conquer;
+
+	SatState* sat_state = sat_state_clone(conquer->original);
+	sat_set_stop_flag(&conquer->stop, sat_state);
+
+	Lit** assumptions = (Lit**)malloc((conquer->max_cube_size + 1) * sizeof(Lit*));
+	c2dLiteral* failed = (c2dLiteral*)malloc((conquer->max_cube_size + 1) * sizeof(c2dLiteral));
+	c2dSize index;
+
+	while (!conquer->stop && next_cube(worker, &index)) {
+		Cube* cube = &conquer->cubes.cubes[index];
+		if (refuted_cube(worker, cube, sat_state))
+			continue;
+
+		for (c2dSize i = 0; i < cube->size; i++)
+			assumptions[i] = sat_index2literal(cube->lits[i], sat_state);
+
+		BOOLEAN result = sat_solve_with_assumptions(assumptions, cube->size, sat_state);
+		if (result == 1)
+			set_result(conquer, 1);
+		else if (result == 0) {
+			c2dSize core_size;
+			Lit** core = sat_failed_assumptions(&core_size, sat_state);
+
+			//Without failed assumptions, the cnf itself is unsatisfiable
+			if (core_size == 0) {
+				set_result(conquer, 0);
+				break;
+			}
+
+			//The failed assumptions are a subset of the cube
+			for (c2dSize i = 0; i < core_size; i++)
+				failed[i] = sat_literal_index(core[i]);
+			pthread_mutex_lock(&conquer->cores_lock);
+			cube_list_push(&conquer->cores, failed, core_size);
+			pthread_mutex_unlock(&conquer->cores_lock);
+		}
+	}
+
+	free(assumptions);
+	free(failed);
+	sat_state_free(sat_state);
+	return NULL;
+}
+
+//solves the cnf in cnf_fname by splitting it into cubes solved by num_workers workers running in parallel
+//returns 1 if the cnf is satisfiable, 0 otherwise
+BOOLEAN cube_sat(const char* cnf_fname, int num_workers) {
+	Conquer conquer;
+	conquer.cubes.count = conquer.cubes.capacity = 0;
+	conquer.cubes.cubes = NULL;
+	conquer.cores.count = conquer.cores.capacity = 0;
+	conquer.cores.cubes = NULL;
+	conquer.num_workers = num_workers;
+	conquer.stop = 0;
+	conquer.result = -1;
+
+	//Split enough times for each worker to get cubesPerWorker cubes
+	c2dSize splits = 0;
+	while (splits < maxSplitDepth && ((c2dSize)1 << splits) < (c2dSize)cubesPerWorker * num_workers)
+		splits++;
+
+	SatState* sat_state = sat_state_new(cnf_fname);
+	c2dLiteral* prefix = (c2dLiteral*)malloc((sat_var_count(sat_state) + 1) * sizeof(c2dLiteral));
+	if (sat_unit_resolution(sat_state))
+		split_cubes(sat_state, prefix, 0, splits, &conquer.cubes);
+	sat_undo_unit_resolution(sat_state);
+	free(prefix);
+
+	//Every branch led to a contradiction
+	if (conquer.cubes.count == 0) {
+		cube_list_free(&conquer.cubes);
+		sat_state_free(sat_state);
+		return 0;
+	}
+
+	//The workers clone the sat state the cubes were made with
+	conquer.original = sat_state;
+
+	conquer.max_cube_size = 0;
+	for (c2dSize i = 0; i < conquer.cubes.count; i++)
+		if (conquer.cubes.cubes[i].size > conquer.max_cube_size)
+			conquer.max_cube_size = conquer.cubes.cubes[i].size;
+
+	pthread_mutex_init(&conquer.cores_lock, NULL);
+	pthread_mutex_init(&conquer.lock, NULL);
+	conquer.workers = (CubeWorker*)malloc(num_workers * sizeof(CubeWorker));
+	pthread_t* threads = (pthread_t*)malloc(num_workers * sizeof(pthread_t));
+
+	//Each worker starts with a block of neighbouring cubes
+	for (int i = 0; i < num_workers; i++) {
+		CubeWorker* worker = &conquer.workers[i];
+		c2dSize first = conquer.cubes.count * i / num_workers;
+		c2dSize last = conquer.cubes.count * (i + 1) / num_workers;
+
+		worker->id = i;
+		worker->conquer = &conquer;
+		worker->cores_added = 0;
+		worker->queue.cubes = (c2dSize*)malloc((last - first + 1) * sizeof(c2dSize));
+		worker->queue.head = 0;
+		worker->queue.tail = last - first;
+		for (c2dSize j = first; j < last; j++)
+			worker->queue.cubes[j - first] = j;
+		pthread_mutex_init(&worker->queue.lock, NULL);
+	}
+
+	for (int i = 0; i < num_workers; i++)
+		pthread_create(&threads[i], NULL, run_cube_worker, &conquer.workers[i]);
+	for (int i = 0; i < num_workers; i++)
+		pthread_join(threads[i], NULL);
+
+	for (int i = 0; i < num_workers; i++) {
+		free(conquer.workers[i].queue.cubes);
+		pthread_mutex_destroy(&conquer.workers[i].queue.lock);
+	}
+	free(conquer.workers);
+	free(threads);
+	cube_list_free(&conquer.cubes);
+	cube_list_free(&conquer.cores);
+	sat_state_free(sat_state);
+	pthread_mutex_destroy(&conquer.cores_lock);
+	pthread_mutex_destroy(&conquer.lock);
+
+	//Without an answer, every cube was refuted
+	return conquer.result == -1 ? 0 : conquer.result;
+}
+
+/******************************************************************************
+* end
+******************************************************************************/
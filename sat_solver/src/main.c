@@ -3,6 +3,11 @@
 #include <string.h>
 
 #include "sat_api.h"
+#include "portfolio.h"
+#include "cube.h"
+#include "batch.h"
+
+#define traceEvents (1 << 20)		//Number of the last events of the search kept by --trace
 
 /******************************************************************************
 * SAT solver
@@ -50,20 +55,220 @@ BOOLEAN sat(SatState* sat_state) {
 	return ret;
 }
 
+//writes a model as a line of literals ended by 0 to a file (called by sat_enumerate_models())
+BOOLEAN write_model(Lit** lits, c2dSize num_lits, void* file) {
+	for (c2dSize i = 0; i < num_lits; i++)
+		fprintf((FILE*)file, "%ld ", sat_literal_index(lits[i]));
+	fprintf((FILE*)file, "0\n");
+	return 1;
+}
+
+//writes every model of the cnf of sat state projected onto the variables listed in projection
+//(as "1,2,5", every variable if NULL) to a file, and returns the number of models
+c2dSize enumerate_models(const char* projection, FILE* file, SatState* sat_state) {
+	Var** vars = (Var**)malloc(sat_var_count(sat_state) * sizeof(Var*));
+	c2dSize num_vars = 0;
+	for (const char* token = projection; token != NULL && *token != '\0'; ) {
+		char* end;
+		long index = strtol(token, &end, 10);
+		if (end == token || index < 1 || index > (long)sat_var_count(sat_state) || num_vars == sat_var_count(sat_state)) {
+			fprintf(stderr, "Bad projection %s\n", projection);
+			exit(1);
+		}
+		vars[num_vars++] = sat_index2var(index, sat_state);
+		token = *end == ',' ? end + 1 : end;
+	}
+
+	c2dSize count = sat_enumerate_models(vars, num_vars, write_model, file, sat_state);
+	free(vars);
+	return count;
+}
+
+//prints a count, as a "c <name> <count>" line or as a member of a json object
+void print_count(const char* name, c2dSize count, BOOLEAN json) {
+	if (json) printf("  \"%s\": %lu,\n", name, count);
+	else printf("c %s %lu\n", name, count);
+}
+
+//prints a histogram of learned clauses (see statsBuckets), as a line of counts or as a json array
+void print_histogram(const char* name, const c2dSize* counts, BOOLEAN json) {
+	printf(json ? "  \"%s\": [" : "c %s", name);
+	for (int i = 0; i < statsBuckets; i++)
+		printf(json && i > 0 ? ", %lu" : json ? "%lu" : " %lu", counts[i]);
+	printf(json ? "],\n" : "\n");
+}
+
+//prints the counters of a sat state, the cnf normalization counts, the allocations of this thread and
+//the usage of the memory regions, as "c <name> <value>" lines or as one json object
+void print_stats(BOOLEAN json, const SatState* sat_state) {
+	SatStats stats;
+	sat_state_stats(&stats, sat_state);
+
+	if (json) printf("{\n");
+	print_count("decisions", stats.decisions, json);
+	print_count("propagations", stats.propagations, json);
+	print_count("conflicts", stats.conflicts, json);
+	print_count("learned", stats.learned, json);
+	print_histogram("learned_sizes", stats.learned_sizes, json);
+	print_histogram("learned_lbds", stats.learned_lbds, json);
+	print_count("deleted", stats.deleted, json);
+	print_count("dropped", stats.dropped, json);
+	print_count("restarts", stats.restarts, json);
+	printf(json ? "  \"seconds\": %.3f,\n  \"propagations_per_second\": %.0f,\n" : "c seconds %.3f\nc propagations_per_second %.0f\n",
+		stats.seconds, stats.propagations_per_second);
+	print_count("memory", stats.memory, json);
+	print_count("peak_memory", stats.peak_memory, json);
+	print_count("allocations", sat_allocation_count(), json);
+	print_count("duplicate_literals", sat_duplicate_literal_count(sat_state), json);
+	print_count("tautologies", sat_tautology_count(sat_state), json);
+	print_count("duplicate_clauses", sat_duplicate_clause_count(sat_state), json);
+
+	//Bytes of each region, and how many of them lie in huge pages
+	if (json) printf("  \"regions\": {");
+	for (int region = 0; sat_region_name(region) != NULL; region++) {
+		c2dSize huge_bytes;
+		c2dSize bytes = sat_region_usage(region, &huge_bytes);
+		if (json) printf("%s\n    \"%s\": { \"bytes\": %lu, \"huge_bytes\": %lu }", region > 0 ? "," : "", sat_region_name(region), bytes, huge_bytes);
+		else printf("c region %s %lu %lu\n", sat_region_name(region), bytes, huge_bytes);
+	}
+	if (json) printf("\n  }\n}\n");
+}
+
 int main(int argc, char* argv[]) {
-	char USAGE_MSG[] = "Usage: ./sat -c <cnf_file>\n";
+	char USAGE_MSG[] = "Usage: ./sat -c <cnf_file> [-t <threads>] [-m portfolio|cube] [-d] [--sls <flips>] [--proof <file>] [--trace <file>] [--stats[=json]] [--reorder]\n"
+		"       ./sat -c <cnf_file> --snapshot-out <file> [--snapshot-simplify] [...]\n"
+		"       ./sat -c <cnf_file> --all [--project <var,var,...>] [--models <file>]\n"
+		"       ./sat --batch <dir|list_file> [-j <threads>] [--time-limit <seconds>] [--mem-limit <MB>]\n";
 	char* cnf_fname = NULL;
+	char* batch_source = NULL;
+	int num_threads = 1;
+	BOOLEAN cubes = 0;
+	BOOLEAN deterministic = 0;
+	double time_limit = 0;
+	double memory_limit = 0;
+	long local_search_flips = 0;
+	char* proof_fname = NULL;
+	char* trace_fname = NULL;
+	BOOLEAN enumerate = 0;
+	char* projection = NULL;
+	char* models_fname = NULL;
+	char* snapshot_fname = NULL;
+	BOOLEAN simplify_snapshot = 0;
+	BOOLEAN reorder = 0;
+	BOOLEAN stats = 0;
+	BOOLEAN json_stats = 0;
 
-	if (argc == 3 && strcmp("-c", argv[1]) == 0) cnf_fname = argv[2];
-	else {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp("-c", argv[i]) == 0 && i + 1 < argc) cnf_fname = argv[++i];
+		else if (strcmp("-t", argv[i]) == 0 && i + 1 < argc) num_threads = atoi(argv[++i]);
+		else if (strcmp("-m", argv[i]) == 0 && i + 1 < argc && strcmp("portfolio", argv[i + 1]) == 0) { cubes = 0; i++; }
+		else if (strcmp("-m", argv[i]) == 0 && i + 1 < argc && strcmp("cube", argv[i + 1]) == 0) { cubes = 1; i++; }
+		else if (strcmp("-d", argv[i]) == 0) deterministic = 1;
+		else if (strcmp("--batch", argv[i]) == 0 && i + 1 < argc) batch_source = argv[++i];
+		else if (strcmp("-j", argv[i]) == 0 && i + 1 < argc) num_threads = atoi(argv[++i]);
+		else if (strcmp("--time-limit", argv[i]) == 0 && i + 1 < argc) time_limit = atof(argv[++i]);
+		else if (strcmp("--mem-limit", argv[i]) == 0 && i + 1 < argc) memory_limit = atof(argv[++i]);
+		else if (strcmp("--sls", argv[i]) == 0 && i + 1 < argc) local_search_flips = atol(argv[++i]);
+		else if (strcmp("--proof", argv[i]) == 0 && i + 1 < argc) proof_fname = argv[++i];
+		else if (strcmp("--trace", argv[i]) == 0 && i + 1 < argc) trace_fname = argv[++i];
+		else if (strcmp("--all", argv[i]) == 0) enumerate = 1;
+		else if (strcmp("--project", argv[i]) == 0 && i + 1 < argc) projection = argv[++i];
+		else if (strcmp("--models", argv[i]) == 0 && i + 1 < argc) models_fname = argv[++i];
+		else if (strcmp("--snapshot-out", argv[i]) == 0 && i + 1 < argc) snapshot_fname = argv[++i];
+		else if (strcmp("--snapshot-simplify", argv[i]) == 0) simplify_snapshot = 1;
+		else if (strcmp("--reorder", argv[i]) == 0) reorder = 1;
+		else if (strcmp("--stats", argv[i]) == 0) stats = 1;
+		else if (strcmp("--stats=json", argv[i]) == 0) stats = json_stats = 1;
+		else {
+			printf("%s", USAGE_MSG);
+			exit(1);
+		}
+	}
+	if ((cnf_fname == NULL) == (batch_source == NULL) || num_threads < 1 || ((proof_fname != NULL || trace_fname != NULL || enumerate || snapshot_fname != NULL || reorder || stats) && (num_threads > 1 || batch_source != NULL)) || (proof_fname != NULL && enumerate)) {
 		printf("%s", USAGE_MSG);
 		exit(1);
 	}
 
+	//several threads solve the cnf files of a directory or list, one file per thread at a time
+	if (batch_source != NULL)
+		return batch_sat(batch_source, num_threads, time_limit, (c2dSize)(memory_limit * 1024 * 1024)) == 0 ? 0 : 1;
+
+	//several threads split the cnf into cubes and solve them
+	if (num_threads > 1 && cubes) {
+		if (cube_sat(cnf_fname, num_threads)) printf("SAT\n");
+		else printf("UNSAT\n");
+		return 0;
+	}
+
+	//several threads race differently configured solvers on the cnf (-d makes the runs reproducible)
+	if (num_threads > 1) {
+		if (portfolio_sat(cnf_fname, num_threads, deterministic, NULL)) printf("SAT\n");
+		else printf("UNSAT\n");
+		return 0;
+	}
+
 	//construct a sat state and then check satisfiability
 	SatState* sat_state = sat_state_new(cnf_fname);
-	if (sat(sat_state)) printf("SAT\n");
+	BOOLEAN satisfiable;
+
+	//related variables and clauses are laid out next to each other in memory (the answers are the same)
+	if (reorder)
+		sat_state_reorder(NULL, sat_state);
+
+	//the parsed cnf (simplified by unit resolution if asked) is saved as a snapshot, which loads without parsing
+	if (snapshot_fname != NULL && !sat_snapshot_save(snapshot_fname, simplify_snapshot, sat_state)) {
+		fprintf(stderr, "Could not write %s\n", snapshot_fname);
+		exit(1);
+	}
+
+	//every model is written instead, one per line, each one found once
+	if (enumerate) {
+		FILE* models = models_fname == NULL ? stdout : fopen(models_fname, "w");
+		if (models == NULL) {
+			fprintf(stderr, "Could not open %s\n", models_fname);
+			exit(1);
+		}
+		printf("Models: %lu\n", enumerate_models(projection, models, sat_state));
+		if (models != stdout)
+			fclose(models);
+		if (stats)
+			print_stats(json_stats, sat_state);
+		sat_state_free(sat_state);
+		return 0;
+	}
+
+	//the learned clauses are written as a DRAT proof (of unsatisfiability) as they are asserted
+	if (proof_fname != NULL && !sat_proof_open(proof_fname, sat_state)) {
+		fprintf(stderr, "Could not open %s\n", proof_fname);
+		exit(1);
+	}
+
+	//the last events of the search are kept in a ring buffer, and saved for ./trace_decode to render
+	if (trace_fname != NULL && !sat_trace_start(traceEvents, sat_state)) {
+		fprintf(stderr, "The library was built without tracing\n");
+		exit(1);
+	}
+
+	//local search between restarts leads the decisions of the library's search
+	if (local_search_flips > 0) {
+		sat_set_seed(1, sat_state);
+		sat_set_restarts(100, 1, sat_state);
+		sat_set_local_search(local_search_flips, 5, sat_state);
+		satisfiable = sat_solve_with_assumptions(NULL, 0, sat_state);
+	}
+	else satisfiable = sat(sat_state);
+
+	if (proof_fname != NULL && !sat_proof_close(sat_state))
+		fprintf(stderr, "Could not write all of %s\n", proof_fname);
+	if (trace_fname != NULL && !sat_trace_save(trace_fname, sat_state))
+		fprintf(stderr, "Could not write %s\n", trace_fname);
+
+	if (satisfiable) printf("SAT\n");
 	else printf("UNSAT\n");
+
+	//the counters of the search, to size runs and compare library versions
+	if (stats)
+		print_stats(json_stats, sat_state);
 	sat_state_free(sat_state);
 
 	return 0;
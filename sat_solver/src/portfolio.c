@@ -0,0 +1,358 @@
+#include <pthread.h>
+
+#include "portfolio.h"
+
+#define ringSize 4096		//Number of clauses a worker keeps for the others to import
+#define slotLits 16			//Longest clause a worker can export
+#define shareSize 8			//Clauses with at most this many literals are exported
+#define shareLbd 2			//Clauses with at most this lbd are exported (up to slotLits literals)
+#define syncPeriod 20000	//Literals set by each worker between two exchanges in deterministic mode
+#define searchPeriod 10		//Restarts between two local searches of the workers which run them
+
+/******************************************************************************
+* Export rings
+*
+* A ring has a single writer (the worker that owns it) and many readers. A
+* slot is tagged with 2p+2 once the p^th exported clause is written into it,
+* and with an odd value while it is being written, so a reader can tell if
+* the clause it copied was overwritten in the meantime.
+******************************************************************************/
+
+typedef struct ring_slot_t {
+	unsigned long seq;				//2p+2 once the p^th exported clause is in the slot, odd while it is written
+	c2dSize size;					//Number of literals in the clause
+	c2dLiteral lits[slotLits];		//Indices of the literals in the clause
+} RingSlot;
+
+typedef struct export_ring_t {
+	unsigned long head;				//Number of clauses exported so far
+	RingSlot slots[ringSize];		//The last ringSize clauses exported
+} ExportRing;
+
+typedef struct portfolio_t Portfolio;
+
+//Clauses stored one after the other, each as its size followed by the indices of its literals
+typedef struct clause_buffer_t {
+	c2dSize size;					//Number of entries used
+	c2dSize capacity;				//Number of entries there is room for
+	c2dLiteral* entries;			//The entries
+} ClauseBuffer;
+
+typedef struct worker_t {
+	int id;							//Position of the worker in the portfolio
+	const SatState* original;		//Sat state of the cnf, cloned by the worker
+	Portfolio* portfolio;			//Portfolio the worker belongs to
+	ExportRing* ring;				//Clauses exported by the worker
+	unsigned long* cursors;			//Next clause to import from each of the other workers
+	ClauseBuffer pending;			//Clauses exported since the last exchange (deterministic mode)
+	ClauseBuffer published;			//Clauses exported before the last exchange (deterministic mode)
+	c2dSize syncs;					//Number of exchanges the worker took part in (deterministic mode)
+	volatile BOOLEAN stop;			//Set once the workers agreed on an answer (deterministic mode)
+	BOOLEAN result;					//Answer found by the worker, -1 until then
+	c2dSize conflicts;				//Contradictions found by the worker once it is done
+} Worker;
+
+struct portfolio_t {
+	int num_workers;				//Number of workers
+	Worker* workers;				//The workers
+	BOOLEAN deterministic;			//1 if clauses are only exchanged when every worker is at the same exchange
+	volatile BOOLEAN stop;			//Set once a worker found an answer
+	BOOLEAN result;					//Answer of the first worker to find one, -1 until then
+	c2dSize conflicts;				//Contradictions found by that worker
+	pthread_mutex_t lock;			//Protects result, and the exchange counts below
+	pthread_cond_t exchange;		//Signaled when the last worker arrives at an exchange
+	int arrived;					//Number of workers waiting at the current exchange
+	unsigned long exchanges;		//Number of times every worker arrived at an exchange
+};
+
+//Settings of the workers: worker i uses entry i (modulo the number of entries) and seed i
+static const struct {
+	c2dSize restart_interval;		//Contradictions before the first restart
+	BOOLEAN luby;					//1 for luby restarts, 0 for geometric ones
+	double random_freq;				//Fraction of random decisions
+	BOOLEAN phase;					//Phase of the first decision on each variable
+	c2dSize local_search_flips;		//Flips of each local search (0 for none)
+} worker_configs[] = {
+	{ 100, 1, 0, 0, 0 },
+	{ 512, 1, 0, 1, 100000 },
+	{ 100, 0, 0.01, 0, 0 },
+	{ 300, 0, 0.02, 1, 0 },
+	{ 50, 1, 0.05, 0, 20000 },
+	{ 1000, 0, 0, 1, 0 },
+};
+
+#define numConfigs (sizeof(worker_configs) / sizeof(worker_configs[0]))
+
+//Export a learned clause of a worker if it is short or has a low lbd (on_learned hook)
+static void export_clause(const Clause* clause, void* data) {
+	Worker* worker = (Worker*)data;
+	c2dSize size = sat_clause_size(clause);
+	if (size > slotLits || (size > shareSize && sat_clause_lbd(clause) > shareLbd))
+		return;
+
+	//Deterministic exports wait for the next exchange
+	if (worker->portfolio->deterministic) {
+		ClauseBuffer* buffer = &worker->pending;
+		if (buffer->size + size + 1 > buffer->capacity) {
+			buffer->capacity = 2 * (buffer->size + size + 1);
+			buffer->entries = (c2dLiteral*)realloc(buffer->entries, buffer->capacity * sizeof(c2dLiteral));
+		}
+		buffer->entries[buffer->size++] = size;
+		for (c2dSize i = 0; i < size; i++)
+			buffer->entries[buffer->size++] = sat_literal_index(sat_clause_literals(clause)[i]);
+		return;
+	}
+
+	ExportRing* ring = worker->ring;
+	unsigned long pos = ring->head;
+	RingSlot* slot = &ring->slots[pos % ringSize];
+
+	//Readers of the slot see it is being written before any literal changes
+	__atomic_store_n(&slot->seq, 2 * pos + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&slot->size, size, __ATOMIC_RELAXED);
+	for (c2dSize i = 0; i < size; i++)
+		__atomic_store_n(&slot->lits[i], sat_literal_index(sat_clause_literals(clause)[i]), __ATOMIC_RELAXED);
+
+	__atomic_store_n(&slot->seq, 2 * pos + 2, __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->head, pos + 1, __ATOMIC_RELEASE);
+}
+
+//Copy the pos^th clause exported into a ring
+//@return 1 if the copy is the clause, 0 if it was overwritten before or while it was copied
+static BOOLEAN read_slot(ExportRing* ring, unsigned long pos, c2dLiteral* lits, c2dSize* size) {
+	RingSlot* slot = &ring->slots[pos % ringSize];
+	unsigned long seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+	if (seq != 2 * pos + 2)
+		return 0;
+
+	*size = __atomic_load_n(&slot->size, __ATOMIC_RELAXED);
+	if (*size > slotLits)
+		return 0;
+	for (c2dSize i = 0; i < *size; i++)
+		lits[i] = __atomic_load_n(&slot->lits[i], __ATOMIC_RELAXED);
+
+	//The copy is only valid if the writer did not start on the slot again
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
+//Add the clauses exported by the other workers since the last restart (on_restart hook)
+static void import_clauses(SatState* sat_state, void* data) {
+	Worker* worker = (Worker*)data;
+	Portfolio* portfolio = worker->portfolio;
+	c2dLiteral indices[slotLits];
+	Lit* lits[slotLits];
+	c2dSize size;
+
+	for (int j = 0; j < portfolio->num_workers; j++) {
+		if (j == worker->id)
+			continue;
+		ExportRing* ring = portfolio->workers[j].ring;
+		unsigned long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+		//Clauses overwritten before this worker got to them are skipped
+		if (head - worker->cursors[j] > ringSize)
+			worker->cursors[j] = head - ringSize;
+
+		for (; worker->cursors[j] < head; worker->cursors[j]++) {
+			if (!read_slot(ring, worker->cursors[j], indices, &size))
+				continue;
+			for (c2dSize i = 0; i < size; i++)
+				lits[i] = sat_index2literal(indices[i], sat_state);
+			sat_add_clause(lits, size, sat_state);
+		}
+	}
+}
+
+/******************************************************************************
+* Deterministic exchanges
+*
+* In deterministic mode, a worker takes part in its k^th exchange at its
+* first restart after setting k*syncPeriod literals, so an exchange never
+* depends on how fast the threads run. An exchange waits for every worker.
+* Then each worker publishes the clauses it exported since the last one, and
+* adds the clauses published by the others in the order of the workers. A
+* worker which found an answer keeps taking part in exchanges, and the answer
+* of the first worker (by position) which had one at an exchange is kept.
+******************************************************************************/
+
+//Wait until every worker arrived at the current exchange
+static void wait_exchange(Portfolio* portfolio) {
+	pthread_mutex_lock(&portfolio->lock);
+	unsigned long exchange = portfolio->exchanges;
+	if (++portfolio->arrived == portfolio->num_workers) {
+		portfolio->arrived = 0;
+		portfolio->exchanges++;
+		pthread_cond_broadcast(&portfolio->exchange);
+	}
+	else {
+		while (portfolio->exchanges == exchange)
+			pthread_cond_wait(&portfolio->exchange, &portfolio->lock);
+	}
+	pthread_mutex_unlock(&portfolio->lock);
+}
+
+//Take part in an exchange, adding the clauses of the other workers to sat_state (if not NULL)
+static void exchange_clauses(Worker* worker, SatState* sat_state) {
+	Portfolio* portfolio = worker->portfolio;
+	Lit* lits[slotLits];
+
+	//The published clauses of the last exchange are no longer read by anyone
+	ClauseBuffer published = worker->published;
+	worker->published = worker->pending;
+	worker->pending = published;
+	worker->pending.size = 0;
+
+	wait_exchange(portfolio);
+
+	//Every worker agrees on the first answer found before the exchange
+	for (int j = 0; j < portfolio->num_workers; j++) {
+		if (portfolio->workers[j].result != -1) {
+			if (j == worker->id) {
+				portfolio->result = worker->result;
+				portfolio->conflicts = worker->conflicts;
+			}
+			worker->stop = 1;
+			return;
+		}
+	}
+
+	for (int j = 0; j < portfolio->num_workers && sat_state != NULL; j++) {
+		ClauseBuffer* buffer = &portfolio->workers[j].published;
+		if (j == worker->id)
+			continue;
+		for (c2dSize pos = 0; pos < buffer->size; pos += buffer->entries[pos] + 1) {
+			c2dSize size = buffer->entries[pos];
+			for (c2dSize i = 0; i < size; i++)
+				lits[i] = sat_index2literal(buffer->entries[pos + 1 + i], sat_state);
+			sat_add_clause(lits, size, sat_state);
+		}
+	}
+
+	//Published clauses stay untouched until every worker added them
+	wait_exchange(portfolio);
+	worker->syncs++;
+}
+
+//Take part in the exchanges the worker reached since its last restart (on_restart hook)
+static void sync_clauses(SatState* sat_state, void* data) {
+	Worker* worker = (Worker*)data;
+	while (!worker->stop && sat_propagation_count(sat_state) >= (worker->syncs + 1) * syncPeriod)
+		exchange_clauses(worker, sat_state);
+}
+
+/******************************************************************************
+* Workers
+******************************************************************************/
+
+//Clone the cnf's sat state, configure the clone and solve it
+static void* run_worker(void* data) {
+	Worker* worker = (Worker*)data;
+	Portfolio* portfolio = worker->portfolio;
+
+	SatState* sat_state = sat_state_clone(worker->original);
+
+	sat_set_seed(worker->id + 1, sat_state);
+	sat_set_random_freq(worker_configs[worker->id % numConfigs].random_freq, sat_state);
+	sat_set_default_phase(worker_configs[worker->id % numConfigs].phase, sat_state);
+	sat_set_restarts(worker_configs[worker->id % numConfigs].restart_interval, worker_configs[worker->id % numConfigs].luby, sat_state);
+	sat_set_local_search(worker_configs[worker->id % numConfigs].local_search_flips, searchPeriod, sat_state);
+	if (portfolio->deterministic) {
+		sat_set_stop_flag(&worker->stop, sat_state);
+		sat_set_hooks(export_clause, sync_clauses, worker, sat_state);
+	}
+	else {
+		sat_set_stop_flag(&portfolio->stop, sat_state);
+		sat_set_hooks(export_clause, import_clauses, worker, sat_state);
+	}
+
+	BOOLEAN result = sat_solve_with_assumptions(NULL, 0, sat_state);
+	worker->conflicts = sat_conflict_count(sat_state);
+
+	//The answer is only known to the others at the next exchange
+	if (portfolio->deterministic) {
+		worker->result = result;
+		while (!worker->stop)
+			exchange_clauses(worker, NULL);
+	}
+
+	//The first answer stops the other workers
+	else if (result != -1) {
+		pthread_mutex_lock(&portfolio->lock);
+		if (portfolio->result == -1) {
+			portfolio->result = result;
+			portfolio->conflicts = worker->conflicts;
+		}
+		portfolio->stop = 1;
+		pthread_mutex_unlock(&portfolio->lock);
+	}
+
+	sat_state_free(sat_state);
+	return NULL;
+}
+
+//solves the cnf in cnf_fname with num_workers differently configured workers running in parallel
+//returns 1 if the cnf is satisfiable, 0 otherwise, and stores the number of contradictions found
+//by the worker which answered in conflicts (if not NULL)
+BOOLEAN portfolio_sat(const char* cnf_fname, int num_workers, BOOLEAN deterministic, c2dSize* conflicts) {
+	Portfolio portfolio;
+	portfolio.num_workers = num_workers;
+	portfolio.workers = (Worker*)malloc(num_workers * sizeof(Worker));
+	portfolio.deterministic = deterministic;
+	portfolio.stop = 0;
+	portfolio.result = -1;
+	portfolio.conflicts = 0;
+	portfolio.arrived = 0;
+	portfolio.exchanges = 0;
+	pthread_mutex_init(&portfolio.lock, NULL);
+	pthread_cond_init(&portfolio.exchange, NULL);
+
+	pthread_t* threads = (pthread_t*)malloc(num_workers * sizeof(pthread_t));
+
+	//The cnf is only read once, the workers clone its sat state
+	SatState* original = sat_state_new(cnf_fname);
+
+	//Rings must exist before any worker can import from them
+	for (int i = 0; i < num_workers; i++) {
+		Worker* worker = &portfolio.workers[i];
+		worker->id = i;
+		worker->original = original;
+		worker->portfolio = &portfolio;
+		worker->ring = (ExportRing*)calloc(1, sizeof(ExportRing));
+		worker->cursors = (unsigned long*)calloc(num_workers, sizeof(unsigned long));
+		worker->pending.size = worker->pending.capacity = 0;
+		worker->pending.entries = NULL;
+		worker->published = worker->pending;
+		worker->syncs = 0;
+		worker->stop = 0;
+		worker->result = -1;
+		worker->conflicts = 0;
+	}
+
+	for (int i = 0; i < num_workers; i++)
+		pthread_create(&threads[i], NULL, run_worker, &portfolio.workers[i]);
+	for (int i = 0; i < num_workers; i++)
+		pthread_join(threads[i], NULL);
+
+	for (int i = 0; i < num_workers; i++) {
+		free(portfolio.workers[i].ring);
+		free(portfolio.workers[i].cursors);
+		free(portfolio.workers[i].pending.entries);
+		free(portfolio.workers[i].published.entries);
+	}
+	free(portfolio.workers);
+	free(threads);
+	sat_state_free(original);
+	pthread_mutex_destroy(&portfolio.lock);
+	pthread_cond_destroy(&portfolio.exchange);
+
+	if (conflicts != NULL)
+		*conflicts = portfolio.conflicts;
+	return portfolio.result;
+}
+
+/******************************************************************************
+* end
+******************************************************************************/
@@ -0,0 +1,26 @@
+#include <stdio.h>
+
+#include "sat_api.h"
+
+/******************************************************************************
+* Trace decoder
+*
+* Renders a trace saved by sat_trace_save() (see "./sat --trace <file>") as
+* text, one event per line, from the oldest event kept to the newest.
+******************************************************************************/
+
+int main(int argc, char* argv[]) {
+	if (argc != 2) {
+		printf("Usage: ./trace_decode <trace_file>\n");
+		return 1;
+	}
+	if (!sat_trace_decode(argv[1], stdout)) {
+		fprintf(stderr, "Could not read %s as a trace\n", argv[1]);
+		return 1;
+	}
+	return 0;
+}
+
+/******************************************************************************
+* end
+******************************************************************************/
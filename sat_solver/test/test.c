@@ -5,6 +5,9 @@ extern int test_run;
 
 #include <stdio.h>
 #include "sat_api.h"
+#include "portfolio.h"
+#include "cube.h"
+#include "batch.h"
 
 typedef unsigned long c2dSize;  //for variables, clauses, and various things
 typedef signed long c2dLiteral; //for literals
@@ -153,6 +156,640 @@ static char* test_undo_decide_literal() {
 	return 0;
 }
 
+static char* test_solve_with_assumptions() {
+	SatState* s = sat_state_new("test/test.cnf");
+	mu_assert("CNF not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+	
+	// The model satisfies every clause
+	for(c2dSize i = 1; i <= sat_clause_count(s); i++) {
+		Clause* clause = sat_index2clause(i, s);
+		BOOLEAN satisfied = 0;
+		for(c2dSize j = 0; j < sat_clause_size(clause); j++) {
+			Lit* lit = sat_clause_literals(clause)[j];
+			if(sat_model_value(sat_literal_var(lit)) == (sat_literal_index(lit) > 0))
+				satisfied = 1;
+		}
+		mu_assert("Model does not satisfy clause i", satisfied == 1);
+	}
+	mu_assert("Solving left a variable instantiated", sat_instantiated_var(sat_index2var(1, s)) == 0);
+	
+	// -1 implies 2 (clause 1), which contradicts -2; 5 plays no part
+	Lit* assumptions[3] = { sat_index2literal(5, s), sat_index2literal(-1, s), sat_index2literal(-2, s) };
+	mu_assert("Contradicting assumptions satisfiable", sat_solve_with_assumptions(assumptions, 3, s) == 0);
+	c2dSize count;
+	Lit** failed = sat_failed_assumptions(&count, s);
+	mu_assert("Wrong number of failed assumptions", count == 2);
+	for(c2dSize i = 0; i < count; i++) {
+		mu_assert("Assumption 5 failed", sat_literal_index(failed[i]) != 5);
+	}
+	
+	// The same state can be solved again
+	mu_assert("CNF not satisfiable after failed assumptions", sat_solve_with_assumptions(assumptions, 1, s) == 1);
+	mu_assert("Assumption 5 not in model", sat_model_value(sat_index2var(5, s)) == 1);
+	
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_add_clause() {
+	SatState* s = sat_state_new("test/test.cnf");
+	mu_assert("CNF not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+	
+	// Adding -1 and -2 as unit clauses contradicts clause 1
+	Lit* lit = sat_index2literal(-1, s);
+	mu_assert("Clause not added", sat_add_clause(&lit, 1, s) != NULL);
+	mu_assert("CNF with -1 not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+	mu_assert("Added clause -1 not in model", sat_model_value(sat_index2var(1, s)) == 0);
+	lit = sat_index2literal(-2, s);
+	sat_add_clause(&lit, 1, s);
+	mu_assert("CNF with -1 and -2 satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	
+	c2dSize count;
+	sat_failed_assumptions(&count, s);
+	mu_assert("Failed assumptions without assumptions", count == 0);
+	mu_assert("Original clauses changed", sat_clause_count(s) == 18);
+	sat_state_free(s);
+
+	// Learned and added clauses are numbered from one sequence after the cnf
+	s = sat_state_new("test/unsat.cnf");
+	sat_solve_with_assumptions(NULL, 0, s);
+	c2dSize learned = sat_learned_clause_count(s);
+	lit = sat_index2literal(1, s);
+	Clause* added = sat_add_clause(&lit, 1, s);
+	mu_assert("Added clause numbered like a learned one", learned > 0 && sat_clause_index(added) == sat_clause_count(s) + learned + 1);
+
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_state_clone() {
+	SatState* s = sat_state_new("test/test.cnf");
+	Lit* lit = sat_index2literal(-1, s);
+	sat_add_clause(&lit, 1, s);
+	sat_decide_literal(sat_index2literal(3, s), s);
+
+	SatState* clone = sat_state_clone(s);
+	sat_undo_decide_literal(s);
+	sat_state_free(s);
+
+	mu_assert("Clone has different clauses", sat_clause_count(clone) == 18 && sat_var_count(clone) == 11);
+	mu_assert("Clone is not at the start level", sat_instantiated_var(sat_index2var(3, clone)) == 0);
+	mu_assert("Clone not satisfiable", sat_solve_with_assumptions(NULL, 0, clone) == 1);
+	mu_assert("Clone lost the added clause -1", sat_model_value(sat_index2var(1, clone)) == 0);
+
+	SatState* second = sat_state_clone(clone);
+	lit = sat_index2literal(-2, second);
+	sat_add_clause(&lit, 1, second);
+	mu_assert("Clone with -1 and -2 satisfiable", sat_solve_with_assumptions(NULL, 0, second) == 0);
+	mu_assert("Clause added to a clone changed the original", sat_solve_with_assumptions(NULL, 0, clone) == 1);
+
+	sat_state_free(clone);
+	sat_state_free(second);
+	return 0;
+}
+
+static char* test_state_renew() {
+	SatState* s = sat_state_new("test/test.cnf");
+	mu_assert("CNF not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+
+	s = sat_state_renew(s, "test/unsat.cnf");
+	mu_assert("Renewed state has the old variables", sat_var_count(s) == 20 && sat_clause_count(s) == 45);
+	mu_assert("Renewed pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+
+	s = sat_state_renew(s, "test/test.cnf");
+	mu_assert("State renewed twice has the old clauses", sat_var_count(s) == 11 && sat_learned_clause_count(s) == 0);
+	mu_assert("State renewed twice not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_local_search() {
+	SatState* s = sat_state_new("test/test.cnf");
+	sat_set_seed(7, s);
+	mu_assert("Local search left clauses falsified", sat_local_search(10000, s) == 0);
+	sat_set_local_search(1000, 1, s);
+	mu_assert("CNF not satisfiable with local search", sat_solve_with_assumptions(NULL, 0, s) == 1);
+
+	//Searches after the first reuse their arrays, which grow with the added clauses, and keep the
+	//variables set at the start level
+	Lit* lit = sat_index2literal(-1, s);
+	sat_add_clause(&lit, 1, s);
+	mu_assert("Unit resolution failed on the added clause", sat_unit_resolution(s));
+	mu_assert("Local search left the added clause falsified", sat_local_search(10000, s) == 0);
+	sat_undo_unit_resolution(s);
+	mu_assert("CNF with -1 not satisfiable with local search", sat_solve_with_assumptions(NULL, 0, s) == 1 && sat_model_value(sat_index2var(1, s)) == 0);
+	sat_state_free(s);
+
+	s = sat_state_new("test/unsat.cnf");
+	sat_set_local_search(1000, 1, s);
+	mu_assert("Local search made pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_proof() {
+	SatState* s = sat_state_new("test/unsat.cnf");
+	mu_assert("Proof file not opened", sat_proof_open("test/unsat.drat", s));
+	mu_assert("Pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	mu_assert("Proof not written", sat_proof_close(s));
+	mu_assert("Proof closed twice", !sat_proof_close(s));
+	sat_state_free(s);
+
+	//The proof starts with an addition and ends with the empty clause
+	unsigned char proof[1 << 16];
+	FILE* file = fopen("test/unsat.drat", "rb");
+	size_t size = fread(proof, 1, sizeof(proof), file);
+	fclose(file);
+	remove("test/unsat.drat");
+	mu_assert("Proof has no empty clause", size > 3 && proof[0] == 'a' && proof[size - 3] == 0 && proof[size - 2] == 'a' && proof[size - 1] == 0);
+	return 0;
+}
+
+static BOOLEAN count_model(Lit** lits, c2dSize num_lits, void* count) {
+	(*(c2dSize*)count)++;
+	return 1;
+}
+
+static char* test_enumerate_models() {
+	SatState* s = sat_state_new("test/test.cnf");
+	c2dSize n = sat_var_count(s);
+
+	//Count the models, and the models projected onto the first 3 variables, by brute force
+	c2dSize expected = 0;
+	BOOLEAN projected[8] = { 0 };
+	for (unsigned long bits = 0; bits < (1UL << n); bits++) {
+		BOOLEAN satisfied = 1;
+		for (c2dSize i = 1; i <= sat_clause_count(s) && satisfied; i++) {
+			Clause* clause = sat_index2clause(i, s);
+			satisfied = 0;
+			for (c2dSize j = 0; j < sat_clause_size(clause); j++) {
+				c2dLiteral lit = sat_literal_index(sat_clause_literals(clause)[j]);
+				if (((bits >> ((lit > 0 ? lit : -lit) - 1)) & 1) == (lit > 0))
+					satisfied = 1;
+			}
+		}
+		expected += satisfied;
+		if (satisfied)
+			projected[bits & 7] = 1;
+	}
+
+	c2dSize count = 0;
+	mu_assert("Wrong number of models", sat_enumerate_models(NULL, 0, count_model, &count, s) == expected && count == expected);
+	sat_state_free(s);
+
+	s = sat_state_new("test/test.cnf");
+	Var* vars[3] = { sat_index2var(1, s), sat_index2var(2, s), sat_index2var(3, s) };
+	c2dSize expected_projected = 0;
+	for (int i = 0; i < 8; i++)
+		expected_projected += projected[i];
+	mu_assert("Wrong number of projected models", sat_enumerate_models(vars, 3, count_model, &count, s) == expected_projected);
+	sat_state_free(s);
+
+	//Blocking clauses would make a proof fail to check
+	s = sat_state_new("test/test.cnf");
+	mu_assert("Proof file not opened", sat_proof_open("test/test.drat", s));
+	count = 0;
+	mu_assert("Models enumerated while a proof is open", sat_enumerate_models(NULL, 0, count_model, &count, s) == 0 && count == 0);
+	sat_proof_close(s);
+	sat_state_free(s);
+	remove("test/test.drat");
+
+	s = sat_state_new("test/unsat.cnf");
+	mu_assert("Pigeonhole has models", sat_enumerate_models(NULL, 0, count_model, &count, s) == 0);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_cnf_format() {
+	SatState* s = sat_state_new("test/format.cnf");
+	mu_assert("Wrong counts", sat_var_count(s) == 4 && sat_clause_count(s) == 3);
+
+	//Clauses: 1 -2 3, -1 4, 2 -3 -4
+	c2dLiteral expected[3][3] = { { 1, -2, 3 }, { -1, 4, 0 }, { 2, -3, -4 } };
+	c2dSize sizes[3] = { 3, 2, 3 };
+	for (c2dSize i = 0; i < 3; i++) {
+		Clause* clause = sat_index2clause(i + 1, s);
+		mu_assert("Wrong clause size", sat_clause_size(clause) == sizes[i]);
+		for (c2dSize j = 0; j < sizes[i]; j++)
+			mu_assert("Wrong literal", sat_literal_index(sat_clause_literals(clause)[j]) == expected[i][j]);
+	}
+	sat_state_free(s);
+
+	//A compressed cnf is read through a pipe
+	s = sat_state_new("test/test.cnf.gz");
+	mu_assert("Wrong counts of compressed cnf", sat_var_count(s) == 11 && sat_clause_count(s) == 18);
+	mu_assert("Compressed cnf not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+
+	//Files which are not cnfs are reported instead of ending the process
+	char error[500];
+	s = sat_state_try_renew(s, "test/bad.cnf", error, sizeof(error));
+	mu_assert("Literal over a missing variable read", s == NULL && strstr(error, "Literal 4 of test/bad.cnf") != NULL);
+
+	//A failed renew frees the clauses of the cnf it replaced
+	c2dSize huge;
+	c2dSize clause_bytes = sat_region_usage(clauseRegion, &huge);
+	s = sat_state_new("test/unsat.cnf");
+	mu_assert("Missing file renewed", sat_state_try_renew(s, "test/missing.cnf", error, sizeof(error)) == NULL);
+	mu_assert("Failed renew kept the clauses of the cnf", sat_region_usage(clauseRegion, &huge) == clause_bytes);
+	mu_assert("Missing file read", sat_state_try_new("test/missing.cnf", error, sizeof(error)) == NULL && strstr(error, "Could not open") != NULL);
+	mu_assert("Cnf without problem line read", sat_state_try_new("test/batch.list", error, sizeof(error)) == NULL);
+	s = sat_state_try_new("test/format.cnf", error, sizeof(error));
+	mu_assert("Wrong counts after errors", s != NULL && sat_var_count(s) == 4 && sat_clause_count(s) == 3);
+	sat_state_free(s);
+	return 0;
+}
+
+//returns literal j of clause i of the cnf written by test_parallel_parse()
+//(no two clauses have the same variables, so none is a duplicate)
+static c2dLiteral big_cnf_literal(c2dSize i, c2dSize j) {
+	c2dSize var = j == 0 ? i % 997 + 1 : j == 1 ? (i / 997) % 251 + 998 : i % 500 + 1300;
+	return (i * 2654435761UL + j * 40503UL) % 3 ? (c2dLiteral)var : -(c2dLiteral)var;
+}
+
+static char* test_parallel_parse() {
+	//A cnf of a few MB is cut into chunks, which must not change the clauses or their order
+	c2dSize num_clauses = 250000;
+	FILE* file = fopen("test/big.cnf", "w");
+	fprintf(file, "c parsed in chunks\np cnf 2000 %lu\n", num_clauses);
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		if (i % 1000 == 0)
+			fprintf(file, "c clause %lu\n0\n", i);
+		fprintf(file, "%ld %ld%s%ld 0\n", big_cnf_literal(i, 0), big_cnf_literal(i, 1), i % 7 ? " " : "\n", big_cnf_literal(i, 2));
+	}
+	fclose(file);
+
+	SatState* s = sat_state_new("test/big.cnf");
+	remove("test/big.cnf");
+	mu_assert("Wrong counts of chunked cnf", sat_var_count(s) == 2000 && sat_clause_count(s) == num_clauses);
+	for (c2dSize i = 1; i <= num_clauses; i++) {
+		Clause* clause = sat_index2clause(i, s);
+		mu_assert("Wrong clause size in chunked cnf", sat_clause_size(clause) == 3);
+		for (c2dSize j = 0; j < 3; j++)
+			mu_assert("Wrong literal in chunked cnf", sat_literal_index(sat_clause_literals(clause)[j]) == big_cnf_literal(i, j));
+	}
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_snapshot() {
+	SatState* s = sat_state_new("test/format.cnf");
+	mu_assert("Snapshot not written", sat_snapshot_save("test/format.snap", 0, s));
+
+	//The snapshot is read into the same clauses, also when a sat state is renewed from it
+	SatState* loaded = sat_state_new("test/format.snap");
+	for (int k = 0; k < 2; k++) {
+		mu_assert("Wrong counts of snapshot", sat_var_count(loaded) == 4 && sat_clause_count(loaded) == 3);
+		for (c2dSize i = 1; i <= 3; i++) {
+			Clause* clause = sat_index2clause(i, s);
+			Clause* copy = sat_index2clause(i, loaded);
+			mu_assert("Wrong clause size in snapshot", sat_clause_size(copy) == sat_clause_size(clause));
+			for (c2dSize j = 0; j < sat_clause_size(clause); j++)
+				mu_assert("Wrong literal in snapshot", sat_literal_index(sat_clause_literals(copy)[j]) == sat_literal_index(sat_clause_literals(clause)[j]));
+		}
+		loaded = sat_state_renew(loaded, "test/format.snap");
+	}
+	sat_state_free(loaded);
+	sat_state_free(s);
+	remove("test/format.snap");
+
+	//A simplified snapshot keeps the models
+	c2dSize count = 0, simplified_count = 0;
+	s = sat_state_new("test/test.cnf");
+	mu_assert("Simplified snapshot not written", sat_snapshot_save("test/test.snap", 1, s));
+	sat_enumerate_models(NULL, 0, count_model, &count, s);
+	sat_state_free(s);
+	s = sat_state_new("test/test.snap");
+	sat_enumerate_models(NULL, 0, count_model, &simplified_count, s);
+	sat_state_free(s);
+	remove("test/test.snap");
+	mu_assert("Simplified snapshot changed the models", count > 0 && count == simplified_count);
+	return 0;
+}
+
+static char* test_normalize() {
+	//Kept: 1 -2, 3, -1 2 -3 (in that order)
+	SatState* s = sat_state_new("test/dup.cnf");
+	mu_assert("Wrong clause count after normalizing", sat_clause_count(s) == 3);
+	mu_assert("Wrong counts of removed literals and clauses", sat_duplicate_literal_count(s) == 2 && sat_tautology_count(s) == 1 && sat_duplicate_clause_count(s) == 2);
+	c2dLiteral expected[3][3] = { { 1, -2, 0 }, { 3, 0, 0 }, { -1, 2, -3 } };
+	c2dSize sizes[3] = { 2, 1, 3 };
+	for (c2dSize i = 0; i < 3; i++) {
+		Clause* clause = sat_index2clause(i + 1, s);
+		mu_assert("Wrong normalized clause size", sat_clause_size(clause) == sizes[i]);
+		for (c2dSize j = 0; j < sizes[i]; j++)
+			mu_assert("Wrong normalized literal", sat_literal_index(sat_clause_literals(clause)[j]) == expected[i][j]);
+	}
+	mu_assert("Normalized cnf not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_builder() {
+	//The clauses of test/dup.cnf, given once copied and once borrowed
+	c2dLiteral lits[] = { 1, 1, -2, 2, -2, 3, -2, 1, 3, 3, 3, -1, 2, -3 };
+	c2dSize offsets[] = { 0, 3, 6, 8, 9, 9, 11, 14 };
+	c2dLiteral original[14];
+	memcpy(original, lits, sizeof(lits));
+
+	SatBuilder* builder = sat_builder_new(2);
+	for (c2dSize i = 0; i < 7; i++)
+		sat_builder_add_clause(lits + offsets[i], offsets[i + 1] - offsets[i], builder);
+	SatState* s = sat_builder_finish(builder);
+	mu_assert("Wrong counts of a built cnf", sat_var_count(s) == 3 && sat_clause_count(s) == 3);
+	mu_assert("Wrong counts of removed literals and clauses", sat_duplicate_literal_count(s) == 2 && sat_tautology_count(s) == 1 && sat_duplicate_clause_count(s) == 2);
+	mu_assert("Built cnf not satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 1);
+	sat_state_free(s);
+
+	//Borrowed clauses which must be cleaned up are copied first
+	builder = sat_builder_new(3);
+	sat_builder_borrow_clauses(lits, offsets, 7, builder);
+	s = sat_builder_finish(builder);
+	mu_assert("Wrong clause count of a borrowed cnf", sat_clause_count(s) == 3 && sat_duplicate_clause_count(s) == 2);
+	mu_assert("Borrowed literals changed", memcmp(lits, original, sizeof(lits)) == 0);
+	c2dLiteral expected[] = { 1, -2, 3, -1, 2, -3 };
+	for (c2dSize i = 1, k = 0; i <= 3; i++)
+		for (c2dSize j = 0; j < sat_clause_size(sat_index2clause(i, s)); j++)
+			mu_assert("Wrong literal of a borrowed cnf", sat_literal_index(sat_clause_literals(sat_index2clause(i, s))[j]) == expected[k++]);
+
+	//Clean borrowed clauses are used where they lie, and an added clause makes the cnf unsatisfiable
+	c2dLiteral clean[] = { 1, 2, -1, 2, 1, -2 };
+	c2dSize clean_offsets[] = { 0, 2, 4, 6 };
+	builder = sat_builder_new(2);
+	sat_builder_borrow_clauses(clean, clean_offsets, 3, builder);
+	c2dLiteral last[] = { -1, -2 };
+	sat_builder_add_clause(last, 2, builder);
+	SatState* t = sat_builder_finish(builder);
+	mu_assert("Wrong clause count of a built cnf", sat_clause_count(t) == 4);
+	mu_assert("Built cnf satisfiable", sat_solve_with_assumptions(NULL, 0, t) == 0);
+	sat_state_free(t);
+
+	//Renewing a sat state over borrowed clauses leaves them alone
+	builder = sat_builder_new(2);
+	sat_builder_borrow_clauses(clean, clean_offsets, 3, builder);
+	t = sat_builder_finish(builder);
+	mu_assert("Borrowed cnf not satisfiable", sat_solve_with_assumptions(NULL, 0, t) == 1);
+	t = sat_state_renew(t, "test/dup.cnf");
+	mu_assert("Wrong clause count after renewing", sat_clause_count(t) == 3);
+	mu_assert("Borrowed literals changed", clean[0] == 1 && clean[5] == -2);
+	sat_state_free(t);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_batch() {
+	//test/bad.cnf is reported as an error, and the workers go on with the other files
+	mu_assert("Batch failed on a good file", batch_sat("test/batch.list", 2, 0, 0) == 1);
+	mu_assert("Single worker batch failed on a good file", batch_sat("test/batch.list", 1, 0, 0) == 1);
+	mu_assert("Batch solved a file past a tiny memory limit", batch_sat("test/batch.list", 1, 0, 1) == 3);
+	mu_assert("Batch read a missing list", batch_sat("test/missing.list", 1, 0, 0) == -1);
+	return 0;
+}
+
+static char* test_restarts_and_stop() {
+	SatState* s = sat_state_new("test/unsat.cnf");
+	sat_set_seed(7, s);
+	sat_set_random_freq(0.1, s);
+	sat_set_restarts(2, 1, s);
+	mu_assert("Pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	mu_assert("No clause learned", sat_learned_clause_count(s) > 0);
+	sat_state_free(s);
+	
+	// A stopped state gives no answer
+	s = sat_state_new("test/test.cnf");
+	volatile BOOLEAN stop = 1;
+	sat_set_stop_flag(&stop, s);
+	mu_assert("Stopped state answered", sat_solve_with_assumptions(NULL, 0, s) == -1);
+	mu_assert("Stopped state left a variable instantiated", sat_instantiated_var(sat_index2var(1, s)) == 0);
+	
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_portfolio() {
+	mu_assert("Portfolio found test.cnf unsatisfiable", portfolio_sat("test/test.cnf", 4, 0, NULL) == 1);
+	mu_assert("Portfolio found pigeonhole satisfiable", portfolio_sat("test/unsat.cnf", 4, 0, NULL) == 0);
+	return 0;
+}
+
+static char* test_deterministic_portfolio() {
+	c2dSize first, second;
+	mu_assert("Deterministic portfolio found pigeonhole satisfiable", portfolio_sat("test/unsat.cnf", 4, 1, &first) == 0);
+	mu_assert("Deterministic portfolio answered differently", portfolio_sat("test/unsat.cnf", 4, 1, &second) == 0);
+	mu_assert("Deterministic portfolio found different contradictions", first == second);
+	mu_assert("Deterministic portfolio found test.cnf unsatisfiable", portfolio_sat("test/test.cnf", 3, 1, NULL) == 1);
+	return 0;
+}
+
+static char* test_cube() {
+	mu_assert("Cubes found test.cnf unsatisfiable", cube_sat("test/test.cnf", 4) == 1);
+	mu_assert("Cubes found pigeonhole satisfiable", cube_sat("test/unsat.cnf", 4) == 0);
+	mu_assert("Single worker found pigeonhole satisfiable", cube_sat("test/unsat.cnf", 1) == 0);
+	return 0;
+}
+
+static char* test_allocations() {
+	//Pigeons 1 and 2 in holes 1 and 2, then pigeon 3 in hole 3 leaves no hole for pigeon 5
+	SatState* s = sat_state_new("test/unsat.cnf");
+	Lit* decided[] = { sat_index2literal(1, s), sat_index2literal(6, s) };
+	Lit* conflicting = sat_index2literal(11, s);
+	mu_assert("Contradiction at the start level", sat_unit_resolution(s));
+
+	//Once its pools have grown, deciding, propagating, analyzing the contradiction and undoing allocate nothing
+	c2dSize warm = 0;
+	for (int round = 0; round < 10; round++) {
+		if (round == 2)
+			warm = sat_allocation_count();
+		for (int i = 0; i < 2; i++)
+			mu_assert("Contradiction before the lookahead", sat_decide_literal(decided[i], s) == NULL);
+		mu_assert("Lookahead without contradiction", sat_lookahead_literal(conflicting, s) == -1);
+		sat_undo_decide_literal(s);
+		sat_undo_decide_literal(s);
+	}
+	mu_assert("Allocation after warmup", sat_allocation_count() == warm);
+	sat_undo_unit_resolution(s);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_regions() {
+	//A small block lies in the malloc heap, a large one (a megabyte or more) in a mapping of its own
+	size_t megabyte = (size_t)1 << 20;
+	c2dSize before;
+	c2dSize huge;
+	char* small = (char*)sat_region_calloc(100, cacheRegion);
+	char* large = (char*)sat_region_calloc(3 * megabyte, cacheRegion);
+	mu_assert("Small block not zeroed", small[0] == 0 && small[99] == 0);
+	mu_assert("Large block not zeroed", large[0] == 0 && large[3 * megabyte - 1] == 0);
+	before = sat_region_usage(cacheRegion, &huge);
+	mu_assert("Region usage not counted", before >= 3 * megabyte + 100);
+
+	//Growing a large block within its mapping keeps it where it is, and its bytes
+	large[12345] = 7;
+	mu_assert("Block moved within its mapping", sat_region_realloc(large, 4 * megabyte, cacheRegion) == large);
+	mu_assert("Block lost its bytes", large[12345] == 7);
+	small = (char*)sat_region_realloc(small, 2 * megabyte, cacheRegion);
+	mu_assert("Moved block not counted", sat_region_usage(cacheRegion, &huge) == before + megabyte * 3 - 100);
+
+	sat_region_free(small);
+	sat_region_free(large);
+	mu_assert("Region usage not released", sat_region_usage(cacheRegion, &huge) == before - 3 * megabyte - 100);
+	return 0;
+}
+
+static char* test_reorder() {
+	//The variables laid out from last to first in one sat state, and by the primal graph in another
+	SatState* s = sat_state_new("test/test.cnf");
+	SatState* t = sat_state_new("test/test.cnf");
+	SatState* u = sat_state_new("test/test.cnf");
+	c2dSize n = sat_var_count(s);
+	c2dSize* order = (c2dSize*)malloc(n * sizeof(c2dSize));
+	for (c2dSize i = 0; i < n; i++)
+		order[i] = i == 0 ? n - 1 : n - i;
+	mu_assert("Order listing a variable twice accepted", !sat_state_reorder(order, s));
+	order[0] = n;
+	mu_assert("Reverse order rejected", sat_state_reorder(order, s));
+	mu_assert("Primal graph order rejected", sat_state_reorder(NULL, t));
+	mu_assert("Variables not laid out in order", (char*)sat_index2var(n, s) < (char*)sat_index2var(1, s));
+
+	//Indices stay the same, and so do the clauses
+	for (c2dSize i = 1; i <= n; i++) {
+		Var* var = sat_index2var(i, s);
+		mu_assert("Variable index changed", sat_var_index(var) == i && sat_literal_var(sat_pos_literal(var)) == var);
+		mu_assert("Literal index changed", sat_literal_index(sat_index2literal(-(c2dLiteral)i, s)) == -(c2dLiteral)i);
+	}
+	for (c2dSize i = 1; i <= sat_clause_count(s); i++) {
+		for (int k = 0; k < 2; k++) {
+			Clause* clause = sat_index2clause(i, k == 0 ? s : t);
+			Clause* original = sat_index2clause(i, u);
+			mu_assert("Clause index changed", sat_clause_index(clause) == i && sat_clause_size(clause) == sat_clause_size(original));
+			for (c2dSize j = 0; j < sat_clause_size(clause); j++)
+				mu_assert("Clause literal changed", sat_literal_index(sat_clause_literals(clause)[j]) == sat_literal_index(sat_clause_literals(original)[j]));
+		}
+	}
+
+	//The search goes the same way, in clones too, and a sat state which was searched is not laid out anew
+	SatState* clone = sat_state_clone(s);
+	mu_assert("Clone variables not laid out in order", (char*)sat_index2var(n, clone) < (char*)sat_index2var(1, clone));
+	BOOLEAN result = sat_solve_with_assumptions(NULL, 0, u);
+	mu_assert("Reordered search differs", sat_solve_with_assumptions(NULL, 0, s) == result && sat_conflict_count(s) == sat_conflict_count(u));
+	mu_assert("Reordered clone search differs", sat_solve_with_assumptions(NULL, 0, clone) == result && sat_conflict_count(clone) == sat_conflict_count(u));
+	mu_assert("Decided sat state reordered", sat_decide_literal(sat_index2literal(1, t), t) != NULL || !sat_state_reorder(NULL, t));
+	free(order);
+	sat_state_free(s);
+	sat_state_free(t);
+	sat_state_free(u);
+	sat_state_free(clone);
+	return 0;
+}
+
+static char* test_unit_kernels() {
+	//A clause of each size (with a kernel of its own up to 4 literals) is made unit with its free literal at each place
+	for (c2dLiteral size = 2; size <= 5; size++) {
+		c2dLiteral lits[] = { 1, 2, 3, 4, 5 };
+		for (c2dLiteral free_lit = 1; free_lit <= size; free_lit++) {
+			SatBuilder* builder = sat_builder_new(size);
+			sat_builder_add_clause(lits, size, builder);
+			SatState* s = sat_builder_finish(builder);
+			for (c2dLiteral i = 1; i <= size; i++)
+				if (i != free_lit)
+					mu_assert("Contradiction before the clause is unit", sat_decide_literal(sat_index2literal(-i, s), s) == NULL);
+			mu_assert("Free literal of a unit clause not implied", sat_implied_literal(sat_index2literal(free_lit, s)));
+			sat_state_free(s);
+		}
+	}
+	return 0;
+}
+
+static char* test_scenarios() {
+	//1 -> 2 -> 3 -> -4, and 1 or 4
+	SatBuilder* builder = sat_builder_new(4);
+	c2dLiteral clauses[4][2] = { { -1, 2 }, { -2, 3 }, { -3, -4 }, { 1, 4 } };
+	for (int i = 0; i < 4; i++)
+		sat_builder_add_clause(clauses[i], 2, builder);
+	SatState* s = sat_builder_finish(builder);
+
+	//Scenario 0 assumes 1, scenario 1 assumes 4, scenario 2 both, scenario 3 nothing and scenario 4 assumes -1
+	c2dScenarios true_masks[5] = { 0, 1 | 4, 0, 0, 2 | 4 };
+	c2dScenarios false_masks[5] = { 0, 16, 0, 0, 0 };
+	mu_assert("Wrong scenarios with a contradiction", sat_propagate_scenarios(true_masks, false_masks, s) == 4);
+	mu_assert("Wrong literals implied by 1", (true_masks[2] & 1) && (true_masks[3] & 1) && (false_masks[4] & 1));
+	mu_assert("Wrong literals implied by 4", (false_masks[3] & 2) && (false_masks[2] & 2) && (false_masks[1] & 2) && !(true_masks[1] & 2));
+	for (c2dSize i = 1; i <= 4; i++)
+		mu_assert("Literal implied by no assumption", !(true_masks[i] & 8) && !(false_masks[i] & 8));
+	mu_assert("Wrong literals implied by -1", (true_masks[4] & 16) && (false_masks[3] & 16) && (false_masks[2] & 16));
+
+	//The literals set hold in every scenario, and the sat state is left as it was
+	mu_assert("Contradiction deciding 2", sat_decide_literal(sat_index2literal(2, s), s) == NULL);
+	c2dScenarios set_true[5] = { 0 }, set_false[5] = { 0 };
+	set_false[1] = 1;
+	mu_assert("No contradiction assuming -1 with 2 set", sat_propagate_scenarios(set_true, set_false, s) == 1);
+	mu_assert("Literals set missing from scenarios", set_true[1] == ~(c2dScenarios)0 && set_true[3] == ~(c2dScenarios)0 && set_false[4] == ~(c2dScenarios)0);
+	c2dScenarios no_true[5] = { 0 }, no_false[5] = { 0 };
+	mu_assert("Contradiction without assumptions", sat_propagate_scenarios(no_true, no_false, s) == 0);
+	mu_assert("Scenarios changed the sat state", sat_implied_literal(sat_index2literal(1, s)) && !sat_implied_literal(sat_index2literal(-1, s)));
+	sat_undo_decide_literal(s);
+	sat_state_free(s);
+	return 0;
+}
+
+static char* test_trace() {
+	SatState* s = sat_state_new("test/unsat.cnf");
+	mu_assert("Events recorded before tracing", sat_trace_count(s) == 0 && !sat_trace_save("test/unsat.trace", s));
+	mu_assert("Tracing not started", sat_trace_start(16, s));
+	mu_assert("Pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	mu_assert("Fewer events than the ring buffer keeps", sat_trace_count(s) > 16);
+	mu_assert("Trace not saved", sat_trace_save("test/unsat.trace", s));
+	sat_trace_stop(s);
+	mu_assert("Events recorded after tracing stopped", sat_trace_count(s) == 0);
+	sat_state_free(s);
+
+	//The last 16 events are rendered, the last one being the contradiction at the start level
+	FILE* out = fopen("test/unsat.trace.txt", "w");
+	mu_assert("Trace not decoded", sat_trace_decode("test/unsat.trace", out));
+	fclose(out);
+	char line[256], last[256] = "";
+	int num_lines = 0;
+	FILE* in = fopen("test/unsat.trace.txt", "r");
+	while (fgets(line, sizeof(line), in) != NULL) {
+		num_lines++;
+		strcpy(last, line);
+	}
+	fclose(in);
+	remove("test/unsat.trace");
+	remove("test/unsat.trace.txt");
+	mu_assert("Wrong number of events decoded", num_lines == 17);
+	mu_assert("Trace does not end with the empty clause", strstr(last, "learn 0 size 0 level 1") != NULL);
+	mu_assert("File other than a trace decoded", !sat_trace_decode("test/unsat.cnf", stdout));
+	return 0;
+}
+
+static char* test_stats() {
+	SatState* s = sat_state_new("test/unsat.cnf");
+	SatStats stats;
+	sat_state_stats(&stats, s);
+	mu_assert("Counters of a new sat state not 0", stats.decisions == 0 && stats.conflicts == 0 && stats.learned == 0 && stats.restarts == 0);
+
+	sat_set_restarts(2, 1, s);
+	mu_assert("Pigeonhole satisfiable", sat_solve_with_assumptions(NULL, 0, s) == 0);
+	sat_state_stats(&stats, s);
+	mu_assert("Wrong number of contradictions", stats.conflicts == sat_conflict_count(s) && stats.conflicts > 0);
+	mu_assert("Fewer propagations than decisions", stats.decisions > 0 && stats.propagations >= stats.decisions && stats.propagations == sat_propagation_count(s));
+	mu_assert("No restarts", stats.restarts > 0);
+
+	//Every learned clause asserted is in one bucket of each histogram, and the empty clause is dropped
+	c2dSize sizes = 0, lbds = 0;
+	for (int i = 0; i < statsBuckets; i++) {
+		sizes += stats.learned_sizes[i];
+		lbds += stats.learned_lbds[i];
+	}
+	mu_assert("Histograms do not add up to the learned clauses", stats.learned == sat_learned_clause_count(s) && sizes == stats.learned && lbds == stats.learned);
+	mu_assert("Empty clause not dropped", stats.dropped == 1 && stats.deleted == 0);
+	mu_assert("No memory reported", stats.memory == sat_memory_usage(s) && stats.peak_memory > 0 && stats.seconds >= 0);
+	sat_state_free(s);
+	return 0;
+}
+
 static char * all_tests() {
 	mu_run_test(test_sat_state_var_count, 0);
 	mu_run_test(test_var_index, 1);
@@ -161,6 +798,30 @@ static char * all_tests() {
 	mu_run_test(test_decide_literal, 4);
 	mu_run_test(test_undo_decide_literal, 5);
 	mu_run_test(test_sat_var_occurences, 6);
+	mu_run_test(test_solve_with_assumptions, 7);
+	mu_run_test(test_add_clause, 8);
+	mu_run_test(test_restarts_and_stop, 9);
+	mu_run_test(test_portfolio, 10);
+	mu_run_test(test_cube, 11);
+	mu_run_test(test_deterministic_portfolio, 12);
+	mu_run_test(test_state_clone, 13);
+	mu_run_test(test_state_renew, 14);
+	mu_run_test(test_batch, 15);
+	mu_run_test(test_local_search, 16);
+	mu_run_test(test_proof, 17);
+	mu_run_test(test_enumerate_models, 18);
+	mu_run_test(test_cnf_format, 19);
+	mu_run_test(test_snapshot, 20);
+	mu_run_test(test_parallel_parse, 21);
+	mu_run_test(test_normalize, 22);
+	mu_run_test(test_builder, 23);
+	mu_run_test(test_allocations, 24);
+	mu_run_test(test_regions, 25);
+	mu_run_test(test_reorder, 26);
+	mu_run_test(test_unit_kernels, 27);
+	mu_run_test(test_scenarios, 28);
+	mu_run_test(test_trace, 29);
+	mu_run_test(test_stats, 30);
 	return 0;
 }
 